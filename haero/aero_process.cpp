@@ -0,0 +1,129 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "aero_process.hpp"
+
+#include <ekat/ekat_assert.hpp>
+
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace haero {
+
+namespace {
+
+// host-side metadata for an aerosol process
+struct ProcessMetadata {
+  std::string name;
+  std::shared_ptr<void> config;
+  // number of processes referring to this metadata (0 if released)
+  int num_references;
+};
+
+// Metadata for all registered processes, indexed by id. A deque doesn't move
+// its elements as it grows, so references to configurations stay valid.
+std::deque<ProcessMetadata> &process_registry() {
+  static std::deque<ProcessMetadata> registry;
+  return registry;
+}
+
+// Ids of released metadata, available for reuse.
+std::vector<int> &free_process_ids() {
+  static std::vector<int> ids;
+  return ids;
+}
+
+std::mutex &process_registry_mutex() {
+  static std::mutex mutex;
+  return mutex;
+}
+
+// Returns true if the given id refers to unreleased metadata. Call this with
+// the registry mutex locked.
+bool valid_process_id(int id) {
+  const auto &registry = process_registry();
+  return (id >= 0) && (id < int(registry.size())) &&
+         (registry[id].num_references > 0);
+}
+
+// Returns the metadata for the given process id.
+ProcessMetadata &process_metadata(int id) {
+  std::lock_guard<std::mutex> lock(process_registry_mutex());
+  EKAT_REQUIRE_MSG(valid_process_id(id), "Invalid aerosol process id: " << id);
+  return process_registry()[id];
+}
+
+} // namespace
+
+int register_process(const std::string &name, std::shared_ptr<void> config) {
+  std::lock_guard<std::mutex> lock(process_registry_mutex());
+  auto &registry = process_registry();
+  auto &free_ids = free_process_ids();
+  if (!free_ids.empty()) {
+    const int id = free_ids.back();
+    free_ids.pop_back();
+    registry[id] = ProcessMetadata{name, std::move(config), 1};
+    return id;
+  }
+  registry.push_back(ProcessMetadata{name, std::move(config), 1});
+  return int(registry.size()) - 1;
+}
+
+void retain_process(int id) {
+  std::lock_guard<std::mutex> lock(process_registry_mutex());
+  EKAT_REQUIRE_MSG(valid_process_id(id), "Invalid aerosol process id: " << id);
+  process_registry()[id].num_references += 1;
+}
+
+void release_process(int id) {
+  std::shared_ptr<void> config; // destroyed after the lock is released
+  std::lock_guard<std::mutex> lock(process_registry_mutex());
+  if (!valid_process_id(id)) {
+    return; // nothing to release (this is called from destructors)
+  }
+  auto &metadata = process_registry()[id];
+  if (--metadata.num_references == 0) {
+    config = std::move(metadata.config);
+    metadata.name.clear();
+    free_process_ids().push_back(id);
+  }
+}
+
+ProcessReferences::ProcessReferences(const ProcessReferences &other) {
+  for (int id : other.ids_) {
+    add(id);
+  }
+}
+
+ProcessReferences &ProcessReferences::operator=(
+    const ProcessReferences &other) {
+  if (this != &other) {
+    ProcessReferences copy(other);
+    std::swap(ids_, copy.ids_);
+  }
+  return *this;
+}
+
+ProcessReferences::~ProcessReferences() {
+  for (int id : ids_) {
+    release_process(id);
+  }
+}
+
+void ProcessReferences::add(int id) {
+  retain_process(id);
+  ids_.push_back(id);
+}
+
+std::string registered_process_name(int id) {
+  return process_metadata(id).name;
+}
+
+void *registered_process_config(int id) {
+  return process_metadata(id).config.get();
+}
+
+} // namespace haero
@@ -5,14 +5,254 @@
 #ifndef HAERO_AERO_PROCESS_HPP
 #define HAERO_AERO_PROCESS_HPP
 
-#include <cstring>
 #include <haero/atmosphere.hpp>
+#include <haero/level_count.hpp>
+#include <haero/math.hpp>
 #include <haero/surface.hpp>
+
+#include <cstddef>
 #include <memory>
+#include <string>
 #include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace haero {
 
+/// The maximum size (in bytes) of an AeroProcess. Processes are copied into
+/// every kernel that runs them, and large closures increase launch latency
+/// and register and constant memory pressure.
+constexpr std::size_t max_process_size = 512;
+
+/// The maximum size (in bytes) of the closure of a kernel that runs aerosol
+/// processes (the CUDA limit on kernel parameters).
+constexpr std::size_t max_kernel_closure_size = 4096;
+
+/// On host: registers the name and configuration of a new aerosol process,
+/// returning an integer id that identifies this metadata. An AeroProcess
+/// keeps only its id, so that its name and configuration aren't copied into
+/// kernels. Registered metadata is reference-counted: it starts with one
+/// reference, and is released (and its id reused) when the last reference is
+/// released. References are held on the host by the process that registered
+/// the metadata and by the objects that keep copies of it (see
+/// ProcessReferences), never by the copies themselves.
+/// @param [in] name The name of the process
+/// @param [in] config The configuration of the process, of a type known to
+///                    the caller
+int register_process(const std::string &name, std::shared_ptr<void> config);
+
+/// On host: adds a reference to the metadata of the process with the given
+/// id.
+void retain_process(int id);
+
+/// On host: removes a reference to the metadata of the process with the given
+/// id, releasing the metadata if it was the last one.
+void release_process(int id);
+
+/// On host: returns the name of the process with the given id.
+std::string registered_process_name(int id);
+
+/// On host: returns a pointer to the configuration of the process with the
+/// given id, which has the type given at registration.
+void *registered_process_config(int id);
+
+/// @class ProcessReferences
+/// This type holds references to the metadata of aerosol processes on the
+/// host, keeping it registered while the holder (or any of its copies)
+/// exists. Objects that keep copies of processes, such as ProcessGroup, hold
+/// one, since copies of a process (including those passed to kernels) don't
+/// hold references of their own.
+class ProcessReferences final {
+public:
+  /// On host: creates a holder with no references.
+  ProcessReferences() = default;
+
+  /// On host: creates a holder with its own references to the metadata
+  /// referenced by the given holder.
+  ProcessReferences(const ProcessReferences &other);
+
+  /// On host: replaces this holder's references with its own references to
+  /// the metadata referenced by the given holder.
+  ProcessReferences &operator=(const ProcessReferences &other);
+
+  /// On host: releases the holder's references.
+  ~ProcessReferences();
+
+  /// On host: adds a reference to the metadata of the process with the given
+  /// id.
+  void add(int id);
+
+private:
+  std::vector<int> ids_;
+};
+
+/// A ColumnJacobianView is a rank-3 Kokkos View storing the derivatives of
+/// an aerosol process's tendencies with respect to its prognostic variables
+/// within a single column. Processes act independently on each vertical level,
+/// so the Jacobian is stored as a dense block for each level:
+/// 1. A level index identifying a unique vertical level
+/// 2. A tracer index identifying the tendency being differentiated
+/// 3. A tracer index identifying the prognostic variable
+/// Like ColumnViews, ColumnJacobianViews are unmanaged.
+using ColumnJacobianView =
+    ekat::Unmanaged<typename DeviceType::view_3d<Real>>;
+
+/// @struct JacobianWorkspace
+/// This type holds the scratch data an AeroProcess needs to approximate its
+/// Jacobian with finite differences: a perturbed copy of the prognostics and
+/// the tendencies at the unperturbed and perturbed states. Each member must
+/// have its own storage, with the same dimensions as the prognostics.
+template <typename Prognostics> struct JacobianWorkspace {
+  /// perturbed prognostic state
+  Prognostics state;
+  /// tendencies at the unperturbed state
+  Prognostics tendencies;
+  /// tendencies at the perturbed state
+  Prognostics perturbed_tendencies;
+};
+
+/// This type trait is true if the given process implementation provides an
+/// analytic Jacobian (a compute_jacobian method), and false if not.
+template <typename AerosolConfig, typename AerosolProcessImpl,
+          typename = void>
+struct HasAnalyticJacobian : std::false_type {};
+
+template <typename AerosolConfig, typename AerosolProcessImpl>
+struct HasAnalyticJacobian<
+    AerosolConfig, AerosolProcessImpl,
+    std::void_t<decltype(std::declval<const AerosolProcessImpl &>()
+                             .compute_jacobian(
+                                 std::declval<const AerosolConfig &>(),
+                                 std::declval<const ThreadTeam &>(), Real(),
+                                 Real(), std::declval<const Atmosphere &>(),
+                                 std::declval<const Surface &>(),
+                                 std::declval<const typename AerosolConfig::
+                                                  Prognostics &>(),
+                                 std::declval<const typename AerosolConfig::
+                                                  Diagnostics &>(),
+                                 std::declval<const ColumnJacobianView &>()))>>
+    : std::true_type {};
+
+/// This type trait is true if the given process implementation can add its
+/// tendencies to existing values (with an accumulate_tendencies method), and
+/// false if not.
+template <typename AerosolConfig, typename AerosolProcessImpl,
+          typename = void>
+struct HasTendencyAccumulation : std::false_type {};
+
+template <typename AerosolConfig, typename AerosolProcessImpl>
+struct HasTendencyAccumulation<
+    AerosolConfig, AerosolProcessImpl,
+    std::void_t<decltype(std::declval<const AerosolProcessImpl &>()
+                             .accumulate_tendencies(
+                                 std::declval<const AerosolConfig &>(),
+                                 std::declval<const ThreadTeam &>(), Real(),
+                                 Real(), std::declval<const Atmosphere &>(),
+                                 std::declval<const Surface &>(),
+                                 std::declval<const typename AerosolConfig::
+                                                  Prognostics &>(),
+                                 std::declval<const typename AerosolConfig::
+                                                  Diagnostics &>(),
+                                 Real(),
+                                 std::declval<const typename AerosolConfig::
+                                                  Tendencies &>()))>>
+    : std::true_type {};
+
+/// This type trait is true if the given process implementation provides
+/// tendency kernels specialized for the given LevelCount type, and false if
+/// not.
+template <typename AerosolConfig, typename AerosolProcessImpl,
+          typename Levels, typename = void>
+struct HasLevelCountTendencies : std::false_type {};
+
+template <typename AerosolConfig, typename AerosolProcessImpl,
+          typename Levels>
+struct HasLevelCountTendencies<
+    AerosolConfig, AerosolProcessImpl, Levels,
+    std::void_t<decltype(std::declval<const AerosolProcessImpl &>()
+                             .compute_tendencies(
+                                 std::declval<const AerosolConfig &>(),
+                                 std::declval<const ThreadTeam &>(),
+                                 std::declval<const Levels &>(), Real(),
+                                 Real(), std::declval<const Atmosphere &>(),
+                                 std::declval<const Surface &>(),
+                                 std::declval<const typename AerosolConfig::
+                                                  Prognostics &>(),
+                                 std::declval<const typename AerosolConfig::
+                                                  Diagnostics &>(),
+                                 std::declval<const typename AerosolConfig::
+                                                  Tendencies &>()))>>
+    : std::true_type {};
+
+/// This type trait is true if the given process implementation can
+/// re-initialize itself incrementally (with a reinit method), and false if
+/// not.
+template <typename AerosolConfig, typename AerosolProcessImpl,
+          typename = void>
+struct HasIncrementalInit : std::false_type {};
+
+template <typename AerosolConfig, typename AerosolProcessImpl>
+struct HasIncrementalInit<
+    AerosolConfig, AerosolProcessImpl,
+    std::void_t<decltype(std::declval<AerosolProcessImpl &>().reinit(
+        std::declval<const AerosolConfig &>(),
+        std::declval<const typename AerosolProcessImpl::Config &>(),
+        std::declval<const typename AerosolProcessImpl::Config &>()))>>
+    : std::true_type {};
+
+/// This type trait is true if the given process implementation's validate
+/// method can report the tracer and level of the first invalid value (with
+/// trailing `int &tracer, int &level` parameters), and false if not.
+template <typename AerosolConfig, typename AerosolProcessImpl,
+          typename = void>
+struct HasValidationLocation : std::false_type {};
+
+template <typename AerosolConfig, typename AerosolProcessImpl>
+struct HasValidationLocation<
+    AerosolConfig, AerosolProcessImpl,
+    std::void_t<decltype(std::declval<const AerosolProcessImpl &>().validate(
+        std::declval<const AerosolConfig &>(),
+        std::declval<const ThreadTeam &>(), std::declval<const Atmosphere &>(),
+        std::declval<const Surface &>(),
+        std::declval<const typename AerosolConfig::Prognostics &>(),
+        std::declval<int &>(), std::declval<int &>()))>>
+    : std::true_type {};
+
+/// This type trait is true if the given process implementation declares
+/// itself vertically local with a member
+/// ```
+/// static constexpr bool vertically_local = true;
+/// ```
+/// and false if not. A vertically local process computes the tendencies at
+/// each level from data at that level alone, and doesn't depend on the number
+/// of levels or on a level's position in its column, so it can run on any
+/// contiguous range of levels (see ProcessGroup::set_level_tile_size).
+template <typename AerosolProcessImpl, typename = void>
+struct IsVerticallyLocal : std::false_type {};
+
+template <typename AerosolProcessImpl>
+struct IsVerticallyLocal<
+    AerosolProcessImpl,
+    std::enable_if_t<AerosolProcessImpl::vertically_local>>
+    : std::true_type {};
+
+/// On host: returns true if any of the given fields (pointers to members)
+/// differ between the given old and new process configurations, and false
+/// if not. Process implementations use this in their reinit methods to
+/// declare which configuration fields each piece of precomputed state
+/// depends on, e.g.
+/// ```
+/// if (config_changed(old_config, new_config, &Config::num_bins,
+///                    &Config::max_radius)) {
+///   build_table(new_config);
+/// }
+/// ```
+template <typename Config, typename... Fields>
+bool config_changed(const Config &old_config, const Config &new_config,
+                    Fields Config::*...fields) {
+  return ((!(old_config.*fields == new_config.*fields)) || ...);
+}
+
 /// @class AeroProcess
 /// This type defines the interface for a specific process in the aerosol
 /// lifecycle, backed by a specific implementation, the structure of which is
@@ -32,6 +272,24 @@ public:
   static_assert(std::is_same<Tendencies, Prognostics>::value,
                 "Tendencies and Prognostics types must be identical!");
 
+  /// Workspace for finite-difference Jacobians.
+  using Workspace = JacobianWorkspace<Prognostics>;
+
+  /// True if the process implementation provides an analytic Jacobian, false
+  /// if compute_jacobian approximates it with finite differences.
+  static constexpr bool has_analytic_jacobian =
+      HasAnalyticJacobian<AerosolConfig, AerosolProcessImpl>::value;
+
+  /// True if the process implementation can add its tendencies to existing
+  /// values (see accumulate_tendencies), false if not.
+  static constexpr bool accumulates_tendencies =
+      HasTendencyAccumulation<AerosolConfig, AerosolProcessImpl>::value;
+
+  /// True if the process implementation is vertically local (see
+  /// IsVerticallyLocal), false if not.
+  static constexpr bool vertically_local =
+      IsVerticallyLocal<AerosolProcessImpl>::value;
+
   /// Constructs an instance of an aerosol process with the given name,
   /// associated with the given aerosol configuration.
   /// @param [in] aero_config The aerosol configuration for this process
@@ -39,21 +297,39 @@ public:
   ///                            this process's implementation.
   AeroProcess(const AeroConfig &aero_config,
               const ProcessConfig &process_config = ProcessConfig())
-      : aero_config_(aero_config), process_config_(process_config),
-        process_impl_() {
-    // Set the name of this process.
-    const char *name = process_impl_.name();
-    std::strncpy(name_, name, sizeof(name_));
+      : owns_metadata_(true), aero_config_(aero_config), process_impl_() {
+    static_assert(sizeof(AeroProcess) <= max_process_size,
+                  "AeroProcess is too large to copy into kernels!");
+    // Register the name and configuration of this process on the host.
+    id_ = register_process(process_impl_.name(),
+                           std::make_shared<ProcessConfig>(process_config));
     // Pass the configuration data to the implementation to initialize it.
-    process_impl_.init(aero_config_, process_config_);
+    process_impl_.init(aero_config_, process_config);
   }
 
-  /// Destructor.
-  KOKKOS_INLINE_FUNCTION ~AeroProcess() {}
+  /// Destructor. On host, the process that registered its metadata releases
+  /// its reference to it.
+  KOKKOS_INLINE_FUNCTION ~AeroProcess() {
+    KOKKOS_IF_ON_HOST((if (owns_metadata_) { release_process(id_); }))
+  }
+
+  // Copy construction is required for host -> device dispatches. Copies share
+  // the process's metadata but hold no reference to it, so copying a process
+  // into a kernel never touches the registry. Whoever keeps a copy beyond the
+  // lifetime of the original holds a reference with ProcessReferences.
+  KOKKOS_INLINE_FUNCTION
+  AeroProcess(const AeroProcess &other)
+      : id_(other.id_), owns_metadata_(false),
+        aero_config_(other.aero_config_), process_impl_(other.process_impl_) {}
 
-  // Copy construction is required for host -> device dispatches
+  // Move construction transfers the reference to the process's metadata (if
+  // any), so temporaries can hand their metadata to a longer-lived process.
   KOKKOS_INLINE_FUNCTION
-  AeroProcess(const AeroProcess &) = default;
+  AeroProcess(AeroProcess &&other) noexcept
+      : id_(other.id_), owns_metadata_(other.owns_metadata_),
+        aero_config_(other.aero_config_), process_impl_(other.process_impl_) {
+    other.owns_metadata_ = false;
+  }
 
   /// Default constructor is disabled.
   AeroProcess() = delete;
@@ -65,24 +341,55 @@ public:
   //                          Accessors (host only)
   //------------------------------------------------------------------------
 
+  /// On host or device: returns the id identifying this process's host-side
+  /// metadata. Copies of a process share its id until one of them is
+  /// re-initialized (see init). The metadata stays registered while the
+  /// process that registered it exists, or while a ProcessReferences refers
+  /// to it.
+  KOKKOS_INLINE_FUNCTION
+  int id() const { return id_; }
+
   /// On host: returns the name of this process.
-  std::string name() const { return std::string(name_); }
+  std::string name() const { return registered_process_name(id_); }
 
   /// On host: returns the aerosol configuration (metadata) associated with
   /// this process.
   const AeroConfig &aero_config() const { return aero_config_; }
 
   /// On host: returns any process-specific configuration data.
-  const ProcessConfig &process_config() const { return process_config_; }
+  const ProcessConfig &process_config() const {
+    return *static_cast<const ProcessConfig *>(registered_process_config(id_));
+  }
 
   //------------------------------------------------------------------------
   //                            Public Interface
   //------------------------------------------------------------------------
 
-  /// On host: (re-)initializes the process with the given configuration
+  /// On host: (re-)initializes the process with the given configuration.
+  /// If the process implementation provides a method
+  /// ```
+  /// void reinit(const AeroConfig &config, const ProcessConfig &old_config,
+  ///             const ProcessConfig &new_config)
+  /// ```
+  /// it is called with the current and new configurations, so that only
+  /// precomputed state that depends on changed fields is rebuilt (see
+  /// config_changed). Otherwise, the implementation is initialized from
+  /// scratch. The process then gets new metadata (and a new id) holding the
+  /// new configuration: existing copies of the process keep the old
+  /// configuration, which matches their implementations.
   void init(const ProcessConfig &config) {
-    process_config_ = config;
-    process_impl_.init(aero_config_, process_config_);
+    if constexpr (HasIncrementalInit<AerosolConfig, ProcessImpl>::value) {
+      process_impl_.reinit(aero_config_, process_config(), config);
+    } else {
+      process_impl_.init(aero_config_, config);
+    }
+    const int id = register_process(registered_process_name(id_),
+                                    std::make_shared<ProcessConfig>(config));
+    if (owns_metadata_) {
+      release_process(id_);
+    }
+    id_ = id;
+    owns_metadata_ = true;
   }
 
   /// On host or device: Validates input aerosol and atmosphere data, returning
@@ -96,8 +403,37 @@ public:
   KOKKOS_INLINE_FUNCTION
   bool validate(const ThreadTeam &team, const Atmosphere &atmosphere,
                 const Surface &surface, const Prognostics &prognostics) const {
-    return process_impl_.validate(aero_config_, team, atmosphere, surface,
-                                  prognostics);
+    int tracer, level;
+    return validate(team, atmosphere, surface, prognostics, tracer, level);
+  }
+
+  /// On host or device: Validates data like the method above, and also
+  /// reports where the data is invalid. The process implementation can
+  /// provide a method
+  /// ```
+  /// bool validate(const AeroConfig &config, const ThreadTeam &team,
+  ///               const Atmosphere &atmosphere, const Surface &surface,
+  ///               const Prognostics &prognostics, int &tracer,
+  ///               int &level) const
+  /// ```
+  /// that sets tracer and level on every thread of the team. Otherwise, its
+  /// validate method doesn't identify them.
+  /// @param [out] tracer The tracer of the first invalid value, or -1 if the
+  ///                     data is valid or the process doesn't identify it
+  /// @param [out] level The level of the first invalid value, or -1 if the
+  ///                    data is valid or the process doesn't identify it
+  KOKKOS_INLINE_FUNCTION
+  bool validate(const ThreadTeam &team, const Atmosphere &atmosphere,
+                const Surface &surface, const Prognostics &prognostics,
+                int &tracer, int &level) const {
+    tracer = level = -1;
+    if constexpr (HasValidationLocation<AerosolConfig, ProcessImpl>::value) {
+      return process_impl_.validate(aero_config_, team, atmosphere, surface,
+                                    prognostics, tracer, level);
+    } else {
+      return process_impl_.validate(aero_config_, team, atmosphere, surface,
+                                    prognostics);
+    }
   }
 
   /// On host or device: runs the aerosol process at a given time with the given
@@ -127,10 +463,203 @@ public:
                                      tendencies);
   }
 
+  /// On host or device: adds the process's tendencies, multiplied by the
+  /// given scale factor, to the given values, which lets several processes
+  /// share one tendency array. The process implementation must provide a
+  /// method
+  /// ```
+  /// void accumulate_tendencies(const AeroConfig &config,
+  ///                            const ThreadTeam &team, Real t, Real dt,
+  ///                            const Atmosphere &atmosphere,
+  ///                            const Surface &surface,
+  ///                            const Prognostics &prognostics,
+  ///                            const Diagnostics &diagnostics, Real scale,
+  ///                            const Tendencies &tendencies) const
+  /// ```
+  /// With a scale of dt, the tendencies may be the prognostics themselves,
+  /// which applies the process to them in place. An implementation must
+  /// therefore read every prognostic it needs at a level before updating any
+  /// value at that level.
+  /// @param [in]    team The Kokkos team used to run this process in a parallel
+  ///                     dispatch.
+  /// @param [in]    t The simulation time (in seconds).
+  /// @param [in]    dt The simulation time interval ("timestep size").
+  /// @param [in]    atmosphere The atmosphere state variables used by this
+  ///                           process.
+  /// @param [in]    prognostics An array containing aerosol tracer data to be
+  ///                            evolved.
+  /// @param [inout] diagnostics An array that can store aerosol diagnostic
+  ///                            data computed or updated by this process.
+  /// @param [in]    scale The factor by which tendencies are multiplied.
+  /// @param [inout] tendencies An array analogous to prognostics to which
+  ///                           scaled tendencies are added.
+  KOKKOS_INLINE_FUNCTION
+  void accumulate_tendencies(const ThreadTeam &team, Real t, Real dt,
+                             const Atmosphere &atmosphere,
+                             const Surface &surface,
+                             const Prognostics &prognostics,
+                             const Diagnostics &diagnostics, Real scale,
+                             const Tendencies &tendencies) const {
+    static_assert(accumulates_tendencies,
+                  "Process implementation has no accumulate_tendencies!");
+    process_impl_.accumulate_tendencies(aero_config_, team, t, dt, atmosphere,
+                                        surface, prognostics, diagnostics,
+                                        scale, tendencies);
+  }
+
+  /// On host or device: runs the aerosol process as above, for columns with
+  /// the number of levels given by a LevelCount. If the process
+  /// implementation provides a method
+  /// ```
+  /// template <int N>
+  /// void compute_tendencies(const AeroConfig &config, const ThreadTeam &team,
+  ///                         const LevelCount<N> &levels, Real t, Real dt,
+  ///                         const Atmosphere &atmosphere,
+  ///                         const Surface &surface,
+  ///                         const Prognostics &prognostics,
+  ///                         const Diagnostics &diagnostics,
+  ///                         const Tendencies &tendencies) const
+  /// ```
+  /// it is called, so that the implementation can use kernels specialized for
+  /// a fixed number of levels. Otherwise, the level count is ignored.
+  template <int N>
+  KOKKOS_INLINE_FUNCTION void
+  compute_tendencies(const ThreadTeam &team, const LevelCount<N> &levels,
+                     Real t, Real dt, const Atmosphere &atmosphere,
+                     const Surface &surface, const Prognostics &prognostics,
+                     const Diagnostics &diagnostics,
+                     const Tendencies &tendencies) const {
+    if constexpr (HasLevelCountTendencies<AerosolConfig, ProcessImpl,
+                                          LevelCount<N>>::value) {
+      process_impl_.compute_tendencies(aero_config_, team, levels, t, dt,
+                                       atmosphere, surface, prognostics,
+                                       diagnostics, tendencies);
+    } else {
+      compute_tendencies(team, t, dt, atmosphere, surface, prognostics,
+                         diagnostics, tendencies);
+    }
+  }
+
+  /// On host or device: computes the Jacobian of the process's tendencies
+  /// with respect to its prognostic variables at each level of a column, for
+  /// use by implicit or Rosenbrock integrators. If the process implementation
+  /// provides a method
+  /// ```
+  /// void compute_jacobian(const AeroConfig &config, const ThreadTeam &team,
+  ///                       Real t, Real dt, const Atmosphere &atmosphere,
+  ///                       const Surface &surface,
+  ///                       const Prognostics &prognostics,
+  ///                       const Diagnostics &diagnostics,
+  ///                       const ColumnJacobianView &jacobian) const
+  /// ```
+  /// the Jacobian is computed analytically and the workspace is not used.
+  /// Otherwise it is approximated with finite differences (see
+  /// compute_fd_jacobian).
+  /// @param [in]    team The Kokkos team used to run this process in a parallel
+  ///                     dispatch.
+  /// @param [in]    t The simulation time (in seconds).
+  /// @param [in]    dt The simulation time interval ("timestep size").
+  /// @param [in]    atmosphere The atmosphere state variables used by this
+  ///                           process.
+  /// @param [in]    prognostics The aerosol tracer data at which the Jacobian
+  ///                            is evaluated.
+  /// @param [inout] diagnostics An array that can store aerosol diagnostic
+  ///                            data computed or updated by this process.
+  /// @param [inout] workspace Scratch data for finite differences.
+  /// @param [out]   jacobian The Jacobian, indexed by (level, tendency,
+  ///                         prognostic).
+  KOKKOS_INLINE_FUNCTION
+  void compute_jacobian(const ThreadTeam &team, Real t, Real dt,
+                        const Atmosphere &atmosphere, const Surface &surface,
+                        const Prognostics &prognostics,
+                        const Diagnostics &diagnostics,
+                        const Workspace &workspace,
+                        const ColumnJacobianView &jacobian) const {
+    if constexpr (has_analytic_jacobian) {
+      process_impl_.compute_jacobian(aero_config_, team, t, dt, atmosphere,
+                                     surface, prognostics, diagnostics,
+                                     jacobian);
+    } else {
+      compute_fd_jacobian(team, t, dt, atmosphere, surface, prognostics,
+                          diagnostics, workspace, jacobian);
+    }
+  }
+
+  /// On host or device: approximates the Jacobian of the process's
+  /// tendencies with forward differences, whether or not the implementation
+  /// provides an analytic Jacobian. Because levels are independent, each
+  /// tracer is perturbed at every level at once, so this costs one more
+  /// tendency evaluation than the number of tracers. The Prognostics type
+  /// must provide `int num_tracers() const`, `int num_levels() const`, and
+  /// `Real &operator()(int tracer, int level) const`. Diagnostics updated by
+  /// the process are left as computed at the last perturbed state. Arguments
+  /// are as for compute_jacobian.
+  KOKKOS_INLINE_FUNCTION
+  void compute_fd_jacobian(const ThreadTeam &team, Real t, Real dt,
+                           const Atmosphere &atmosphere, const Surface &surface,
+                           const Prognostics &prognostics,
+                           const Diagnostics &diagnostics,
+                           const Workspace &workspace,
+                           const ColumnJacobianView &jacobian) const {
+    const int num_tracers = prognostics.num_tracers();
+    const int num_levels = prognostics.num_levels();
+    const auto &state = workspace.state;
+    Kokkos::parallel_for(
+        Kokkos::TeamThreadRange(team, num_tracers * num_levels),
+        [&](const int i) {
+          const int q = i / num_levels, k = i % num_levels;
+          state(q, k) = prognostics(q, k);
+          // a process need not set every tendency
+          workspace.tendencies(q, k) = 0;
+        });
+    team.team_barrier();
+    compute_tendencies(team, t, dt, atmosphere, surface, state, diagnostics,
+                       workspace.tendencies);
+    team.team_barrier();
+    // perturbations are scaled to the square root of machine epsilon, with a
+    // floor for tracers near zero
+    const Real sqrt_eps = sqrt(epsilon());
+    for (int j = 0; j < num_tracers; ++j) {
+      Kokkos::parallel_for(
+          Kokkos::TeamThreadRange(team, num_tracers * num_levels),
+          [&](const int i) {
+            const int q = i / num_levels, k = i % num_levels;
+            // the tendencies set at one perturbed state may differ from
+            // those set at the last one
+            workspace.perturbed_tendencies(q, k) = 0;
+            if (q == j) {
+              const Real p = prognostics(j, k);
+              state(j, k) = p + sqrt_eps * (((p < 0) ? -p : p) + sqrt_eps);
+            }
+          });
+      team.team_barrier();
+      compute_tendencies(team, t, dt, atmosphere, surface, state, diagnostics,
+                         workspace.perturbed_tendencies);
+      team.team_barrier();
+      Kokkos::parallel_for(
+          Kokkos::TeamThreadRange(team, num_tracers * num_levels),
+          [&](const int i) {
+            const int q = i / num_levels, k = i % num_levels;
+            // use the representable perturbation
+            const Real h = state(j, k) - prognostics(j, k);
+            jacobian(k, q, j) = (workspace.perturbed_tendencies(q, k) -
+                                 workspace.tendencies(q, k)) /
+                                h;
+          });
+      team.team_barrier();
+      Kokkos::parallel_for(
+          Kokkos::TeamThreadRange(team, num_levels),
+          [&](const int k) { state(j, k) = prognostics(j, k); });
+      team.team_barrier();
+    }
+  }
+
 private:
-  char name_[256];
+  int id_;
+  // true if this process holds the reference to its metadata created when it
+  // was registered
+  bool owns_metadata_;
   AeroConfig aero_config_;
-  ProcessConfig process_config_;
   ProcessImpl process_impl_;
 };
 
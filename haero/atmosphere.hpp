@@ -110,6 +110,25 @@ public:
   KOKKOS_INLINE_FUNCTION
   int num_levels() const { return num_levels_; }
 
+  /// On host or device: returns an Atmosphere for the given range of levels
+  /// of this one, whose level-dependent fields refer to this one's data.
+  KOKKOS_INLINE_FUNCTION
+  Atmosphere level_range(const int first_level, const int num_levels) const {
+    EKAT_KERNEL_ASSERT((first_level >= 0) &&
+                       (first_level + num_levels <= num_levels_));
+    auto range = [&](const ConstColumnView &v) {
+      return ConstColumnView(v.data() + first_level, num_levels);
+    };
+    return Atmosphere(num_levels, range(temperature), range(pressure),
+                      range(vapor_mixing_ratio), range(liquid_mixing_ratio),
+                      range(cloud_liquid_number_mixing_ratio),
+                      range(ice_mixing_ratio),
+                      range(cloud_ice_number_mixing_ratio), range(height),
+                      range(hydrostatic_dp), range(cloud_fraction),
+                      range(updraft_vel_ice_nucleation),
+                      planetary_boundary_layer_height);
+  }
+
   /// Returns true iff all atmospheric quantities are nonnegative, using the
   /// given thread team to parallelize the check.
   KOKKOS_INLINE_FUNCTION
@@ -0,0 +1,161 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_CHANGE_DETECTION_HPP
+#define HAERO_CHANGE_DETECTION_HPP
+
+#include <haero/haero.hpp>
+#include <haero/memory.hpp>
+
+#include <ekat/ekat_assert.hpp>
+
+#include <limits>
+
+namespace haero {
+
+/// @class ChangeDetector
+/// This type lets a diagnostic function skip levels whose inputs haven't
+/// changed appreciably since the diagnostic was last computed there. In much
+/// of the stratosphere and the clear free troposphere, inputs such as
+/// relative humidity and dry volume change by less than round-off between
+/// steps, so expensive diagnostics (such as the wet radius) need not be
+/// recomputed. A ChangeDetector stores the NumInputs inputs used at the last
+/// computation on each level of each column. An input x is unchanged if it
+/// is within
+/// @f$ |x - x_0| \le r |x_0| + a @f$
+/// of the stored input x_0, given relative and absolute thresholds r and a.
+/// Because inputs are compared with those of the last computation rather
+/// than those of the last step, a reused diagnostic was always computed from
+/// inputs within these thresholds of the current ones, however slowly they
+/// drift. A diagnostic function uses a detector like this:
+/// ```
+/// Kokkos::parallel_for(Kokkos::TeamThreadRange(team, num_levels),
+///                      [&](const int k) {
+///   const Real inputs[2] = {rel_humidity(k), dry_volume(k)};
+///   if (detector.needs_update(col, k, inputs)) {
+///     wet_radius(k) = compute_wet_radius(rel_humidity(k), dry_volume(k));
+///   }
+/// });
+/// ```
+/// The diagnostic itself must persist between calls, since skipped levels
+/// keep their values.
+template <int NumInputs> class ChangeDetector final {
+public:
+  static_assert(NumInputs > 0, "A ChangeDetector needs at least 1 input!");
+
+  /// The number of inputs on each level.
+  static constexpr int num_inputs = NumInputs;
+
+  /// On host: creates a detector for the given numbers of columns and
+  /// levels, with the given thresholds. Every level needs an update the first
+  /// time it is checked.
+  /// @param [in] num_columns The number of columns
+  /// @param [in] num_levels The number of vertical levels in each column
+  /// @param [in] rel_threshold The relative change r beyond which an input has
+  ///                           changed
+  /// @param [in] abs_threshold The absolute change a added to the relative
+  ///                           one, which lets inputs near zero be reused
+  ChangeDetector(int num_columns, int num_levels, Real rel_threshold,
+                 Real abs_threshold = 0)
+      : rel_threshold_(rel_threshold), abs_threshold_(abs_threshold),
+        inputs_(Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                                   "haero::ChangeDetector::inputs"),
+                num_columns, num_levels, NumInputs),
+        num_checks_("haero::ChangeDetector::num_checks", num_columns,
+                    num_levels),
+        num_updates_("haero::ChangeDetector::num_updates", num_columns,
+                     num_levels) {
+    EKAT_REQUIRE_MSG((rel_threshold >= 0) && (abs_threshold >= 0),
+                     "ChangeDetector: thresholds must be nonnegative!");
+    tracker_.track(inputs_, "diagnostics", "haero::ChangeDetector");
+    tracker_.track(num_checks_, "diagnostics", "haero::ChangeDetector");
+    tracker_.track(num_updates_, "diagnostics", "haero::ChangeDetector");
+    invalidate();
+  }
+
+  /// On host: returns the relative threshold.
+  Real rel_threshold() const { return rel_threshold_; }
+
+  /// On host: returns the absolute threshold.
+  Real abs_threshold() const { return abs_threshold_; }
+
+  /// On host: forces an update on every level at its next check, e.g. after
+  /// the parameters of the diagnostic change.
+  void invalidate() {
+    Kokkos::deep_copy(inputs_, std::numeric_limits<Real>::quiet_NaN());
+  }
+
+  /// On device: returns true if any of the given inputs on the given level
+  /// of the given column has changed since the diagnostic was last computed
+  /// there, storing them as the inputs of the new computation, and false if
+  /// the stored diagnostic can be reused. Each level must be checked by one
+  /// thread at a time.
+  KOKKOS_INLINE_FUNCTION
+  bool needs_update(const int col, const int k,
+                    const Real (&inputs)[NumInputs]) const {
+    ++num_checks_(col, k);
+    bool changed = false;
+    for (int i = 0; i < NumInputs; ++i) {
+      const Real x0 = inputs_(col, k, i);
+      const Real diff = inputs[i] - x0;
+      const Real tol = rel_threshold_ * ((x0 < 0) ? -x0 : x0) + abs_threshold_;
+      // the stored inputs are NaN before the first computation
+      changed = changed || !(((diff < 0) ? -diff : diff) <= tol);
+    }
+    if (changed) {
+      for (int i = 0; i < NumInputs; ++i) {
+        inputs_(col, k, i) = inputs[i];
+      }
+      ++num_updates_(col, k);
+    }
+    return changed;
+  }
+
+  /// On host: returns the number of level checks since the detector was
+  /// created or its statistics were reset.
+  long num_checks() const { return sum(num_checks_); }
+
+  /// On host: returns the number of level checks that needed an update.
+  long num_updates() const { return sum(num_updates_); }
+
+  /// On host: returns the fraction of level checks whose diagnostic was
+  /// reused (0 if there have been no checks).
+  double skip_fraction() const {
+    const long checks = num_checks();
+    return (checks > 0) ? 1.0 - double(num_updates()) / checks : 0.0;
+  }
+
+  /// On host: resets the numbers of checks and updates.
+  void reset_statistics() {
+    Kokkos::deep_copy(num_checks_, 0);
+    Kokkos::deep_copy(num_updates_, 0);
+  }
+
+private:
+  // returns the sum of the given per-level counts
+  static long sum(const DeviceType::view_2d<int> &counts) {
+    const int num_levels = counts.extent(1);
+    long total = 0;
+    Kokkos::parallel_reduce(
+        "haero::ChangeDetector::sum",
+        Kokkos::RangePolicy<ExecutionSpace>(0, counts.size()),
+        KOKKOS_LAMBDA(const int i, long &s) {
+          s += counts(i / num_levels, i % num_levels);
+        },
+        total);
+    return total;
+  }
+
+  Real rel_threshold_, abs_threshold_;
+  // inputs of the last computation, indexed by (column, level, input)
+  DeviceType::view_3d<Real> inputs_;
+  // numbers of checks and updates on each level
+  DeviceType::view_2d<int> num_checks_, num_updates_;
+  // registers the views above with Haero's memory registry
+  memory::ViewTracker tracker_;
+};
+
+} // namespace haero
+
+#endif
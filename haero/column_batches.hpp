@@ -0,0 +1,334 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_COLUMN_BATCHES_HPP
+#define HAERO_COLUMN_BATCHES_HPP
+
+#include <haero/atmosphere.hpp>
+#include <haero/memory.hpp>
+
+#include <ekat/ekat_assert.hpp>
+
+#include <string>
+
+namespace haero {
+
+/// This type selects how the data of many columns is laid out in memory, and
+/// hence which dimension kernels vectorize over.
+enum class ColumnLayout {
+  /// the levels of each column are contiguous, and kernels vectorize over the
+  /// levels of a column
+  level_innermost,
+  /// columns are grouped into batches, and the columns of a batch are
+  /// contiguous at each level, so kernels vectorize over columns. Use this
+  /// layout for columns with too few levels to fill a vector register, such
+  /// as box models and parcel ensembles.
+  column_innermost
+};
+
+/// @class ColumnBatches
+/// This type groups columns into batches of batch_size columns, each of which
+/// kernels treat as a single column of num_levels * batch_size "batch
+/// levels". Level k of column i is batch level k * batch_size + (i %
+/// batch_size) of batch i / batch_size, so consecutive batch levels hold the
+/// same level in neighboring columns (the column-innermost layout). With a
+/// batch size of 1, batches are columns and batch levels are levels (the
+/// level-innermost layout).
+///
+/// Because aerosol processes act independently on each level, the same
+/// process implementation runs in either layout: a ProcessGroup constructed
+/// with num_batches() columns of batch_levels() levels processes whole
+/// batches, with tracers stored in a TracersView from create_tracers and
+/// atmospheric data from an AtmosphereSet. Processes that depend on the
+/// position of a level within its column (such as vertical transport) must
+/// use the level-innermost layout. If the number of columns isn't a multiple
+/// of the batch size, the last batch is padded with copies of the last
+/// column.
+class ColumnBatches final {
+public:
+  /// The minimum number of batch levels in a default column-innermost batch,
+  /// which is enough to fill the vector lanes of a team on CPUs and GPUs.
+  static constexpr int min_batch_levels = 64;
+
+  /// On host: creates batches of columns with the given dimensions in the
+  /// given layout.
+  /// @param [in] num_columns The number of columns
+  /// @param [in] num_levels The number of vertical levels in each column
+  /// @param [in] layout The layout of the columns' data
+  /// @param [in] batch_size The number of columns in a batch, which must be 1
+  ///                        (or 0) for the level-innermost layout. In the
+  ///                        column-innermost layout, 0 selects
+  ///                        default_batch_size.
+  ColumnBatches(int num_columns, int num_levels,
+                ColumnLayout layout = ColumnLayout::level_innermost,
+                int batch_size = 0)
+      : layout_(layout), num_columns_(num_columns), num_levels_(num_levels),
+        batch_size_(batch_size) {
+    EKAT_REQUIRE_MSG((num_columns > 0) && (num_levels > 0),
+                     "ColumnBatches: numbers of columns and levels must be "
+                     "positive!");
+    EKAT_REQUIRE_MSG(batch_size >= 0,
+                     "ColumnBatches: batch_size must be nonnegative!");
+    if (layout == ColumnLayout::level_innermost) {
+      EKAT_REQUIRE_MSG(batch_size <= 1, "ColumnBatches: the level-innermost "
+                                        "layout requires a batch size of 1!");
+      batch_size_ = 1;
+    } else if (batch_size == 0) {
+      batch_size_ = default_batch_size(num_columns, num_levels);
+    }
+    num_batches_ = (num_columns + batch_size_ - 1) / batch_size_;
+  }
+
+  /// On host: returns the default column-innermost batch size for columns
+  /// with the given dimensions: the smallest multiple of the Pack size whose
+  /// batches have at least min_batch_levels levels, but no more than is
+  /// needed to hold every column.
+  static int default_batch_size(int num_columns, int num_levels) {
+    const int wanted = (min_batch_levels + num_levels - 1) / num_levels;
+    return HAERO_PACK_SIZE *
+           PackInfo::num_packs((wanted < num_columns) ? wanted : num_columns);
+  }
+
+  /// On host or device: returns the layout of the columns' data.
+  KOKKOS_INLINE_FUNCTION
+  ColumnLayout layout() const { return layout_; }
+
+  /// On host or device: returns the number of columns.
+  KOKKOS_INLINE_FUNCTION
+  int num_columns() const { return num_columns_; }
+
+  /// On host or device: returns the number of levels in each column.
+  KOKKOS_INLINE_FUNCTION
+  int num_levels() const { return num_levels_; }
+
+  /// On host or device: returns the number of columns in each batch.
+  KOKKOS_INLINE_FUNCTION
+  int batch_size() const { return batch_size_; }
+
+  /// On host or device: returns the number of batches.
+  KOKKOS_INLINE_FUNCTION
+  int num_batches() const { return num_batches_; }
+
+  /// On host or device: returns the number of levels in each batch.
+  KOKKOS_INLINE_FUNCTION
+  int batch_levels() const { return num_levels_ * batch_size_; }
+
+  /// On host or device: returns the batch that holds the given column.
+  KOKKOS_INLINE_FUNCTION
+  int batch(const int col) const { return col / batch_size_; }
+
+  /// On host or device: returns the batch level that holds the given level of
+  /// the given column.
+  KOKKOS_INLINE_FUNCTION
+  int batch_level(const int col, const int k) const {
+    return k * batch_size_ + col % batch_size_;
+  }
+
+  /// On host: allocates a view for the given number of tracers in this
+  /// layout, indexed by (tracer, batch, batch level). The view is recorded
+  /// with Haero's memory registry (as "tracers") in the given tracker, which
+  /// belongs to the given owner.
+  TracersView create_tracers(const std::string &name, const int num_tracers,
+                             memory::ViewTracker &tracker,
+                             const std::string &owner) const {
+    TracersView tracers(name, num_tracers, num_batches_, batch_levels());
+    tracker.track(tracers, "tracers", owner);
+    return tracers;
+  }
+
+  /// On host: copies tracers indexed by (tracer, column, level) into a view
+  /// in this layout (see create_tracers), padding the last batch with copies
+  /// of the last column.
+  void gather_tracers(const TracersView &tracers,
+                      const TracersView &batched) const {
+    check_tracers(tracers, batched);
+    const int num_tracers = tracers.extent(0);
+    const int nbl = batch_levels();
+    const ColumnBatches batches = *this;
+    Kokkos::parallel_for(
+        "haero::ColumnBatches::gather_tracers",
+        Kokkos::RangePolicy<ExecutionSpace>(0,
+                                            num_tracers * num_batches_ * nbl),
+        KOKKOS_LAMBDA(const int i) {
+          const int q = i / (batches.num_batches_ * nbl);
+          const int b = (i / nbl) % batches.num_batches_, l = i % nbl;
+          const int col = b * batches.batch_size_ + l % batches.batch_size_;
+          const int k = l / batches.batch_size_;
+          batched(q, b, l) = tracers(q, (col < batches.num_columns_)
+                                            ? col
+                                            : batches.num_columns_ - 1,
+                                     k);
+        });
+  }
+
+  /// On host: copies tracers in this layout into a view indexed by (tracer,
+  /// column, level), ignoring padding.
+  void scatter_tracers(const TracersView &batched,
+                       const TracersView &tracers) const {
+    check_tracers(tracers, batched);
+    const int num_tracers = tracers.extent(0);
+    const ColumnBatches batches = *this;
+    Kokkos::parallel_for(
+        "haero::ColumnBatches::scatter_tracers",
+        Kokkos::RangePolicy<ExecutionSpace>(
+            0, num_tracers * num_columns_ * num_levels_),
+        KOKKOS_LAMBDA(const int i) {
+          const int q = i / (batches.num_columns_ * batches.num_levels_);
+          const int col = (i / batches.num_levels_) % batches.num_columns_;
+          const int k = i % batches.num_levels_;
+          tracers(q, col, k) =
+              batched(q, batches.batch(col), batches.batch_level(col, k));
+        });
+  }
+
+private:
+  // checks that the given views hold the same tracers in each layout
+  void check_tracers(const TracersView &tracers,
+                     const TracersView &batched) const {
+    EKAT_REQUIRE_MSG((tracers.extent(1) == num_columns_) &&
+                         (tracers.extent(2) == num_levels_),
+                     "ColumnBatches: tracers must be sized (num_tracers, "
+                     "num_columns, num_levels)!");
+    EKAT_REQUIRE_MSG((batched.extent(0) == tracers.extent(0)) &&
+                         (batched.extent(1) == num_batches_) &&
+                         (batched.extent(2) == batch_levels()),
+                     "ColumnBatches: batched tracers must be sized "
+                     "(num_tracers, num_batches, batch_levels)!");
+  }
+
+  ColumnLayout layout_;
+  int num_columns_;
+  int num_levels_;
+  int batch_size_;
+  int num_batches_;
+};
+
+/// @class AtmosphereSet
+/// This type stores the atmospheric state of many columns, laid out in
+/// batches (see ColumnBatches). It provides an Atmosphere for each batch,
+/// whose level-dependent fields are defined on the batch's levels. Because an
+/// Atmosphere has a single planetary boundary layer height, the columns of a
+/// batch must share the same height.
+class AtmosphereSet final {
+public:
+  /// The number of level-dependent fields in an Atmosphere.
+  static constexpr int num_fields = 11;
+
+  /// On host: allocates (zeroed) atmospheric state for the given batches of
+  /// columns.
+  explicit AtmosphereSet(const ColumnBatches &batches)
+      : batches_(batches),
+        fields_("haero::AtmosphereSet::fields", num_fields,
+                batches.num_batches(), batches.batch_levels()),
+        pblh_("haero::AtmosphereSet::pblh", batches.num_batches()),
+        column_pblh_("haero::AtmosphereSet::column_pblh",
+                     batches.num_columns()),
+        column_set_("haero::AtmosphereSet::column_set",
+                    batches.num_columns()) {}
+
+  /// On host or device: returns the layout of the columns.
+  KOKKOS_INLINE_FUNCTION
+  const ColumnBatches &batches() const { return batches_; }
+
+  /// On host: copies the state of the given column from the given Atmosphere,
+  /// which must have the batches' number of levels and the planetary boundary
+  /// layer height of any other column already set in its batch. Setting the
+  /// last column also sets any padding columns that follow it.
+  void set_column(const int col, const Atmosphere &atmosphere) {
+    EKAT_REQUIRE_MSG((col >= 0) && (col < batches_.num_columns()),
+                     "AtmosphereSet: invalid column " << col);
+    EKAT_REQUIRE_MSG(atmosphere.num_levels() == batches_.num_levels(),
+                     "AtmosphereSet: the atmosphere has "
+                         << atmosphere.num_levels() << " levels, expected "
+                         << batches_.num_levels());
+    const int num_levels = batches_.num_levels();
+    const int b = batches_.batch(col);
+    const Real pblh = atmosphere.planetary_boundary_layer_height;
+    const int first_col = b * batches_.batch_size();
+    for (int c = first_col; (c < first_col + batches_.batch_size()) &&
+                            (c < batches_.num_columns());
+         ++c) {
+      EKAT_REQUIRE_MSG((c == col) || !column_set_(c) ||
+                           (column_pblh_(c) == pblh),
+                       "AtmosphereSet: column "
+                           << col << " has a planetary boundary layer height "
+                           << "of " << pblh << ", but column " << c
+                           << " in the same batch has " << column_pblh_(c));
+    }
+    column_pblh_(col) = pblh;
+    column_set_(col) = true;
+    const int last_col = (col + 1 < batches_.num_columns())
+                             ? col
+                             : (b + 1) * batches_.batch_size() - 1;
+    const int num_copies = last_col - col + 1;
+    const auto fields = fields_;
+    const ColumnBatches batches = batches_;
+    Kokkos::parallel_for(
+        "haero::AtmosphereSet::set_column",
+        Kokkos::RangePolicy<ExecutionSpace>(0, num_copies * num_levels),
+        KOKKOS_LAMBDA(const int i) {
+          const int c = col + i / num_levels, k = i % num_levels;
+          for (int f = 0; f < num_fields; ++f) {
+            fields(f, b, batches.batch_level(c, k)) = field(atmosphere, f)(k);
+          }
+        });
+    Kokkos::deep_copy(Kokkos::subview(pblh_, b), pblh);
+  }
+
+  /// On host or device: returns the atmospheric state of the given batch,
+  /// defined on its batch levels.
+  KOKKOS_INLINE_FUNCTION
+  Atmosphere atmosphere(const int batch) const {
+    const int n = batches_.batch_levels();
+    auto column = [&](const int f) {
+      return ConstColumnView(&fields_(f, batch, 0), n);
+    };
+    return Atmosphere(n, column(0), column(1), column(2), column(3), column(4),
+                      column(5), column(6), column(7), column(8), column(9),
+                      column(10), pblh_(batch));
+  }
+
+private:
+  // returns the level-dependent field of the given Atmosphere with the given
+  // index, in the order of the Atmosphere constructor's arguments
+  KOKKOS_INLINE_FUNCTION
+  static const ConstColumnView &field(const Atmosphere &atmosphere,
+                                      const int f) {
+    switch (f) {
+    case 0:
+      return atmosphere.temperature;
+    case 1:
+      return atmosphere.pressure;
+    case 2:
+      return atmosphere.vapor_mixing_ratio;
+    case 3:
+      return atmosphere.liquid_mixing_ratio;
+    case 4:
+      return atmosphere.cloud_liquid_number_mixing_ratio;
+    case 5:
+      return atmosphere.ice_mixing_ratio;
+    case 6:
+      return atmosphere.cloud_ice_number_mixing_ratio;
+    case 7:
+      return atmosphere.height;
+    case 8:
+      return atmosphere.hydrostatic_dp;
+    case 9:
+      return atmosphere.cloud_fraction;
+    default:
+      return atmosphere.updraft_vel_ice_nucleation;
+    }
+  }
+
+  ColumnBatches batches_;
+  DeviceType::view_3d<Real> fields_;
+  DeviceType::view_1d<Real> pblh_;
+  // the boundary layer heights of the columns set so far, checked on host
+  HostType::view_1d<Real> column_pblh_;
+  HostType::view_1d<bool> column_set_;
+};
+
+} // namespace haero
+
+#endif
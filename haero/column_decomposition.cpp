@@ -0,0 +1,204 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "column_decomposition.hpp"
+#include "first_touch.hpp"
+
+#include <ekat/ekat_assert.hpp>
+
+#include <algorithm>
+
+namespace haero {
+
+namespace {
+
+#ifdef HAERO_ENABLE_MPI
+
+#if HAERO_DOUBLE_PRECISION
+const MPI_Datatype mpi_real = MPI_DOUBLE;
+#else
+const MPI_Datatype mpi_real = MPI_FLOAT;
+#endif
+
+// Reduces the given values in place over all ranks with the given operation.
+void all_reduce(MPI_Comm comm, Real *values, int count, MPI_Op op) {
+  MPI_Allreduce(MPI_IN_PLACE, values, count, mpi_real, op, comm);
+}
+
+#endif
+
+} // namespace
+
+ColumnDecomposition::ColumnDecomposition(int num_global_columns)
+#ifdef HAERO_ENABLE_MPI
+    : ColumnDecomposition(MPI_COMM_WORLD, num_global_columns) {
+}
+#else
+    : rank_(0), num_ranks_(1), num_global_columns_(num_global_columns) {
+  EKAT_REQUIRE_MSG(num_global_columns >= 0,
+                   "ColumnDecomposition: number of columns must be "
+                   "non-negative!");
+}
+#endif
+
+#ifdef HAERO_ENABLE_MPI
+ColumnDecomposition::ColumnDecomposition(MPI_Comm comm, int num_global_columns)
+    : comm_(comm), num_global_columns_(num_global_columns) {
+  EKAT_REQUIRE_MSG(num_global_columns >= 0,
+                   "ColumnDecomposition: number of columns must be "
+                   "non-negative!");
+  int initialized;
+  MPI_Initialized(&initialized);
+  EKAT_REQUIRE_MSG(initialized,
+                   "ColumnDecomposition: MPI must be initialized first!");
+  MPI_Comm_rank(comm_, &rank_);
+  MPI_Comm_size(comm_, &num_ranks_);
+}
+#endif
+
+int ColumnDecomposition::num_local_columns(int rank) const {
+  EKAT_ASSERT((rank >= 0) && (rank < num_ranks_));
+  const int base = num_global_columns_ / num_ranks_;
+  const int remainder = num_global_columns_ % num_ranks_;
+  return (rank < remainder) ? base + 1 : base;
+}
+
+int ColumnDecomposition::first_column(int rank) const {
+  EKAT_ASSERT((rank >= 0) && (rank < num_ranks_));
+  const int base = num_global_columns_ / num_ranks_;
+  const int remainder = num_global_columns_ % num_ranks_;
+  return rank * base + std::min(rank, remainder);
+}
+
+int ColumnDecomposition::owner(int global_column) const {
+  EKAT_REQUIRE_MSG(
+      (global_column >= 0) && (global_column < num_global_columns_),
+      "ColumnDecomposition::owner: invalid column index: " << global_column);
+  const int base = num_global_columns_ / num_ranks_;
+  const int remainder = num_global_columns_ % num_ranks_;
+  // the first (remainder) ranks each own (base + 1) columns
+  const int num_large_columns = remainder * (base + 1);
+  return (global_column < num_large_columns)
+             ? global_column / (base + 1)
+             : remainder + (global_column - num_large_columns) / base;
+}
+
+TracersView ColumnDecomposition::create_tracers(
+    const std::string &name, int num_tracers, int num_levels,
+    memory::ViewTracker &tracker, const std::string &owner) const {
+  return haero::create_tracers(name, num_tracers, num_local_columns(),
+                               num_levels, tracker, owner);
+}
+
+DeviceType::view_2d<Real> ColumnDecomposition::create_column_field(
+    const std::string &name, int num_levels, memory::ViewTracker &tracker,
+    const std::string &owner) const {
+  return haero::create_column_field(name, num_local_columns(), num_levels,
+                                    tracker, owner);
+}
+
+Real ColumnDecomposition::global_sum(Real local_value) const {
+#ifdef HAERO_ENABLE_MPI
+  all_reduce(comm_, &local_value, 1, MPI_SUM);
+#endif
+  return local_value;
+}
+
+Real ColumnDecomposition::global_min(Real local_value) const {
+#ifdef HAERO_ENABLE_MPI
+  all_reduce(comm_, &local_value, 1, MPI_MIN);
+#endif
+  return local_value;
+}
+
+Real ColumnDecomposition::global_max(Real local_value) const {
+#ifdef HAERO_ENABLE_MPI
+  all_reduce(comm_, &local_value, 1, MPI_MAX);
+#endif
+  return local_value;
+}
+
+void ColumnDecomposition::global_sum(std::vector<Real> &values) const {
+#ifdef HAERO_ENABLE_MPI
+  all_reduce(comm_, values.data(), static_cast<int>(values.size()), MPI_SUM);
+#endif
+}
+
+void ColumnDecomposition::global_min(std::vector<Real> &values) const {
+#ifdef HAERO_ENABLE_MPI
+  all_reduce(comm_, values.data(), static_cast<int>(values.size()), MPI_MIN);
+#endif
+}
+
+void ColumnDecomposition::global_max(std::vector<Real> &values) const {
+#ifdef HAERO_ENABLE_MPI
+  all_reduce(comm_, values.data(), static_cast<int>(values.size()), MPI_MAX);
+#endif
+}
+
+HostType::view_2d<Real> ColumnDecomposition::gather(
+    const HostType::view_2d<const Real> &local_data) const {
+  EKAT_REQUIRE_MSG(static_cast<int>(local_data.extent(0)) ==
+                       num_local_columns(),
+                   "ColumnDecomposition::gather: local data has "
+                       << local_data.extent(0) << " columns (expected "
+                       << num_local_columns() << ")");
+  const int num_fields = static_cast<int>(local_data.extent(1));
+
+#ifdef HAERO_ENABLE_MPI
+  // make sure every rank has the same number of fields
+  int fields[2] = {-num_fields, num_fields};
+  MPI_Allreduce(MPI_IN_PLACE, fields, 2, MPI_INT, MPI_MAX, comm_);
+  EKAT_REQUIRE_MSG(-fields[0] == fields[1],
+                   "ColumnDecomposition::gather: ranks disagree on the "
+                   "number of fields!");
+
+  // local rows are contiguous, so each rank's data lands in a contiguous
+  // block of rows on the root rank
+  HostType::view_2d<Real> global_data;
+  std::vector<int> counts, offsets;
+  if (is_root()) {
+    global_data = HostType::view_2d<Real>("global_data", num_global_columns_,
+                                          num_fields);
+    counts.resize(num_ranks_);
+    offsets.resize(num_ranks_);
+    for (int r = 0; r < num_ranks_; ++r) {
+      counts[r] = num_local_columns(r) * num_fields;
+      offsets[r] = first_column(r) * num_fields;
+    }
+  }
+  MPI_Gatherv(local_data.data(), num_local_columns() * num_fields, mpi_real,
+              global_data.data(), counts.data(), offsets.data(), mpi_real, 0,
+              comm_);
+  return global_data;
+#else
+  HostType::view_2d<Real> global_data("global_data", num_global_columns_,
+                                      num_fields);
+  Kokkos::deep_copy(global_data, local_data);
+  return global_data;
+#endif
+}
+
+HostType::view_1d<Real> ColumnDecomposition::gather(
+    const HostType::view_1d<const Real> &local_data) const {
+  HostType::view_2d<const Real> local(local_data.data(), local_data.extent(0),
+                                      1);
+  auto data = gather(local);
+  HostType::view_1d<Real> global_data;
+  if (is_root()) {
+    global_data = HostType::view_1d<Real>("global_data", num_global_columns_);
+    for (int i = 0; i < num_global_columns_; ++i) {
+      global_data(i) = data(i, 0);
+    }
+  }
+  return global_data;
+}
+
+void ColumnDecomposition::barrier() const {
+#ifdef HAERO_ENABLE_MPI
+  MPI_Barrier(comm_);
+#endif
+}
+
+} // namespace haero
@@ -0,0 +1,154 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_COLUMN_DECOMPOSITION_HPP
+#define HAERO_COLUMN_DECOMPOSITION_HPP
+
+#include <haero/haero.hpp>
+#include <haero/memory.hpp>
+
+#ifdef HAERO_ENABLE_MPI
+#include <mpi.h>
+#endif
+
+#include <string>
+#include <vector>
+
+namespace haero {
+
+/// @class ColumnDecomposition
+/// This type block-partitions a set of atmospheric columns (or ensemble
+/// members) across the ranks of an MPI communicator, so that each rank owns a
+/// contiguous range of global column indices. It creates rank-local views for
+/// the columns a rank owns, computes global statistics from rank-local values,
+/// and gathers rank-local data to the root rank for output.
+///
+/// All methods other than the simple queries are collective: every rank in
+/// the communicator must call them, in the same order. If Haero is built
+/// without MPI, a ColumnDecomposition describes a single rank owning every
+/// column.
+class ColumnDecomposition final {
+public:
+  /// Constructs a decomposition of the given number of columns over all
+  /// processes (MPI_COMM_WORLD if MPI is enabled). MPI must be initialized.
+  explicit ColumnDecomposition(int num_global_columns);
+
+#ifdef HAERO_ENABLE_MPI
+  /// Constructs a decomposition of the given number of columns over the ranks
+  /// of the given communicator. MPI must be initialized.
+  ColumnDecomposition(MPI_Comm comm, int num_global_columns);
+
+  /// Returns the communicator over which columns are decomposed.
+  MPI_Comm comm() const { return comm_; }
+#endif
+
+  ColumnDecomposition(const ColumnDecomposition &) = default;
+  ColumnDecomposition &operator=(const ColumnDecomposition &) = default;
+
+  /// Returns the rank of this process.
+  int rank() const { return rank_; }
+
+  /// Returns the number of ranks over which columns are decomposed.
+  int num_ranks() const { return num_ranks_; }
+
+  /// Returns true if this process is the root rank (rank 0), false if not.
+  bool is_root() const { return (rank_ == 0); }
+
+  /// Returns the total number of columns over all ranks.
+  int num_global_columns() const { return num_global_columns_; }
+
+  /// Returns the number of columns owned by this rank.
+  int num_local_columns() const { return num_local_columns(rank_); }
+
+  /// Returns the global index of the first column owned by this rank.
+  int first_column() const { return first_column(rank_); }
+
+  /// Returns the number of columns owned by the given rank. The first
+  /// (num_global_columns % num_ranks) ranks own one more column than the rest.
+  int num_local_columns(int rank) const;
+
+  /// Returns the global index of the first column owned by the given rank.
+  int first_column(int rank) const;
+
+  /// Returns the rank that owns the column with the given global index.
+  int owner(int global_column) const;
+
+  /// Returns the global index of the column with the given local index.
+  int global_column(int local_column) const {
+    return first_column() + local_column;
+  }
+
+  /// Creates a zeroed view with tracer data for the columns owned by this
+  /// rank, placing its pages for column-parallel kernels (see FirstTouch).
+  /// The view is recorded with Haero's memory registry in the given tracker.
+  /// @param [in] name The label for the view
+  /// @param [in] num_tracers The number of tracers in each column
+  /// @param [in] num_levels The number of vertical levels in each column
+  /// @param [in] tracker The caller's tracker, which holds the view's record
+  /// @param [in] owner The part of Haero (or the host) that owns the view
+  TracersView create_tracers(const std::string &name, int num_tracers,
+                             int num_levels, memory::ViewTracker &tracker,
+                             const std::string &owner) const;
+
+  /// Creates a zeroed view with data for a column-resolved quantity (such as
+  /// an atmospheric state variable) for the columns owned by this rank,
+  /// indexed by (local column, level) and placed like create_tracers.
+  /// @param [in] name The label for the view
+  /// @param [in] num_levels The number of vertical levels in each column
+  /// @param [in] tracker The caller's tracker, which holds the view's record
+  /// @param [in] owner The part of Haero (or the host) that owns the view
+  DeviceType::view_2d<Real>
+  create_column_field(const std::string &name, int num_levels,
+                      memory::ViewTracker &tracker,
+                      const std::string &owner) const;
+
+  /// Returns the sum of the given value over all ranks.
+  Real global_sum(Real local_value) const;
+
+  /// Returns the minimum of the given value over all ranks.
+  Real global_min(Real local_value) const;
+
+  /// Returns the maximum of the given value over all ranks.
+  Real global_max(Real local_value) const;
+
+  /// Replaces each element of the given array with its sum over all ranks.
+  void global_sum(std::vector<Real> &values) const;
+
+  /// Replaces each element of the given array with its minimum over all ranks.
+  void global_min(std::vector<Real> &values) const;
+
+  /// Replaces each element of the given array with its maximum over all ranks.
+  void global_max(std::vector<Real> &values) const;
+
+  /// Gathers per-column data from all ranks to the root rank.
+  /// @param [in] local_data A view indexed by (local column, field) with one
+  ///                        row for each column owned by this rank
+  /// @returns on the root rank, a view indexed by (global column, field) with
+  ///          data for all columns; on other ranks, an empty view
+  HostType::view_2d<Real>
+  gather(const HostType::view_2d<const Real> &local_data) const;
+
+  /// Gathers one value per column from all ranks to the root rank.
+  /// @param [in] local_data A view with one entry for each column owned by
+  ///                        this rank
+  /// @returns on the root rank, a view with the values for all columns; on
+  ///          other ranks, an empty view
+  HostType::view_1d<Real>
+  gather(const HostType::view_1d<const Real> &local_data) const;
+
+  /// Blocks until all ranks have reached this call.
+  void barrier() const;
+
+private:
+#ifdef HAERO_ENABLE_MPI
+  MPI_Comm comm_;
+#endif
+  int rank_;
+  int num_ranks_;
+  int num_global_columns_;
+};
+
+} // namespace haero
+
+#endif
@@ -0,0 +1,274 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_COLUMN_INTEGRALS_HPP
+#define HAERO_COLUMN_INTEGRALS_HPP
+
+#include <haero/constants.hpp>
+#include <haero/level_count.hpp>
+#include <haero/reductions.hpp>
+#include <haero/simd_dispatch.hpp>
+
+#include <ekat/ekat_assert.hpp>
+
+namespace haero {
+
+/** @defgroup ColumnIntegrals Column integrals and burdens
+
+  The column burden of a tracer with mixing ratio q is the vertical integral
+  @f$\frac{1}{g}\int q\,dp@f$, approximated by
+  @f$\frac{1}{g}\sum_k q_k \Delta p_k@f$ using the hydrostatic pressure
+  thickness of each level. Burdens of aerosol mass mixing ratios are in
+  [kg/m^2], and those of number mixing ratios are in [#/m^2].
+
+  The functions here integrate every tracer of a column in a single team
+  kernel. Tracers are grouped into Packs, and each team reduction over levels
+  accumulates several Packs at once, so Δp is read once per level for a whole
+  group of tracers. Reductions can optionally use compensated (TwoSum)
+  accumulation. The number of levels can be given as an int or as a
+  LevelCount, in which case the level loop has a compile-time trip count.
+
+  In CPU builds, compute_column_burdens_simd is an opt-in alternative that
+  computes uncompensated burdens with host kernels compiled for the widest
+  SIMD instruction set the CPU supports (see SimdKernels).
+
+ @{
+*/
+
+/// @struct ColumnIntegralSums
+/// Pack-valued accumulators for a group of tracers.
+template <int NumPacks> struct ColumnIntegralSums {
+  PackType sums[NumPacks];
+  PackType comps[NumPacks];
+};
+
+/// @struct ColumnIntegralReducer
+/// A Kokkos reducer for ColumnIntegralSums that combines partial sums with
+/// compensation.
+template <int NumPacks> struct ColumnIntegralReducer {
+  using reducer = ColumnIntegralReducer;
+  using value_type = ColumnIntegralSums<NumPacks>;
+  using result_view_type =
+      Kokkos::View<value_type, Kokkos::HostSpace, Kokkos::MemoryUnmanaged>;
+
+  KOKKOS_INLINE_FUNCTION
+  explicit ColumnIntegralReducer(value_type &value) : value_(value) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void join(value_type &dest, const value_type &src) const {
+    for (int p = 0; p < NumPacks; ++p) {
+      PackType sum, err;
+      two_sum(dest.sums[p], src.sums[p], sum, err);
+      dest.sums[p] = sum;
+      dest.comps[p] += src.comps[p] + err;
+    }
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void init(value_type &value) const {
+    for (int p = 0; p < NumPacks; ++p) {
+      value.sums[p] = 0;
+      value.comps[p] = 0;
+    }
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  value_type &reference() const { return value_; }
+
+  KOKKOS_INLINE_FUNCTION
+  result_view_type view() const { return result_view_type(&value_); }
+
+  KOKKOS_INLINE_FUNCTION
+  bool references_scalar() const { return true; }
+
+private:
+  value_type &value_;
+};
+
+/// @struct ColumnIntegrals
+/// Vertical integrals of many tracers within a single column.
+struct ColumnIntegrals {
+  /// The number of Packs of tracers accumulated by each team reduction.
+  static constexpr int packs_per_pass = 8;
+
+  /// On device: computes the integrals
+  /// @f$ I_i = s \sum_k q_i(k) w(k)@f$ of ntracers tracers over the nlev
+  /// levels of a column using the given team.
+  /// @param [in] team The Kokkos team that computes the integrals
+  /// @param [in] levels The number of vertical levels in the column (an int
+  ///                    or a LevelCount)
+  /// @param [in] ntracers The number of tracers to integrate
+  /// @param [in] q A function, lambda, or view that returns the value of tracer
+  ///               i at level k via q(i, k)
+  /// @param [in] w A view (or function) of level weights w(k)
+  /// @param [in] scale A factor s by which all integrals are multiplied
+  /// @param [out] integrals A view (or function) storing the integral of
+  ///                        tracer i in integrals(i)
+  /// @param [in] compensated If true, use compensated summation
+  template <typename Levels, typename TracerFunc, typename WeightView,
+            typename IntegralView>
+  KOKKOS_INLINE_FUNCTION static void
+  integrate(const ThreadTeam &team, const Levels &levels, const int ntracers,
+            const TracerFunc &q, const WeightView &w, const Real scale,
+            const IntegralView &integrals, const bool compensated = false) {
+    const int nlev = num_levels_of(levels);
+    constexpr int P = packs_per_pass;
+    constexpr int N = HAERO_PACK_SIZE;
+    const int npacks = PackInfo::num_packs(ntracers);
+    for (int first = 0; first < npacks; first += P) {
+      const int num_packs = (first + P < npacks) ? P : npacks - first;
+      ColumnIntegralSums<P> result;
+      Kokkos::parallel_reduce(
+          Kokkos::TeamThreadRange(team, nlev),
+          [&](const int k, ColumnIntegralSums<P> &acc) {
+            const Real wk = w(k);
+            for (int p = 0; p < num_packs; ++p) {
+              PackType x;
+              for (int s = 0; s < N; ++s) {
+                const int i = (first + p) * N + s;
+                x[s] = (i < ntracers) ? q(i, k) * wk : Real(0);
+              }
+              if (compensated) {
+                PackType sum, err;
+                two_sum(acc.sums[p], x, sum, err);
+                acc.sums[p] = sum;
+                acc.comps[p] += err;
+              } else {
+                acc.sums[p] += x;
+              }
+            }
+          },
+          ColumnIntegralReducer<P>(result));
+      Kokkos::parallel_for(Kokkos::TeamThreadRange(team, num_packs * N),
+                           [&](const int j) {
+                             const int p = j / N, s = j % N;
+                             const int i = (first + p) * N + s;
+                             if (i < ntracers) {
+                               integrals(i) = scale * (result.sums[p][s] +
+                                                       result.comps[p][s]);
+                             }
+                           });
+      team.team_barrier();
+    }
+  }
+
+  /// On device: computes the column burdens
+  /// @f$ B_i = \frac{1}{g}\sum_k q_i(k) \Delta p(k)@f$ of ntracers tracers
+  /// using the given team (see integrate for parameters).
+  template <typename Levels, typename TracerFunc, typename DpView,
+            typename BurdenView>
+  KOKKOS_INLINE_FUNCTION static void
+  burdens(const ThreadTeam &team, const Levels &levels, const int ntracers,
+          const TracerFunc &q, const DpView &hydrostatic_dp,
+          const BurdenView &burdens, const bool compensated = false) {
+    integrate(team, levels, ntracers, q, hydrostatic_dp,
+              Real(1) / Constants::gravity, burdens, compensated);
+  }
+};
+
+// On host: launches the kernel for compute_column_burdens, instantiated for
+// the given level count.
+template <typename Levels>
+void launch_column_burdens(
+    const Levels &levels, const TracersView &tracers,
+    const DeviceType::view_2d<const Real> &hydrostatic_dp,
+    const DeviceType::view_2d<Real> &burdens, const bool compensated) {
+  const int ntracers = tracers.extent(0);
+  const int ncols = tracers.extent(1);
+  Kokkos::parallel_for(
+      "haero::compute_column_burdens", ThreadTeamPolicy(ncols, Kokkos::AUTO),
+      KOKKOS_LAMBDA(const ThreadTeam &team) {
+        const int icol = team.league_rank();
+        auto q = [&](const int i, const int k) { return tracers(i, icol, k); };
+        auto dp = Kokkos::subview(hydrostatic_dp, icol, Kokkos::ALL);
+        auto b = Kokkos::subview(burdens, icol, Kokkos::ALL);
+        ColumnIntegrals::burdens(team, levels, ntracers, q, dp, b,
+                                 compensated);
+      });
+}
+
+/// On host: computes the column burdens of every tracer in every column in a
+/// single kernel launch, specialized for the number of levels if it is one of
+/// the FixedLevelCounts.
+/// @param [in] tracers A view of tracer mixing ratios, indexed by tracer,
+///                     column, and level
+/// @param [in] hydrostatic_dp A view of hydrostatic pressure thicknesses [Pa],
+///                            indexed by column and level
+/// @param [out] burdens A view of column burdens, indexed by column and
+///                      tracer
+/// @param [in] compensated If true, use compensated summation
+inline void
+compute_column_burdens(const TracersView &tracers,
+                       const DeviceType::view_2d<const Real> &hydrostatic_dp,
+                       const DeviceType::view_2d<Real> &burdens,
+                       const bool compensated = false) {
+  const int ntracers = tracers.extent(0);
+  const int ncols = tracers.extent(1);
+  const int nlev = tracers.extent(2);
+  EKAT_REQUIRE_MSG((hydrostatic_dp.extent(0) == ncols) &&
+                       (hydrostatic_dp.extent(1) == nlev),
+                   "compute_column_burdens: hydrostatic_dp must be sized "
+                   "(num_columns, num_levels)!");
+  EKAT_REQUIRE_MSG((burdens.extent(0) == ncols) &&
+                       (burdens.extent(1) == ntracers),
+                   "compute_column_burdens: burdens must be sized "
+                   "(num_columns, num_tracers)!");
+  dispatch_level_count(nlev, [&](const auto levels) {
+    launch_column_burdens(levels, tracers, hydrostatic_dp, burdens,
+                          compensated);
+  });
+}
+
+#ifndef HAERO_ENABLE_GPU
+/// On host: computes uncompensated column burdens like compute_column_burdens,
+/// integrating each column with the SimdKernels selected for the CPU (CPU
+/// builds only). This is opt-in: the SIMD kernels add up levels in a
+/// different order from compute_column_burdens, so the results can differ
+/// from it by round-off. Tracers and pressure thicknesses must be contiguous
+/// in level, and burdens contiguous in tracer.
+/// @param [in] tracers A view of tracer mixing ratios, indexed by tracer,
+///                     column, and level
+/// @param [in] hydrostatic_dp A view of hydrostatic pressure thicknesses [Pa],
+///                            indexed by column and level
+/// @param [out] burdens A view of column burdens, indexed by column and
+///                      tracer
+inline void compute_column_burdens_simd(
+    const TracersView &tracers,
+    const DeviceType::view_2d<const Real> &hydrostatic_dp,
+    const DeviceType::view_2d<Real> &burdens) {
+  const int ntracers = tracers.extent(0);
+  const int ncols = tracers.extent(1);
+  const int nlev = tracers.extent(2);
+  EKAT_REQUIRE_MSG((hydrostatic_dp.extent(0) == ncols) &&
+                       (hydrostatic_dp.extent(1) == nlev),
+                   "compute_column_burdens_simd: hydrostatic_dp must be sized "
+                   "(num_columns, num_levels)!");
+  EKAT_REQUIRE_MSG((burdens.extent(0) == ncols) &&
+                       (burdens.extent(1) == ntracers),
+                   "compute_column_burdens_simd: burdens must be sized "
+                   "(num_columns, num_tracers)!");
+  EKAT_REQUIRE_MSG((tracers.stride(2) == 1) &&
+                       (hydrostatic_dp.stride(1) == 1) &&
+                       (burdens.stride(1) == 1),
+                   "compute_column_burdens_simd: tracers and hydrostatic_dp "
+                   "must be contiguous in level, and burdens in tracer!");
+  const auto integrate = simd_kernels().integrate;
+  const std::ptrdiff_t tracer_stride = tracers.stride(0);
+  Kokkos::parallel_for(
+      "haero::compute_column_burdens_simd",
+      Kokkos::RangePolicy<ExecutionSpace>(0, ncols), [=](const int icol) {
+        integrate(ntracers, nlev, tracers.data() + icol * tracers.stride(1),
+                  tracer_stride,
+                  hydrostatic_dp.data() + icol * hydrostatic_dp.stride(0),
+                  Real(1) / Constants::gravity,
+                  burdens.data() + icol * burdens.stride(0));
+      });
+}
+#endif
+
+/// @} defgroup ColumnIntegrals
+
+} // namespace haero
+
+#endif
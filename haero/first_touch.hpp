@@ -0,0 +1,141 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_FIRST_TOUCH_HPP
+#define HAERO_FIRST_TOUCH_HPP
+
+#include <haero/haero.hpp>
+#include <haero/memory.hpp>
+
+#include <ekat/ekat_assert.hpp>
+
+#include <string>
+
+namespace haero {
+
+/** @defgroup FirstTouch First-touch allocation
+  On multi-socket hosts, the operating system places each page of memory on
+  the NUMA node of the thread that first writes to it. Kokkos initializes a
+  new view by flattening its indices over the threads of the execution space,
+  which (for column data stored tracer-first) places all columns of a given
+  tracer on the same node, and memory from kokkos_malloc is often zeroed by a
+  single thread. Either way, most threads of a column-parallel kernel then
+  work on remote memory.
+
+  The functions here allocate column data without initializing it and then
+  zero it with one thread team per column, so that each page lands on the
+  node of the thread that will later compute on it. For this to work, the
+  policy used for initialization must match the one used by the compute
+  kernels (Kokkos assigns league ranks to threads statically, so identical
+  policies give identical assignments). By default, both use column_policy().
+  On GPUs, these functions simply allocate and zero their data.
+
+ @{
+*/
+
+/// Returns the thread team policy used by default to parallelize over the
+/// given number of columns: one team per column, with Kokkos choosing the team
+/// size.
+inline ThreadTeamPolicy column_policy(const int num_columns) {
+  return ThreadTeamPolicy(num_columns, Kokkos::AUTO);
+}
+
+/// On host: zeroes the given tracer data (indexed by tracer, column, level)
+/// with the given thread team policy, one team per column.
+inline void first_touch_tracers(const TracersView &tracers,
+                                const ThreadTeamPolicy &policy) {
+  EKAT_REQUIRE_MSG(policy.league_size() == int(tracers.extent(1)),
+                   "first_touch_tracers: policy league size ("
+                       << policy.league_size() << ") != number of columns ("
+                       << tracers.extent(1) << ")");
+  const int num_tracers = tracers.extent(0), num_levels = tracers.extent(2);
+  Kokkos::parallel_for(
+      "haero::first_touch_tracers", policy,
+      KOKKOS_LAMBDA(const ThreadTeam &team) {
+        const int col = team.league_rank();
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team, num_tracers * num_levels),
+            [&](const int i) {
+              tracers(i / num_levels, col, i % num_levels) = 0;
+            });
+      });
+}
+
+/// On host: zeroes the given tracer data with the default column policy.
+inline void first_touch_tracers(const TracersView &tracers) {
+  first_touch_tracers(tracers, column_policy(tracers.extent(1)));
+}
+
+/// On host: zeroes the given column data (indexed by column, level) with the
+/// given thread team policy, one team per column.
+template <typename ColumnDataView>
+void first_touch_columns(const ColumnDataView &data,
+                         const ThreadTeamPolicy &policy) {
+  EKAT_REQUIRE_MSG(policy.league_size() == int(data.extent(0)),
+                   "first_touch_columns: policy league size ("
+                       << policy.league_size() << ") != number of columns ("
+                       << data.extent(0) << ")");
+  const int num_levels = data.extent(1);
+  Kokkos::parallel_for(
+      "haero::first_touch_columns", policy,
+      KOKKOS_LAMBDA(const ThreadTeam &team) {
+        const int col = team.league_rank();
+        Kokkos::parallel_for(Kokkos::TeamThreadRange(team, num_levels),
+                             [&](const int k) { data(col, k) = 0; });
+      });
+}
+
+/// On host: zeroes the given column data with the default column policy.
+template <typename ColumnDataView>
+void first_touch_columns(const ColumnDataView &data) {
+  first_touch_columns(data, column_policy(data.extent(0)));
+}
+
+/// On host: creates a zeroed view for tracer data, placing each column's pages
+/// with the default column policy. The caller owns the view, which is recorded
+/// with Haero's memory registry (as "tracers") in the given tracker.
+/// @param [in] name The label for the view
+/// @param [in] num_tracers The number of tracers in each column
+/// @param [in] num_columns The number of columns
+/// @param [in] num_levels The number of vertical levels in each column
+/// @param [in] tracker The caller's tracker, which holds the view's record
+/// @param [in] owner The part of Haero (or the host) that owns the view
+inline TracersView create_tracers(const std::string &name,
+                                  const int num_tracers, const int num_columns,
+                                  const int num_levels,
+                                  memory::ViewTracker &tracker,
+                                  const std::string &owner) {
+  TracersView tracers(Kokkos::view_alloc(Kokkos::WithoutInitializing, name),
+                      num_tracers, num_columns, num_levels);
+  tracker.track(tracers, "tracers", owner);
+  first_touch_tracers(tracers);
+  return tracers;
+}
+
+/// On host: creates a zeroed view for column data (indexed by column, level),
+/// placing each column's pages with the default column policy. The caller
+/// owns the view, which is recorded (as "columns") in the given tracker as
+/// for create_tracers.
+/// @param [in] name The label for the view
+/// @param [in] num_columns The number of columns
+/// @param [in] num_levels The number of vertical levels in each column
+/// @param [in] tracker The caller's tracker, which holds the view's record
+/// @param [in] owner The part of Haero (or the host) that owns the view
+inline DeviceType::view_2d<Real>
+create_column_field(const std::string &name, const int num_columns,
+                    const int num_levels, memory::ViewTracker &tracker,
+                    const std::string &owner) {
+  DeviceType::view_2d<Real> data(
+      Kokkos::view_alloc(Kokkos::WithoutInitializing, name), num_columns,
+      num_levels);
+  tracker.track(data, "columns", owner);
+  first_touch_columns(data);
+  return data;
+}
+
+/// @} defgroup FirstTouch
+
+} // namespace haero
+
+#endif
@@ -7,6 +7,8 @@
 
 #include <haero/haero_config.hpp>
 
+#include <ekat/ekat_pack.hpp>
+
 // Cuda "C++" can't handle lambdas consisting of private/protected methods
 // This seems awful, but other solutions seem to involve dancing carefully
 // around various areas in code, or sacrificing encapsulation in CPU builds.
@@ -61,6 +63,12 @@ using ColumnView = ekat::Unmanaged<typename DeviceType::view_1d<Real>>;
 using ConstColumnView =
     ekat::Unmanaged<typename DeviceType::view_1d<const Real>>;
 
+/// A Pack is a fixed-size array of Reals used to vectorize calculations.
+using PackType = ekat::Pack<Real, HAERO_PACK_SIZE>;
+
+/// PackInfo helps map between numbers of Reals and numbers of Packs.
+using PackInfo = ekat::PackInfo<HAERO_PACK_SIZE>;
+
 // Returns haero's version string.
 const char *version();
 
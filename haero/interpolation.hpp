@@ -0,0 +1,321 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_INTERPOLATION_HPP
+#define HAERO_INTERPOLATION_HPP
+
+#include <haero/math.hpp>
+#include <haero/memory.hpp>
+
+#include <ekat/ekat_assert.hpp>
+
+namespace haero {
+
+/// This type selects how a ColumnInterpolator maps source profiles onto
+/// model levels.
+enum class InterpolationMode {
+  /// piecewise-linear interpolation in the vertical coordinate
+  linear,
+  /// piecewise-linear interpolation in the logarithm of the vertical
+  /// coordinate, which must be positive (e.g. pressure)
+  log_pressure,
+  /// first-order conservative remapping of level means, with grids given by
+  /// the coordinates of level interfaces
+  conservative
+};
+
+/// @class ColumnInterpolator
+/// This type maps profiles given on the vertical grids of a data source
+/// (prescribed forcing, initial conditions) onto model levels, for many
+/// columns and fields at once. Each column has its own source and target
+/// grids, which must be strictly monotone (increasing or decreasing, like
+/// vector_is_monotone requires). set_grids locates every target level within
+/// its column's source grid and stores the resulting indices and weights,
+/// which interpolate then applies to any number of fields, so the search is
+/// done once per grid rather than once per field (or per step, for a fixed
+/// forcing grid).
+///
+/// Because target levels are sorted, each thread of a column's team locates
+/// its first target level with a binary search and the rest by walking from
+/// the previous level's source interval, merge-style, instead of searching
+/// for each level separately.
+///
+/// Targets outside the source grid take the value at the nearest end of the
+/// source grid. Conservative remapping conserves the integral of each field
+/// over the part of each target level that lies within the source grid.
+class ColumnInterpolator final {
+public:
+  /// On host: creates an interpolator for the given numbers of columns,
+  /// source levels, and target (model) levels, using the given mode.
+  ColumnInterpolator(int num_columns, int num_source_levels, int num_levels,
+                     InterpolationMode mode = InterpolationMode::linear)
+      : mode_(mode), num_source_levels_(num_source_levels),
+        num_levels_(num_levels),
+        index_("haero::ColumnInterpolator::index", num_columns,
+               num_points(num_levels)),
+        weight_("haero::ColumnInterpolator::weight", num_columns,
+                num_points(num_levels)) {
+    EKAT_REQUIRE_MSG((num_columns > 0) && (num_levels > 0),
+                     "ColumnInterpolator: numbers of columns and levels must "
+                     "be positive!");
+    EKAT_REQUIRE_MSG(num_points(num_source_levels) >= 2,
+                     "ColumnInterpolator: the source grid needs at least 2 "
+                     "points!");
+    if (mode == InterpolationMode::conservative) {
+      source_widths_ = DeviceType::view_2d<Real>(
+          "haero::ColumnInterpolator::source_widths", num_columns,
+          num_source_levels);
+      tracker_.track(source_widths_, "workspace", "haero::ColumnInterpolator");
+    }
+    tracker_.track(index_, "workspace", "haero::ColumnInterpolator");
+    tracker_.track(weight_, "workspace", "haero::ColumnInterpolator");
+  }
+
+  /// On host: returns the interpolation mode.
+  InterpolationMode mode() const { return mode_; }
+
+  /// On host: returns the number of columns.
+  int num_columns() const { return index_.extent(0); }
+
+  /// On host: returns the number of source levels.
+  int num_source_levels() const { return num_source_levels_; }
+
+  /// On host: returns the number of target levels.
+  int num_levels() const { return num_levels_; }
+
+  /// On host: returns the number of grid points for the given number of
+  /// levels: one per level, or one per level interface for conservative
+  /// remapping.
+  int num_points(const int levels) const {
+    return (mode_ == InterpolationMode::conservative) ? levels + 1 : levels;
+  }
+
+  /// On host: locates the target grid of each column within its source grid,
+  /// for use by later calls to interpolate. Throws if any grid isn't strictly
+  /// monotone, or has nonpositive coordinates in log_pressure mode.
+  /// @param [in] source_coords The coordinates of the source grid points,
+  ///                           indexed by column and point
+  /// @param [in] target_coords The coordinates of the target grid points,
+  ///                           indexed by column and point
+  void set_grids(const DeviceType::view_2d<const Real> &source_coords,
+                 const DeviceType::view_2d<const Real> &target_coords) {
+    const int ncols = num_columns();
+    const int nsrc = num_points(num_source_levels_);
+    const int ntgt = num_points(num_levels_);
+    EKAT_REQUIRE_MSG((source_coords.extent(0) == ncols) &&
+                         (source_coords.extent(1) == nsrc),
+                     "ColumnInterpolator: source_coords must be sized "
+                     "(num_columns, num_points(num_source_levels))!");
+    EKAT_REQUIRE_MSG((target_coords.extent(0) == ncols) &&
+                         (target_coords.extent(1) == ntgt),
+                     "ColumnInterpolator: target_coords must be sized "
+                     "(num_columns, num_points(num_levels))!");
+    const bool log_coords = (mode_ == InterpolationMode::log_pressure);
+    const int num_invalid = count_invalid_grids(source_coords, log_coords) +
+                            count_invalid_grids(target_coords, log_coords);
+    EKAT_REQUIRE_MSG(num_invalid == 0,
+                     "ColumnInterpolator: found "
+                         << num_invalid
+                         << " grids that aren't strictly monotone"
+                         << (log_coords ? " with positive coordinates!" : "!"));
+
+    const auto index = index_;
+    const auto weight = weight_;
+    const auto widths = source_widths_;
+    Kokkos::parallel_for(
+        "haero::ColumnInterpolator::set_grids",
+        ThreadTeamPolicy(ncols, Kokkos::AUTO),
+        KOKKOS_LAMBDA(const ThreadTeam &team) {
+          const int col = team.league_rank();
+          // coordinates are transformed to increase along the source grid
+          const Real sign =
+              (source_coords(col, nsrc - 1) > source_coords(col, 0)) ? 1 : -1;
+          const auto c = [&](const Real x) {
+            return sign * (log_coords ? log(x) : x);
+          };
+          const auto src = [&](const int i) {
+            return c(source_coords(col, i));
+          };
+          // each thread locates a contiguous chunk of target points
+          const int team_size = team.team_size();
+          const int nchunks = (team_size < ntgt) ? team_size : ntgt;
+          const int chunk_size = (ntgt + nchunks - 1) / nchunks;
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team, nchunks), [&](const int chunk) {
+                const int first = chunk * chunk_size;
+                const int last =
+                    (first + chunk_size < ntgt) ? first + chunk_size : ntgt;
+                int i = -1;
+                for (int k = first; k < last; ++k) {
+                  const Real x = c(target_coords(col, k));
+                  i = (i < 0) ? search(src, nsrc, x) : walk(src, nsrc, x, i);
+                  const Real w = (x - src(i)) / (src(i + 1) - src(i));
+                  index(col, k) = i;
+                  weight(col, k) = (w < 0) ? Real(0) : ((w > 1) ? Real(1) : w);
+                }
+              });
+          if (widths.size() > 0) {
+            Kokkos::parallel_for(
+                Kokkos::TeamThreadRange(team, nsrc - 1), [&](const int i) {
+                  const Real dx =
+                      source_coords(col, i + 1) - source_coords(col, i);
+                  widths(col, i) = (dx < 0) ? -dx : dx;
+                });
+          }
+        });
+  }
+
+  /// On host: interpolates the given source profiles of any number of fields
+  /// onto the target grids given to the last call to set_grids.
+  /// @param [in] source_values The values of each field on the source grid,
+  ///                           indexed by field, column, and source level
+  /// @param [out] values The values of each field on the target grid,
+  ///                     indexed by field, column, and level
+  void interpolate(const DeviceType::view_3d<const Real> &source_values,
+                   const DeviceType::view_3d<Real> &values) const {
+    const int nfields = values.extent(0);
+    const int ncols = num_columns();
+    const int nsrc = num_source_levels_;
+    const int nlev = num_levels_;
+    EKAT_REQUIRE_MSG((values.extent(1) == ncols) && (values.extent(2) == nlev),
+                     "ColumnInterpolator: values must be sized "
+                     "(num_fields, num_columns, num_levels)!");
+    EKAT_REQUIRE_MSG((source_values.extent(0) == nfields) &&
+                         (source_values.extent(1) == ncols) &&
+                         (source_values.extent(2) == nsrc),
+                     "ColumnInterpolator: source_values must be sized "
+                     "(num_fields, num_columns, num_source_levels)!");
+    const bool conservative = (mode_ == InterpolationMode::conservative);
+    const auto index = index_;
+    const auto weight = weight_;
+    const auto widths = source_widths_;
+    Kokkos::parallel_for(
+        "haero::ColumnInterpolator::interpolate",
+        ThreadTeamPolicy(ncols, Kokkos::AUTO),
+        KOKKOS_LAMBDA(const ThreadTeam &team) {
+          const int col = team.league_rank();
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team, nfields * nlev), [&](const int j) {
+                const int f = j / nlev, k = j % nlev;
+                const auto v = [&](const int i) {
+                  return source_values(f, col, i);
+                };
+                if (conservative) {
+                  values(f, col, k) =
+                      remap(v, Kokkos::subview(widths, col, Kokkos::ALL),
+                            index(col, k), weight(col, k), index(col, k + 1),
+                            weight(col, k + 1));
+                } else {
+                  const int i = index(col, k);
+                  const Real w = weight(col, k);
+                  values(f, col, k) = (1 - w) * v(i) + w * v(i + 1);
+                }
+              });
+        });
+  }
+
+private:
+  // On host: returns the number of columns of the given grid coordinates that
+  // aren't strictly monotone, or (if positive is true) have nonpositive
+  // coordinates.
+  static int count_invalid_grids(const DeviceType::view_2d<const Real> &coords,
+                                 const bool positive) {
+    const int npts = coords.extent(1);
+    int num_invalid = 0;
+    Kokkos::parallel_reduce(
+        "haero::ColumnInterpolator::count_invalid_grids",
+        Kokkos::RangePolicy<ExecutionSpace>(0, coords.extent(0)),
+        KOKKOS_LAMBDA(const int col, int &n) {
+          const bool increasing = (coords(col, npts - 1) > coords(col, 0));
+          bool valid = !positive || (coords(col, 0) > 0);
+          for (int i = 1; i < npts; ++i) {
+            const Real x0 = coords(col, i - 1), x1 = coords(col, i);
+            valid = valid && (increasing ? (x1 > x0) : (x1 < x0)) &&
+                    (!positive || (x1 > 0));
+          }
+          n += valid ? 0 : 1;
+        },
+        num_invalid);
+    return num_invalid;
+  }
+
+  // On device: returns the index i of the interval [c(i), c(i + 1)] of the
+  // given increasing coordinates c(0), ..., c(n - 1) that contains x, using a
+  // binary search. Points outside the coordinates map to the first or last
+  // interval.
+  template <typename Coords>
+  KOKKOS_INLINE_FUNCTION static int search(const Coords &c, const int n,
+                                           const Real x) {
+    int lo = 0, hi = n - 2;
+    while (lo < hi) {
+      const int mid = (lo + hi + 1) / 2;
+      if (x < c(mid)) {
+        hi = mid - 1;
+      } else {
+        lo = mid;
+      }
+    }
+    return lo;
+  }
+
+  // On device: returns the same interval as search, found by walking from
+  // the given interval, which is fast for a nearby point.
+  template <typename Coords>
+  KOKKOS_INLINE_FUNCTION static int walk(const Coords &c, const int n,
+                                         const Real x, int i) {
+    while ((i > 0) && (x < c(i))) {
+      --i;
+    }
+    while ((i < n - 2) && (x >= c(i + 1))) {
+      ++i;
+    }
+    return i;
+  }
+
+  // On device: returns the mean of the given source level values v(i) with
+  // the given widths over the target level whose interfaces lie at the given
+  // fractions wa and wb of source levels ia and ib.
+  template <typename Values, typename Widths>
+  KOKKOS_INLINE_FUNCTION static Real remap(const Values &v, const Widths &dx,
+                                           int ia, Real wa, int ib, Real wb) {
+    if ((ia > ib) || ((ia == ib) && (wa > wb))) {
+      const int i = ia;
+      ia = ib;
+      ib = i;
+      const Real w = wa;
+      wa = wb;
+      wb = w;
+    }
+    Real integral, width;
+    if (ia == ib) {
+      width = (wb - wa) * dx(ia);
+      integral = width * v(ia);
+    } else {
+      width = (1 - wa) * dx(ia) + wb * dx(ib);
+      integral = (1 - wa) * dx(ia) * v(ia) + wb * dx(ib) * v(ib);
+      for (int i = ia + 1; i < ib; ++i) {
+        width += dx(i);
+        integral += dx(i) * v(i);
+      }
+    }
+    // a target level outside the source grid takes the nearest source value
+    return (width > 0) ? integral / width : v(ia);
+  }
+
+  InterpolationMode mode_;
+  int num_source_levels_, num_levels_;
+  // the source interval containing each target point, and the point's
+  // fractional position within it, indexed by column and target point
+  DeviceType::view_2d<int> index_;
+  DeviceType::view_2d<Real> weight_;
+  // the widths of the source levels (conservative remapping only), indexed
+  // by column and source level
+  DeviceType::view_2d<Real> source_widths_;
+  // registers the views above with Haero's memory registry
+  memory::ViewTracker tracker_;
+};
+
+} // namespace haero
+
+#endif
@@ -0,0 +1,128 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_LEVEL_COUNT_HPP
+#define HAERO_LEVEL_COUNT_HPP
+
+#include <haero/haero.hpp>
+
+#include <utility>
+#include <variant>
+
+namespace haero {
+
+/// The template argument of a LevelCount whose number of levels is known only
+/// at run time.
+constexpr int dynamic_levels = 0;
+
+/// @struct LevelCount
+/// This type carries the number of vertical levels in a column. For N > 0,
+/// the number of levels is the compile-time constant N, so kernels
+/// instantiated for it have known trip counts: their level loops can be
+/// unrolled and vectorized without remainders, and their scratch data can be
+/// sized statically. LevelCount<dynamic_levels> holds a number of levels known
+/// only at run time, for grids without a specialization.
+template <int N> struct LevelCount {
+  static_assert(N > 0, "A fixed level count must be positive!");
+
+  /// true if the number of levels is a compile-time constant
+  static constexpr bool is_fixed = true;
+
+  /// On host or device: returns the number of levels.
+  KOKKOS_INLINE_FUNCTION
+  static constexpr int num_levels() { return N; }
+
+  /// On host or device: returns the number of packs that hold a quantity
+  /// defined on every level.
+  KOKKOS_INLINE_FUNCTION
+  static constexpr int num_packs() {
+    return (N + HAERO_PACK_SIZE - 1) / HAERO_PACK_SIZE;
+  }
+};
+
+template <> struct LevelCount<dynamic_levels> {
+  /// true if the number of levels is a compile-time constant
+  static constexpr bool is_fixed = false;
+
+  /// On host or device: creates a level count for the given number of levels.
+  KOKKOS_INLINE_FUNCTION
+  explicit LevelCount(int num_levels = 0) : num_levels_(num_levels) {}
+
+  /// On host or device: returns the number of levels.
+  KOKKOS_INLINE_FUNCTION
+  int num_levels() const { return num_levels_; }
+
+  /// On host or device: returns the number of packs that hold a quantity
+  /// defined on every level.
+  KOKKOS_INLINE_FUNCTION
+  int num_packs() const {
+    return (num_levels_ + HAERO_PACK_SIZE - 1) / HAERO_PACK_SIZE;
+  }
+
+private:
+  int num_levels_;
+};
+
+/// On host or device: returns the given number of levels, so that code can
+/// accept either an int or a LevelCount.
+KOKKOS_INLINE_FUNCTION
+constexpr int num_levels_of(int num_levels) { return num_levels; }
+
+/// On host or device: returns the number of levels in the given LevelCount.
+template <int N>
+KOKKOS_INLINE_FUNCTION constexpr int
+num_levels_of(const LevelCount<N> &levels) {
+  return levels.num_levels();
+}
+
+/// The level counts for which Haero instantiates specialized kernels, set by
+/// the HAERO_FIXED_LEVEL_COUNTS CMake variable (e.g. "72;128"). By default,
+/// the list is empty and every kernel uses a run-time level count.
+#ifdef HAERO_FIXED_LEVEL_COUNTS
+using FixedLevelCounts = std::integer_sequence<int, HAERO_FIXED_LEVEL_COUNTS>;
+#else
+using FixedLevelCounts = std::integer_sequence<int>;
+#endif
+
+// This helper maps a list of fixed level counts to a variant of LevelCounts.
+template <typename LevelCounts> struct AnyLevelCountOf;
+
+template <int... N> struct AnyLevelCountOf<std::integer_sequence<int, N...>> {
+  using type = std::variant<LevelCount<dynamic_levels>, LevelCount<N>...>;
+};
+
+/// This type holds any of the level counts supported by the build: a fixed
+/// count in FixedLevelCounts, or a run-time count.
+using AnyLevelCount = typename AnyLevelCountOf<FixedLevelCounts>::type;
+
+// On host: returns the level count for the given number of levels, which is
+// fixed if the number is in the given list of level counts.
+template <int... N>
+AnyLevelCount make_level_count(int num_levels,
+                               std::integer_sequence<int, N...>) {
+  AnyLevelCount levels{LevelCount<dynamic_levels>(num_levels)};
+  (void)((num_levels == N ? (levels = LevelCount<N>(), true) : false) || ...);
+  return levels;
+}
+
+/// On host: returns the level count for the given number of levels: a fixed
+/// count if the number is in FixedLevelCounts, and a run-time count if not.
+/// Select the level count once at setup, and call std::visit on it to launch
+/// kernels instantiated for it (see dispatch_level_count).
+inline AnyLevelCount make_level_count(int num_levels) {
+  return make_level_count(num_levels, FixedLevelCounts());
+}
+
+/// On host: calls the given function (usually a generic lambda that launches
+/// a kernel) with the level count for the given number of levels, returning
+/// its result. The function is instantiated for every level count in
+/// FixedLevelCounts, and for a run-time count.
+template <typename Function>
+decltype(auto) dispatch_level_count(int num_levels, Function &&f) {
+  return std::visit(std::forward<Function>(f), make_level_count(num_levels));
+}
+
+} // namespace haero
+
+#endif
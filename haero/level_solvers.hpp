@@ -0,0 +1,90 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_LEVEL_SOLVERS_HPP
+#define HAERO_LEVEL_SOLVERS_HPP
+
+#include <haero/haero.hpp>
+
+namespace haero {
+
+/** @defgroup LevelSolvers Batched per-level linear solvers
+
+  Implicit integrators for aerosol processes solve a small dense linear
+  system (one row per tracer) on every vertical level of a column. The
+  functions here factor and solve these systems for all levels of a column at
+  once. Levels are grouped into Packs, so each arithmetic operation acts on a
+  Pack of levels, and a team's threads divide the Packs among themselves.
+
+  Matrices are factored without pivoting, which is appropriate for the
+  matrices @f$I - \gamma\Delta t J@f$ of implicit integrators (which tend to
+  the identity as the step shrinks), but not for general matrices.
+
+ @{
+*/
+
+/// A LevelMatricesView stores a dense matrix for each level of a column,
+/// indexed by (row, column, level pack).
+using LevelMatricesView = ekat::Unmanaged<DeviceType::view_3d<PackType>>;
+
+/// A LevelVectorsView stores a vector for each level of a column, indexed by
+/// (row, level pack).
+using LevelVectorsView = ekat::Unmanaged<DeviceType::view_2d<PackType>>;
+
+/// On device: replaces each matrix in the given set with its LU factorization
+/// (with a unit lower triangle that is not stored). Call team_barrier before
+/// using the factors on other threads.
+/// @param [in] team The Kokkos team factoring the matrices
+/// @param [inout] A The matrices to factor, indexed by (row, column, level
+///                  pack)
+KOKKOS_INLINE_FUNCTION
+void factor_level_matrices(const ThreadTeam &team, const LevelMatricesView &A) {
+  const int n = A.extent(0);
+  Kokkos::parallel_for(
+      Kokkos::TeamThreadRange(team, A.extent(2)), [&](const int p) {
+        for (int c = 0; c < n; ++c) {
+          const PackType pivot_inv = PackType(1) / A(c, c, p);
+          for (int r = c + 1; r < n; ++r) {
+            const PackType l = A(r, c, p) * pivot_inv;
+            A(r, c, p) = l;
+            for (int j = c + 1; j < n; ++j) {
+              A(r, j, p) -= l * A(c, j, p);
+            }
+          }
+        }
+      });
+}
+
+/// On device: solves the linear system on each level, given the LU factors
+/// computed by factor_level_matrices, overwriting the right-hand sides with
+/// the solutions. Call team_barrier before using the solutions on other
+/// threads.
+/// @param [in] team The Kokkos team solving the systems
+/// @param [in] LU The factored matrices, indexed by (row, column, level pack)
+/// @param [inout] b The right-hand sides, indexed by (row, level pack)
+KOKKOS_INLINE_FUNCTION
+void solve_level_systems(const ThreadTeam &team, const LevelMatricesView &LU,
+                         const LevelVectorsView &b) {
+  const int n = LU.extent(0);
+  Kokkos::parallel_for(
+      Kokkos::TeamThreadRange(team, LU.extent(2)), [&](const int p) {
+        for (int r = 1; r < n; ++r) {
+          for (int c = 0; c < r; ++c) {
+            b(r, p) -= LU(r, c, p) * b(c, p);
+          }
+        }
+        for (int r = n - 1; r >= 0; --r) {
+          for (int c = r + 1; c < n; ++c) {
+            b(r, p) -= LU(r, c, p) * b(c, p);
+          }
+          b(r, p) /= LU(r, r, p);
+        }
+      });
+}
+
+/// @}
+
+} // namespace haero
+
+#endif
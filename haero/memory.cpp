@@ -0,0 +1,252 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "memory.hpp"
+#include "utils.hpp"
+
+#include <ekat/ekat_assert.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+
+namespace haero {
+
+namespace memory {
+
+namespace {
+
+// A single recorded allocation.
+struct Record {
+  std::size_t bytes;
+  std::string space;
+  std::string category;
+  std::string owner;
+};
+
+// The registry itself: live allocations and usage tallies, guarded by a mutex
+// so that host threads can allocate concurrently.
+struct Registry {
+  std::mutex mutex;
+  std::map<const void *, Record> records;
+  // the shared records of allocations tracked by ViewTrackers
+  std::map<const void *, std::weak_ptr<const void>> shared_records;
+  std::map<std::string, Usage> spaces;
+  std::map<std::string, std::map<std::string, std::map<std::string, Usage>>>
+      owners; // space -> category -> owner
+  bool report_on_finalize = false;
+};
+
+Registry &registry() {
+  static Registry registry_{};
+  return registry_;
+}
+
+void add(Usage &usage, std::size_t bytes) {
+  usage.current_bytes += bytes;
+  usage.num_allocations += 1;
+  if (usage.current_bytes > usage.peak_bytes) {
+    usage.peak_bytes = usage.current_bytes;
+  }
+}
+
+void remove(Usage &usage, std::size_t bytes) {
+  usage.current_bytes -= bytes;
+  usage.num_allocations -= 1;
+}
+
+// Writes a number of bytes in human-readable units.
+std::string bytes_string(std::size_t bytes) {
+  static const char *units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+  double value = static_cast<double>(bytes);
+  int u = 0;
+  while ((value >= 1024.0) && (u < 4)) {
+    value /= 1024.0;
+    ++u;
+  }
+  std::ostringstream ss;
+  ss << std::fixed << std::setprecision((u == 0) ? 0 : 2) << value << " "
+     << units[u];
+  return ss.str();
+}
+
+bool report_requested() {
+  const char *env = std::getenv("HAERO_MEMORY_REPORT");
+  return (env && is_boolean(env) && as_boolean(env));
+}
+
+} // namespace
+
+void record_allocation(const void *ptr, std::size_t bytes,
+                       const std::string &space, const std::string &category,
+                       const std::string &owner) {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  EKAT_REQUIRE_MSG(reg.records.find(ptr) == reg.records.end(),
+                   "memory::record_allocation: address "
+                       << ptr << " (" << category << ", " << owner
+                       << ") is already tracked!");
+  reg.records[ptr] = Record{bytes, space, category, owner};
+  add(reg.spaces[space], bytes);
+  add(reg.owners[space][category][owner], bytes);
+}
+
+void record_deallocation(const void *ptr) {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  auto iter = reg.records.find(ptr);
+  EKAT_REQUIRE_MSG(iter != reg.records.end(),
+                   "memory::record_deallocation: address "
+                       << ptr << " is not tracked!");
+  const Record &record = iter->second;
+  remove(reg.spaces[record.space], record.bytes);
+  remove(reg.owners[record.space][record.category][record.owner],
+         record.bytes);
+  reg.records.erase(iter);
+}
+
+bool is_tracked(const void *ptr) {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  return (reg.records.find(ptr) != reg.records.end());
+}
+
+void ViewTracker::track(const void *ptr, std::size_t bytes,
+                        const std::string &space, const std::string &category,
+                        const std::string &owner) {
+  for (const auto &record : records_) {
+    if (record.get() == ptr) {
+      return;
+    }
+  }
+  std::shared_ptr<const void> record;
+  {
+    auto &reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    auto iter = reg.shared_records.find(ptr);
+    if (iter != reg.shared_records.end()) {
+      record = iter->second.lock();
+    }
+    if (!record) {
+      if (reg.records.find(ptr) != reg.records.end()) {
+        return; // recorded by someone else
+      }
+      reg.records[ptr] = Record{bytes, space, category, owner};
+      add(reg.spaces[space], bytes);
+      add(reg.owners[space][category][owner], bytes);
+      // the record is released with its last reference
+      record = std::shared_ptr<const void>(ptr, [](const void *p) {
+        auto &reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        auto shared = reg.shared_records.find(p);
+        if ((shared != reg.shared_records.end()) && shared->second.expired()) {
+          reg.shared_records.erase(shared);
+        }
+        // the registry may have been reset by finalize() in the meantime
+        auto iter = reg.records.find(p);
+        if (iter != reg.records.end()) {
+          const Record &record = iter->second;
+          remove(reg.spaces[record.space], record.bytes);
+          remove(reg.owners[record.space][record.category][record.owner],
+                 record.bytes);
+          reg.records.erase(iter);
+        }
+      });
+      reg.shared_records[ptr] = record;
+    }
+  }
+  records_.push_back(std::move(record));
+}
+
+void ViewTracker::untrack(const void *ptr) {
+  for (auto iter = records_.begin(); iter != records_.end(); ++iter) {
+    if (iter->get() == ptr) {
+      records_.erase(iter); // outside the registry's lock
+      break;
+    }
+  }
+}
+
+Usage usage(const std::string &space) {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  auto iter = reg.spaces.find(space);
+  return (iter != reg.spaces.end()) ? iter->second : Usage{0, 0, 0};
+}
+
+std::map<std::string, Usage> usage_by_space() {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  return reg.spaces;
+}
+
+std::map<std::string, std::map<std::string, Usage>>
+usage_by_category(const std::string &space) {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  auto iter = reg.owners.find(space);
+  return (iter != reg.owners.end())
+             ? iter->second
+             : std::map<std::string, std::map<std::string, Usage>>();
+}
+
+void report(std::ostream &os) {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  os << line_delim();
+  os << "Haero memory usage (current / peak):\n";
+  if (reg.spaces.empty()) {
+    os << indent_string(1) << "(no tracked allocations)\n";
+  }
+  for (const auto &space : reg.spaces) {
+    os << indent_string(1) << space.first << ": "
+       << bytes_string(space.second.current_bytes) << " / "
+       << bytes_string(space.second.peak_bytes) << "\n";
+    for (const auto &category : reg.owners[space.first]) {
+      os << indent_string(2) << category.first << ":\n";
+      for (const auto &owner : category.second) {
+        os << indent_string(3) << owner.first << ": "
+           << bytes_string(owner.second.current_bytes) << " / "
+           << bytes_string(owner.second.peak_bytes) << " ("
+           << owner.second.num_allocations << " allocations)\n";
+      }
+    }
+  }
+  os << line_delim();
+}
+
+void set_report_on_finalize(bool enabled) {
+  auto &reg = registry();
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  reg.report_on_finalize = enabled;
+}
+
+void finalize(std::ostream &os) {
+  auto &reg = registry();
+  bool write_report;
+  {
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    write_report = reg.report_on_finalize || report_requested();
+  }
+  if (write_report) {
+    report(os);
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    for (const auto &record : reg.records) {
+      os << "WARNING: unreleased allocation of "
+         << bytes_string(record.second.bytes) << " in " << record.second.space
+         << " (" << record.second.category << ", " << record.second.owner
+         << ")\n";
+    }
+  }
+  std::lock_guard<std::mutex> lock(reg.mutex);
+  reg.records.clear();
+  reg.shared_records.clear();
+  reg.spaces.clear();
+  reg.owners.clear();
+}
+
+} // namespace memory
+
+} // namespace haero
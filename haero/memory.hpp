@@ -0,0 +1,169 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_MEMORY_HPP
+#define HAERO_MEMORY_HPP
+
+#include <haero/haero.hpp>
+
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace haero {
+
+// The memory namespace contains Haero's memory accounting registry, which
+// tags allocations with a category (what kind of data it holds) and an owner
+// (what part of Haero or the host model requested it), and tracks current and
+// peak usage for each memory space.
+namespace memory {
+
+/// @struct Usage
+/// This type stores the current and peak number of bytes associated with a
+/// specific memory space, category, or owner.
+struct Usage {
+  /// number of bytes currently allocated
+  std::size_t current_bytes;
+  /// largest number of bytes allocated at any one time
+  std::size_t peak_bytes;
+  /// number of live allocations
+  std::size_t num_allocations;
+};
+
+/// On host: records an allocation of the given number of bytes at the given
+/// address in the memory space with the given name.
+/// @param [in] ptr The address of the allocated memory. Must be unique among
+///                 all recorded allocations.
+/// @param [in] bytes The size of the allocation [bytes]
+/// @param [in] space The name of the memory space holding the allocation
+/// @param [in] category The kind of data stored (e.g. "tracers", "tables")
+/// @param [in] owner The part of Haero (or the host) that owns the allocation
+void record_allocation(const void *ptr, std::size_t bytes,
+                       const std::string &space, const std::string &category,
+                       const std::string &owner);
+
+/// On host: records the deallocation of memory at the given address. The
+/// address must belong to a recorded allocation.
+void record_deallocation(const void *ptr);
+
+/// On host: returns true if the given address belongs to a recorded
+/// allocation, false if not.
+bool is_tracked(const void *ptr);
+
+/// On host: allocates the given number of bytes within the given memory space,
+/// recording the allocation with the given category and owner.
+template <typename MemSpace = MemorySpace>
+void *allocate(const std::string &category, const std::string &owner,
+               std::size_t bytes) {
+  void *ptr = Kokkos::kokkos_malloc<MemSpace>(category + ":" + owner, bytes);
+  record_allocation(ptr, bytes, MemSpace::name(), category, owner);
+  return ptr;
+}
+
+/// On host: frees memory allocated with allocate<MemSpace>, removing it from
+/// the registry.
+template <typename MemSpace = MemorySpace> void deallocate(void *ptr) {
+  record_deallocation(ptr);
+  Kokkos::kokkos_free<MemSpace>(ptr);
+}
+
+/// On host: records the storage of the given (managed or unmanaged) view under
+/// the given category and owner. Views sharing storage with an already-tracked
+/// view are not counted twice. Call untrack_view before the storage is
+/// released.
+template <typename ViewType>
+void track_view(const ViewType &view, const std::string &category,
+                const std::string &owner) {
+  if (view.data() && !is_tracked(view.data())) {
+    record_allocation(view.data(),
+                      view.span() * sizeof(typename ViewType::value_type),
+                      ViewType::memory_space::name(), category, owner);
+  }
+}
+
+/// On host: removes the storage of a view recorded with track_view from the
+/// registry.
+template <typename ViewType> void untrack_view(const ViewType &view) {
+  if (view.data() && is_tracked(view.data())) {
+    record_deallocation(view.data());
+  }
+}
+
+/// @class ViewTracker
+/// This type records the storage of the views owned by an object, keeping each
+/// record while the tracker refers to it. An object that allocates views
+/// holds a tracker alongside them. A copy of a tracker (like a copy of its
+/// owner, which shares the owner's views) has its own references to the same
+/// records, so a storage remains recorded until no tracker refers to it:
+/// untracking a view in one copy leaves it recorded for the others.
+class ViewTracker final {
+public:
+  /// On host: creates a tracker with no tracked views.
+  ViewTracker() = default;
+
+  /// On host: records the storage of the given view under the given category
+  /// and owner, or refers to its existing record if another tracker recorded
+  /// it. Storage recorded with record_allocation or track_view isn't counted
+  /// twice (and isn't released by the tracker).
+  template <typename ViewType>
+  void track(const ViewType &view, const std::string &category,
+             const std::string &owner) {
+    if (view.data()) {
+      track(view.data(), view.span() * sizeof(typename ViewType::value_type),
+            ViewType::memory_space::name(), category, owner);
+    }
+  }
+
+  /// On host: removes this tracker's reference to the record of the given
+  /// view's storage, which is released if no other tracker refers to it.
+  /// Call this before the owner replaces the view.
+  template <typename ViewType> void untrack(const ViewType &view) {
+    if (view.data()) {
+      untrack(static_cast<const void *>(view.data()));
+    }
+  }
+
+private:
+  void track(const void *ptr, std::size_t bytes, const std::string &space,
+             const std::string &category, const std::string &owner);
+  void untrack(const void *ptr);
+
+  // references to the records of the tracked storage, each of which is
+  // released with its last reference
+  std::vector<std::shared_ptr<const void>> records_;
+};
+
+/// On host: returns the usage of the memory space with the given name.
+Usage usage(const std::string &space);
+
+/// On host: returns the usage of every memory space with recorded allocations,
+/// keyed by memory space name.
+std::map<std::string, Usage> usage_by_space();
+
+/// On host: returns the usage within the given memory space, keyed by
+/// category and then by owner.
+std::map<std::string, std::map<std::string, Usage>>
+usage_by_category(const std::string &space);
+
+/// On host: writes a breakdown of current and peak memory usage by memory
+/// space, category and owner to the given stream.
+void report(std::ostream &os = std::cout);
+
+/// On host: enables or disables the report written by finalize(). Reporting
+/// is also enabled by setting the HAERO_MEMORY_REPORT environment variable to
+/// a true boolean value ("true", "yes", "on").
+void set_report_on_finalize(bool enabled);
+
+/// On host: writes a memory report (if enabled) and resets the registry,
+/// noting any allocations that were never released.
+void finalize(std::ostream &os = std::cout);
+
+} // namespace memory
+
+} // namespace haero
+
+#endif
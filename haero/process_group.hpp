@@ -0,0 +1,1079 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_PROCESS_GROUP_HPP
+#define HAERO_PROCESS_GROUP_HPP
+
+#include <haero/aero_process.hpp>
+#include <haero/floating_point.hpp>
+#include <haero/level_count.hpp>
+#include <haero/level_solvers.hpp>
+#include <haero/memory.hpp>
+
+#include <Kokkos_Graph.hpp>
+#include <ekat/ekat_assert.hpp>
+
+#include <optional>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace haero {
+
+/// This type selects how the processes in a ProcessGroup are launched.
+enum class ProcessDispatch {
+  /// processes run one after another on the default execution space instance
+  sequential,
+  /// processes run side by side on separate execution space instances (GPU
+  /// streams). Only GPU backends support this mode: instances partitioned from
+  /// a host thread pool run one after another when launched from a single
+  /// host thread.
+  concurrent
+};
+
+/// This type selects how the processes in a ProcessGroup store their
+/// tendencies.
+enum class TendencyMode {
+  /// each process writes to its own tendency buffer, and the buffers are
+  /// summed afterward
+  buffered,
+  /// every process adds its tendencies to a single shared array, in one fused
+  /// kernel (see AeroProcess::accumulate_tendencies)
+  accumulate
+};
+
+/// This type selects how ProcessGroup::advance integrates the summed
+/// tendencies of a group's processes over a step.
+enum class ProcessIntegrator {
+  /// an explicit forward Euler step
+  forward_euler,
+  /// a backward Euler step, solved with a simplified Newton iteration that
+  /// factors the Jacobian once per step
+  backward_euler,
+  /// the 2-stage, L-stable Rosenbrock-W method ROS2 (Verwer et al. 1999),
+  /// whose stages share a single Jacobian factorization
+  rosenbrock,
+  /// sequential splitting: each process in turn takes a forward Euler step
+  /// from the state left by the one before it, adding dt * tendencies
+  /// directly to the prognostics (see AeroProcess::accumulate_tendencies)
+  split
+};
+
+/// This type trait is true if the given ColumnState can restrict itself to a
+/// range of levels (with a level_tile method, see ProcessGroup), and false if
+/// not.
+template <typename ColumnState, typename = void>
+struct HasLevelTiles : std::false_type {};
+
+template <typename ColumnState>
+struct HasLevelTiles<ColumnState,
+                     std::void_t<decltype(std::declval<const ColumnState &>()
+                                              .level_tile(0, 0))>>
+    : std::true_type {};
+
+/// @class ProcessGroup
+/// This type runs a set of independent aerosol processes (see
+/// docs/processes.md) that share an aerosol configuration, and sums their
+/// tendencies. Because every process computes its tendencies from the same
+/// state, the processes can run concurrently: each writes to its own tendency
+/// buffer, and a final fused kernel adds the buffers together.
+///
+/// Processes obtain the data for each column from a ColumnState, a copyable
+/// type that provides the following methods, callable on host and device:
+/// * `Atmosphere atmosphere(int col) const`
+/// * `Surface surface(int col) const`
+/// * `Prognostics prognostics(int col) const`
+/// * `Diagnostics diagnostics(int col) const`
+/// * `Tendencies tendencies(const TracersView &buffer, int col) const`, which
+///   returns tendencies stored in the given column of a (tracer, column,
+///   level) buffer
+///
+/// A group can also advance its prognostics over a step with the integrator
+/// selected by set_integrator. The implicit integrators couple the group's
+/// processes through their Jacobians (see AeroProcess::compute_jacobian) and
+/// require that the Prognostics type provide `num_tracers()`, `num_levels()`
+/// and element access `(tracer, level)`.
+///
+/// If every process in the group can accumulate its tendencies, the group can
+/// drop its per-process buffers (see set_tendency_mode), and the split
+/// integrator can update prognostics without any tendency storage.
+///
+/// A group of vertically local processes can run tiled over levels (see
+/// set_level_tile_size), which requires that the ColumnState also provide
+/// * `level_tile(int first_level, int num_levels) const`, which returns a
+///   ColumnState (of any type) for the given range of levels of every column
+///
+/// If the number of levels is one of the FixedLevelCounts, the group selects
+/// kernels specialized for it when it is constructed, and passes the
+/// LevelCount to its processes (see AeroProcess::compute_tendencies).
+template <typename AerosolConfig, typename... ProcessImpls>
+class ProcessGroup final {
+public:
+  using AeroConfig = AerosolConfig;
+  using Processes = std::tuple<AeroProcess<AerosolConfig, ProcessImpls>...>;
+
+  /// number of processes in the group
+  static constexpr int num_processes = sizeof...(ProcessImpls);
+
+  static_assert(num_processes > 0, "A ProcessGroup needs at least 1 process!");
+
+  /// true if every process in the group can accumulate its tendencies
+  static constexpr bool accumulates_tendencies =
+      (AeroProcess<AerosolConfig, ProcessImpls>::accumulates_tendencies &&
+       ...);
+
+  /// true if every process in the group is vertically local (see
+  /// IsVerticallyLocal)
+  static constexpr bool vertically_local =
+      (AeroProcess<AerosolConfig, ProcessImpls>::vertically_local && ...);
+
+  /// Constructs a group of processes operating on tracer data with the given
+  /// dimensions.
+  /// @param [in] num_tracers The number of tracers in each column
+  /// @param [in] num_columns The number of columns
+  /// @param [in] num_levels The number of vertical levels in each column
+  /// @param [in] processes The processes in the group
+  ProcessGroup(int num_tracers, int num_columns, int num_levels,
+               const AeroProcess<AerosolConfig, ProcessImpls> &...processes)
+      : processes_(processes...), num_tracers_(num_tracers),
+        num_columns_(num_columns), num_levels_(num_levels),
+        levels_(make_level_count(num_levels)),
+        tendency_mode_(TendencyMode::buffered), level_tile_size_(0),
+        buffers_(Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                                    "haero::ProcessGroup::buffers"),
+                 num_processes, num_tracers, num_columns, num_levels),
+        dispatch_(ProcessDispatch::sequential), num_concurrent_launches_(0),
+        integrator_(ProcessIntegrator::forward_euler),
+        max_newton_iterations_(8), newton_rel_tolerance_(1e-6),
+        newton_abs_tolerance_(0) {
+    (references_.add(processes.id()), ...);
+    tracker_.track(buffers_, "workspace", "haero::ProcessGroup");
+  }
+
+  /// On host: returns the processes in the group.
+  const Processes &processes() const { return processes_; }
+
+  /// On host: returns the level count for which the group's kernels are
+  /// instantiated.
+  const AnyLevelCount &level_count() const { return levels_; }
+
+  /// On host: returns the mode in which the group's processes store their
+  /// tendencies.
+  TendencyMode tendency_mode() const { return tendency_mode_; }
+
+  /// On host: selects the mode in which the group's processes store their
+  /// tendencies. The accumulate mode requires that every process provide
+  /// accumulate_tendencies, and frees the per-process buffers. Because its
+  /// processes share one array, they run in a single kernel, and the dispatch
+  /// mode is ignored. A group tiled over levels (see set_level_tile_size)
+  /// can't return to the buffered mode.
+  void set_tendency_mode(TendencyMode mode) {
+    EKAT_REQUIRE_MSG((mode == TendencyMode::buffered) ||
+                         accumulates_tendencies,
+                     "ProcessGroup: accumulate mode requires that every "
+                     "process provide accumulate_tendencies!");
+    EKAT_REQUIRE_MSG((mode == TendencyMode::accumulate) ||
+                         (level_tile_size_ == 0),
+                     "ProcessGroup: level tiling requires the accumulate "
+                     "tendency mode!");
+    tendency_mode_ = mode;
+    step_graph_.reset();
+    if (mode == TendencyMode::accumulate) {
+      tracker_.untrack(buffers_);
+      buffers_ = DeviceType::view<Real ****>();
+    } else if (buffers_.extent(0) == 0) {
+      buffers_ = DeviceType::view<Real ****>(
+          Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                             "haero::ProcessGroup::buffers"),
+          num_processes, num_tracers_, num_columns_, num_levels_);
+      tracker_.track(buffers_, "workspace", "haero::ProcessGroup");
+    }
+  }
+
+  /// On host: returns the number of levels in each tile of the group's tiled
+  /// kernels, or 0 if they aren't tiled.
+  int level_tile_size() const { return level_tile_size_; }
+
+  /// On host: tiles the kernels that run every process in the group over
+  /// levels: each thread team runs all of the processes on a tile of the given
+  /// number of levels before moving on to the next tile. A tile's data then
+  /// stays in cache from one process to the next, instead of being streamed
+  /// from memory by every process; choose a tile size for which the tracers
+  /// and tendencies of a tile fit in a core's L2 cache. Tiling requires that
+  /// every process be vertically local, that the ColumnState provide
+  /// level_tile, and that the group use the accumulate tendency mode with the
+  /// forward_euler or split integrator, whose kernels are the ones tiled. A
+  /// tile size of 0 disables tiling.
+  void set_level_tile_size(int tile_size) {
+    EKAT_REQUIRE_MSG(tile_size >= 0,
+                     "ProcessGroup: tile_size must be nonnegative!");
+    EKAT_REQUIRE_MSG((tile_size == 0) || vertically_local,
+                     "ProcessGroup: level tiling requires that every process "
+                     "be vertically local!");
+    EKAT_REQUIRE_MSG((tile_size == 0) ||
+                         (tendency_mode_ == TendencyMode::accumulate),
+                     "ProcessGroup: level tiling requires the accumulate "
+                     "tendency mode!");
+    EKAT_REQUIRE_MSG((tile_size == 0) || !is_implicit(integrator_),
+                     "ProcessGroup: level tiling requires the forward_euler "
+                     "or split integrator!");
+    level_tile_size_ = tile_size;
+    step_graph_.reset();
+  }
+
+  /// On host: returns the dispatch mode for the group.
+  ProcessDispatch dispatch() const { return dispatch_; }
+
+  /// On host: selects the sequential dispatch mode.
+  void set_sequential_dispatch() {
+    dispatch_ = ProcessDispatch::sequential;
+    instances_.clear();
+    step_graph_.reset();
+  }
+
+  /// On host: selects the concurrent dispatch mode, partitioning the default
+  /// execution space among the processes in proportion to the given weights
+  /// (e.g. their relative costs). By default, every process gets an equal
+  /// share. Throws on host backends (see ProcessDispatch::concurrent).
+  void set_concurrent_dispatch(
+      const std::vector<int> &weights = std::vector<int>(num_processes, 1)) {
+    EKAT_REQUIRE_MSG(weights.size() == num_processes,
+                     "ProcessGroup: expected " << num_processes
+                                               << " weights, got "
+                                               << weights.size());
+#ifndef HAERO_ENABLE_GPU
+    EKAT_REQUIRE_MSG(false, "ProcessGroup: concurrent dispatch requires a GPU "
+                            "backend!");
+#endif
+    dispatch_ = ProcessDispatch::concurrent;
+    auto instances =
+        Kokkos::Experimental::partition_space(ExecutionSpace(), weights);
+    instances_.assign(instances.begin(), instances.end());
+    step_graph_.reset();
+  }
+
+  /// On host: returns the number of process kernels launched on their own
+  /// execution space instances in the concurrent dispatch mode since the group
+  /// was created.
+  long num_concurrent_launches() const { return num_concurrent_launches_; }
+
+  /// On host: returns the integrator used by advance.
+  ProcessIntegrator integrator() const { return integrator_; }
+
+  /// On host: selects the integrator used by advance, allocating any
+  /// workspace it needs. The split integrator requires that every process
+  /// provide accumulate_tendencies, and the implicit integrators can't be
+  /// used by a group tiled over levels (see set_level_tile_size).
+  void set_integrator(ProcessIntegrator integrator) {
+    EKAT_REQUIRE_MSG((integrator != ProcessIntegrator::split) ||
+                         accumulates_tendencies,
+                     "ProcessGroup: the split integrator requires that every "
+                     "process provide accumulate_tendencies!");
+    EKAT_REQUIRE_MSG(!is_implicit(integrator) || (level_tile_size_ == 0),
+                     "ProcessGroup: level tiling requires the forward_euler "
+                     "or split integrator!");
+    integrator_ = integrator;
+    step_graph_.reset();
+    if (integrator == ProcessIntegrator::split) {
+      return; // no workspace needed
+    }
+    const int num_tracers = num_tracers_, num_levels = num_levels_;
+    if ((integrator != ProcessIntegrator::forward_euler) &&
+        (jacobians_.extent(0) == 0)) {
+      const int num_packs = PackInfo::num_packs(num_levels);
+      auto alloc = [](const std::string &name) {
+        return Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                                  "haero::ProcessGroup::" + name);
+      };
+      jacobians_ = DeviceType::view<Real ****>(
+          alloc("jacobians"), num_columns_, num_levels, num_tracers,
+          num_tracers);
+      process_jacobians_ = DeviceType::view<Real ****>(
+          alloc("process_jacobians"), num_columns_, num_levels, num_tracers,
+          num_tracers);
+      matrices_ = DeviceType::view<PackType ****>(
+          alloc("matrices"), num_columns_, num_tracers, num_tracers,
+          num_packs);
+      rhs_ = DeviceType::view<PackType ***>(alloc("rhs"), num_columns_,
+                                            num_tracers, num_packs);
+      for (auto *work : {&stage_, &increments_, &fd_state_, &fd_tendencies_,
+                         &fd_perturbed_tendencies_}) {
+        *work = TracersView(alloc("workspace"), num_tracers, num_columns_,
+                            num_levels);
+        tracker_.track(*work, "workspace", "haero::ProcessGroup");
+      }
+      tracker_.track(jacobians_, "workspace", "haero::ProcessGroup");
+      tracker_.track(process_jacobians_, "workspace", "haero::ProcessGroup");
+      tracker_.track(matrices_, "workspace", "haero::ProcessGroup");
+      tracker_.track(rhs_, "workspace", "haero::ProcessGroup");
+    }
+    if (rates_.extent(0) == 0) {
+      rates_ = TracersView(
+          Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                             "haero::ProcessGroup::rates"),
+          num_tracers, num_columns_, num_levels);
+      tracker_.track(rates_, "workspace", "haero::ProcessGroup");
+    }
+  }
+
+  /// On host: sets the parameters of the Newton iteration used by the
+  /// backward Euler integrator. The iteration stops when every tracer's
+  /// update is within rel_tolerance * |q| + abs_tolerance, or after the given
+  /// number of iterations.
+  void set_newton_iteration(int max_iterations, Real rel_tolerance,
+                            Real abs_tolerance) {
+    EKAT_REQUIRE_MSG(max_iterations > 0,
+                     "ProcessGroup: max_iterations must be positive!");
+    max_newton_iterations_ = max_iterations;
+    newton_rel_tolerance_ = rel_tolerance;
+    newton_abs_tolerance_ = abs_tolerance;
+    step_graph_.reset();
+  }
+
+  /// On host: launches every process in the group to compute tendencies at
+  /// time t over the step dt, storing their sum in the given tendencies.
+  /// @param [in] t The simulation time [s]
+  /// @param [in] dt The simulation time step [s]
+  /// @param [in] state The ColumnState that provides data for each column
+  /// @param [out] tendencies The summed tendencies, indexed by (tracer,
+  ///                         column, level)
+  template <typename ColumnState>
+  void compute_tendencies(Real t, Real dt, const ColumnState &state,
+                          const TracersView &tendencies) const {
+    EKAT_REQUIRE_MSG((tendencies.extent(0) == num_tracers_) &&
+                         (tendencies.extent(1) == num_columns_) &&
+                         (tendencies.extent(2) == num_levels_),
+                     "ProcessGroup: tendencies have the wrong dimensions!");
+    std::visit(
+        [&](const auto &levels) {
+          enqueue_tendencies(StepTimes{t, dt}, levels, state, tendencies,
+                             EagerLauncher());
+        },
+        levels_);
+  }
+
+  /// On host: advances the prognostics of every column from time t to t + dt
+  /// with the group's integrator, updating them in place.
+  /// @param [in] t The simulation time [s]
+  /// @param [in] dt The simulation time step [s]
+  /// @param [in] state The ColumnState that provides data for each column
+  template <typename ColumnState>
+  void advance(Real t, Real dt, const ColumnState &state) {
+    prepare_integrator();
+    std::visit(
+        [&](const auto &levels) {
+          enqueue_step(StepTimes{t, dt}, levels, state, EagerLauncher());
+        },
+        levels_);
+  }
+
+  /// On host: records the sequence of kernels that advance launches for the
+  /// given state as a graph (Kokkos::Experimental::Graph), using the group's
+  /// current integrator and tendency mode. replay_step then launches the
+  /// whole sequence at once with new step times, which avoids most of the
+  /// per-kernel launch overhead that dominates steps with few columns. In a
+  /// recorded step, the processes of a buffered group are independent
+  /// branches of the graph, whatever the dispatch mode. Changing any of the
+  /// group's settings discards the recording.
+  /// @param [in] state The ColumnState that provides data for each column.
+  ///                   Like a view, it refers to data that can be updated
+  ///                   between replays.
+  template <typename ColumnState>
+  void record_step(const ColumnState &state) {
+    prepare_integrator();
+    if (step_times_.extent(0) == 0) {
+      step_times_ =
+          DeviceType::view_1d<Real>("haero::ProcessGroup::step_times", 2);
+      h_step_times_ = Kokkos::create_mirror_view(step_times_);
+    }
+    const RecordedTimes times{step_times_};
+    step_graph_ = Kokkos::Experimental::create_graph(
+        ExecutionSpace(), [&](const auto &root) {
+          std::visit(
+              [&](const auto &levels) {
+                enqueue_step(times, levels, state, GraphLauncher{root});
+              },
+              levels_);
+        });
+  }
+
+  /// On host: returns true if a step has been recorded with record_step,
+  /// false if not.
+  bool has_recorded_step() const { return step_graph_.has_value(); }
+
+  /// On host: advances the prognostics of the ColumnState given to
+  /// record_step from time t to t + dt by replaying the recorded step.
+  /// @param [in] t The simulation time [s]
+  /// @param [in] dt The simulation time step [s]
+  void replay_step(Real t, Real dt) {
+    EKAT_REQUIRE_MSG(has_recorded_step(),
+                     "ProcessGroup: no step has been recorded!");
+    h_step_times_(0) = t;
+    h_step_times_(1) = dt;
+    // this copy waits for any previous replay, which reads the step times
+    Kokkos::deep_copy(step_times_, h_step_times_);
+    step_graph_->submit();
+  }
+
+private:
+  // This functor takes an implicit step in one column per thread team.
+  template <typename ColumnState> struct ImplicitStep {
+    Processes processes;
+    ColumnState state;
+    ProcessIntegrator integrator;
+    TendencyMode tendency_mode;
+    Real t, dt;
+    int max_newton_iterations;
+    Real newton_rel_tolerance, newton_abs_tolerance;
+    DeviceType::view<Real ****> buffers;
+    TracersView rates, stage, increments;
+    TracersView fd_state, fd_tendencies, fd_perturbed_tendencies;
+    DeviceType::view<Real ****> jacobians, process_jacobians;
+    DeviceType::view<PackType ****> matrices;
+    DeviceType::view<PackType ***> rhs;
+
+    KOKKOS_INLINE_FUNCTION
+    void operator()(const ThreadTeam &team) const {
+      const int col = team.league_rank();
+      const int num_tracers = rates.extent(0), num_levels = rates.extent(2);
+      const int num_values = num_tracers * num_levels;
+      const auto y = state.prognostics(col);
+      const auto y_stage = state.tendencies(stage, col);
+      const auto dy = state.tendencies(increments, col);
+      const auto f = state.tendencies(rates, col);
+      const LevelMatricesView A(Kokkos::subview(
+          matrices, col, Kokkos::ALL, Kokkos::ALL, Kokkos::ALL));
+      const LevelVectorsView b(
+          Kokkos::subview(rhs, col, Kokkos::ALL, Kokkos::ALL));
+
+      // form and factor I - gamma * dt * J(y) on each level
+      const Real gamma = (integrator == ProcessIntegrator::rosenbrock)
+                             ? 1 + 1 / sqrt(Real(2))
+                             : 1;
+      compute_jacobian(team, y, col);
+      form_matrices(team, col, gamma * dt, A);
+      team.team_barrier();
+      factor_level_matrices(team, A);
+      team.team_barrier();
+
+      if (integrator == ProcessIntegrator::rosenbrock) {
+        // (I - gamma dt J) k1 = f(y)
+        compute_rates(team, t, y, f, col);
+        load_rhs(team, f, f, 0, b);
+        solve_level_systems(team, A, b);
+        team.team_barrier();
+        store_solution(team, b, dy);
+        team.team_barrier();
+        // (I - gamma dt J) k2 = f(y + dt k1) - 2 k1
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team, num_values), [&](const int i) {
+              const int q = i / num_levels, k = i % num_levels;
+              y_stage(q, k) = y(q, k) + dt * dy(q, k);
+            });
+        team.team_barrier();
+        compute_rates(team, t + dt, y_stage, f, col);
+        load_rhs(team, f, dy, -2, b);
+        solve_level_systems(team, A, b);
+        team.team_barrier();
+        // y += dt (3/2 k1 + 1/2 k2)
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team, num_values), [&](const int i) {
+              const int q = i / num_levels, k = i % num_levels;
+              const int p = k / PackType::n, s = k % PackType::n;
+              y(q, k) += dt * (1.5 * dy(q, k) + 0.5 * b(q, p)[s]);
+            });
+        team.team_barrier();
+      } else {
+        // solve y_stage - y - dt f(y_stage) = 0, starting from y_stage = y
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team, num_values), [&](const int i) {
+              const int q = i / num_levels, k = i % num_levels;
+              y_stage(q, k) = y(q, k);
+            });
+        team.team_barrier();
+        for (int iter = 0; iter < max_newton_iterations; ++iter) {
+          compute_rates(team, t + dt, y_stage, f, col);
+          // residual: dt f(y_stage) - (y_stage - y)
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team, num_values), [&](const int i) {
+                const int q = i / num_levels, k = i % num_levels;
+                dy(q, k) = dt * f(q, k) - (y_stage(q, k) - y(q, k));
+              });
+          team.team_barrier();
+          load_rhs(team, dy, dy, 0, b);
+          solve_level_systems(team, A, b);
+          team.team_barrier();
+          int num_unconverged = 0;
+          Kokkos::parallel_reduce(
+              Kokkos::TeamThreadRange(team, num_values),
+              [&](const int i, int &unconverged) {
+                const int q = i / num_levels, k = i % num_levels;
+                const int p = k / PackType::n, s = k % PackType::n;
+                const Real delta = b(q, p)[s];
+                y_stage(q, k) += delta;
+                const Real value = y_stage(q, k);
+                if (abs(delta) > newton_rel_tolerance * abs(value) +
+                                     newton_abs_tolerance) {
+                  ++unconverged;
+                }
+              },
+              num_unconverged);
+          team.team_barrier();
+          if (num_unconverged == 0) {
+            break;
+          }
+        }
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team, num_values), [&](const int i) {
+              const int q = i / num_levels, k = i % num_levels;
+              y(q, k) = y_stage(q, k);
+            });
+        team.team_barrier();
+      }
+    }
+
+    // computes the summed tendencies f of all processes at the state y
+    template <typename Prognostics>
+    KOKKOS_INLINE_FUNCTION void compute_rates(const ThreadTeam &team, Real time,
+                                              const Prognostics &y,
+                                              const Prognostics &f,
+                                              int col) const {
+      const int num_tracers = rates.extent(0), num_levels = rates.extent(2);
+      const int num_values = num_tracers * num_levels;
+      if constexpr (accumulates_tendencies) {
+        if (tendency_mode == TendencyMode::accumulate) {
+          Kokkos::parallel_for(Kokkos::TeamThreadRange(team, num_values),
+                               [&](const int i) {
+                                 f(i / num_levels, i % num_levels) = 0;
+                               });
+          team.team_barrier();
+          accumulate_process_rates(team, time, y, f, col,
+                                   std::make_index_sequence<num_processes>());
+          return;
+        }
+      }
+      Kokkos::parallel_for(Kokkos::TeamThreadRange(team, num_values),
+                           [&](const int i) {
+                             const int q = i / num_levels, k = i % num_levels;
+                             for (int p = 0; p < num_processes; ++p) {
+                               buffers(p, q, col, k) = 0;
+                             }
+                           });
+      team.team_barrier();
+      compute_process_rates(team, time, y, col,
+                            std::make_index_sequence<num_processes>());
+      team.team_barrier();
+      Kokkos::parallel_for(Kokkos::TeamThreadRange(team, num_values),
+                           [&](const int i) {
+                             const int q = i / num_levels, k = i % num_levels;
+                             Real sum = 0;
+                             for (int p = 0; p < num_processes; ++p) {
+                               sum += buffers(p, q, col, k);
+                             }
+                             f(q, k) = sum;
+                           });
+      team.team_barrier();
+    }
+
+    template <typename Prognostics, std::size_t... P>
+    KOKKOS_INLINE_FUNCTION void
+    compute_process_rates(const ThreadTeam &team, Real time,
+                          const Prognostics &y, int col,
+                          std::index_sequence<P...>) const {
+      (std::get<P>(processes)
+           .compute_tendencies(
+               team, time, dt, state.atmosphere(col), state.surface(col), y,
+               state.diagnostics(col),
+               state.tendencies(Kokkos::subview(buffers, P, Kokkos::ALL,
+                                                Kokkos::ALL, Kokkos::ALL),
+                                col)),
+       ...);
+    }
+
+    template <typename Prognostics, std::size_t... P>
+    KOKKOS_INLINE_FUNCTION void
+    accumulate_process_rates(const ThreadTeam &team, Real time,
+                             const Prognostics &y, const Prognostics &f,
+                             int col, std::index_sequence<P...>) const {
+      ((std::get<P>(processes)
+            .accumulate_tendencies(team, time, dt, state.atmosphere(col),
+                                   state.surface(col), y,
+                                   state.diagnostics(col), 1, f),
+        team.team_barrier()),
+       ...);
+    }
+
+    // computes the Jacobian of the summed tendencies at the state y
+    template <typename Prognostics>
+    KOKKOS_INLINE_FUNCTION void compute_jacobian(const ThreadTeam &team,
+                                                 const Prognostics &y,
+                                                 int col) const {
+      const ColumnJacobianView J(Kokkos::subview(
+          jacobians, col, Kokkos::ALL, Kokkos::ALL, Kokkos::ALL));
+      const int n = J.extent(0) * J.extent(1) * J.extent(2);
+      Kokkos::parallel_for(Kokkos::TeamThreadRange(team, n),
+                           [&](const int i) { J.data()[i] = 0; });
+      team.team_barrier();
+      add_process_jacobians(team, y, col,
+                            std::make_index_sequence<num_processes>());
+    }
+
+    template <typename Prognostics, std::size_t... P>
+    KOKKOS_INLINE_FUNCTION void
+    add_process_jacobians(const ThreadTeam &team, const Prognostics &y,
+                          int col, std::index_sequence<P...>) const {
+      (add_process_jacobian(team, std::get<P>(processes), y, col), ...);
+    }
+
+    template <typename Process, typename Prognostics>
+    KOKKOS_INLINE_FUNCTION void
+    add_process_jacobian(const ThreadTeam &team, const Process &process,
+                         const Prognostics &y, int col) const {
+      const ColumnJacobianView J(Kokkos::subview(
+          jacobians, col, Kokkos::ALL, Kokkos::ALL, Kokkos::ALL));
+      const ColumnJacobianView Jp(Kokkos::subview(
+          process_jacobians, col, Kokkos::ALL, Kokkos::ALL, Kokkos::ALL));
+      const typename Process::Workspace workspace{
+          state.tendencies(fd_state, col), state.tendencies(fd_tendencies, col),
+          state.tendencies(fd_perturbed_tendencies, col)};
+      process.compute_jacobian(team, t, dt, state.atmosphere(col),
+                               state.surface(col), y, state.diagnostics(col),
+                               workspace, Jp);
+      team.team_barrier();
+      const int n = J.extent(0) * J.extent(1) * J.extent(2);
+      Kokkos::parallel_for(Kokkos::TeamThreadRange(team, n),
+                           [&](const int i) { J.data()[i] += Jp.data()[i]; });
+      team.team_barrier();
+    }
+
+    // sets A = I - scale * J on each level, padding unused levels in the last
+    // pack with the identity
+    KOKKOS_INLINE_FUNCTION
+    void form_matrices(const ThreadTeam &team, int col, Real scale,
+                       const LevelMatricesView &A) const {
+      const int num_tracers = A.extent(0), num_levels = jacobians.extent(1);
+      Kokkos::parallel_for(
+          Kokkos::TeamThreadRange(team, A.extent(2)), [&](const int p) {
+            for (int i = 0; i < num_tracers; ++i) {
+              for (int j = 0; j < num_tracers; ++j) {
+                for (int s = 0; s < PackType::n; ++s) {
+                  const int k = p * PackType::n + s;
+                  const Real identity = (i == j) ? 1 : 0;
+                  A(i, j, p)[s] =
+                      (k < num_levels)
+                          ? identity - scale * jacobians(col, k, i, j)
+                          : identity;
+                }
+              }
+            }
+          });
+    }
+
+    // sets b = x + c * z on each level, padding unused levels with zeros
+    template <typename Prognostics>
+    KOKKOS_INLINE_FUNCTION void load_rhs(const ThreadTeam &team,
+                                         const Prognostics &x,
+                                         const Prognostics &z, Real c,
+                                         const LevelVectorsView &b) const {
+      const int num_tracers = b.extent(0), num_levels = rates.extent(2);
+      Kokkos::parallel_for(
+          Kokkos::TeamThreadRange(team, b.extent(1)), [&](const int p) {
+            for (int i = 0; i < num_tracers; ++i) {
+              for (int s = 0; s < PackType::n; ++s) {
+                const int k = p * PackType::n + s;
+                b(i, p)[s] = (k < num_levels) ? x(i, k) + c * z(i, k) : 0;
+              }
+            }
+          });
+      team.team_barrier();
+    }
+
+    // copies the solution b into x
+    template <typename Prognostics>
+    KOKKOS_INLINE_FUNCTION void store_solution(const ThreadTeam &team,
+                                               const LevelVectorsView &b,
+                                               const Prognostics &x) const {
+      const int num_tracers = b.extent(0), num_levels = rates.extent(2);
+      Kokkos::parallel_for(
+          Kokkos::TeamThreadRange(team, num_tracers * num_levels),
+          [&](const int i) {
+            const int q = i / num_levels, k = i % num_levels;
+            x(q, k) = b(q, k / PackType::n)[k % PackType::n];
+          });
+    }
+  };
+
+  // Step times passed to kernels by value.
+  struct StepTimes {
+    Real t, dt;
+
+    KOKKOS_INLINE_FUNCTION Real time() const { return t; }
+    KOKKOS_INLINE_FUNCTION Real step() const { return dt; }
+  };
+
+  // Step times read from device memory when kernels run, so that a recorded
+  // step can be replayed with new times.
+  struct RecordedTimes {
+    DeviceType::view_1d<Real> values;
+
+    KOKKOS_INLINE_FUNCTION Real time() const { return values(0); }
+    KOKKOS_INLINE_FUNCTION Real step() const { return values(1); }
+  };
+
+  using GraphNode = Kokkos::Experimental::GraphNodeRef<ExecutionSpace>;
+
+  // Launches kernels immediately on an execution space instance.
+  struct EagerLauncher {
+    ExecutionSpace instance;
+
+    template <typename Kernel>
+    EagerLauncher then(const std::string &name, int num_columns,
+                       const Kernel &kernel) const {
+      Kokkos::parallel_for(
+          name, ThreadTeamPolicy(instance, num_columns, Kokkos::AUTO), kernel);
+      return *this;
+    }
+  };
+
+  // Records kernels in a graph, each depending on the one before it.
+  struct GraphLauncher {
+    GraphNode node;
+
+    template <typename Kernel>
+    GraphLauncher then(const std::string &name, int num_columns,
+                       const Kernel &kernel) const {
+      return GraphLauncher{node.then_parallel_for(
+          name, ThreadTeamPolicy(num_columns, Kokkos::AUTO), kernel)};
+    }
+  };
+
+  // Returns a launcher from which the processes can branch. In the
+  // concurrent dispatch mode, the processes' instances don't follow the
+  // launcher's (default) instance, so this waits for the kernels and copies
+  // already issued there, by the group or by the caller.
+  EagerLauncher fork(const EagerLauncher &launcher) const {
+    if (dispatch_ == ProcessDispatch::concurrent) {
+      launcher.instance.fence("haero::ProcessGroup::fork");
+    }
+    return launcher;
+  }
+
+  GraphLauncher fork(const GraphLauncher &launcher) const { return launcher; }
+
+  // Returns the launcher for process p: eager launches go to the process's
+  // own execution space instance in the concurrent dispatch mode.
+  EagerLauncher branch(const EagerLauncher &launcher, int p) const {
+    if (dispatch_ == ProcessDispatch::concurrent) {
+      ++num_concurrent_launches_;
+      return EagerLauncher{instances_[p]};
+    }
+    return launcher;
+  }
+
+  GraphLauncher branch(const GraphLauncher &launcher, int p) const {
+    return launcher;
+  }
+
+  // Returns a launcher whose kernels follow those of all the given branches.
+  template <typename... Branches>
+  EagerLauncher join(const EagerLauncher &launcher,
+                     const Branches &...branches) const {
+    if (dispatch_ == ProcessDispatch::concurrent) {
+      for (const auto &instance : instances_) {
+        instance.fence();
+      }
+    }
+    return launcher;
+  }
+
+  template <typename... Branches>
+  GraphLauncher join(const GraphLauncher &launcher,
+                     const Branches &...branches) const {
+    return GraphLauncher{Kokkos::Experimental::when_all(branches.node...)};
+  }
+
+  // Returns true if the given integrator solves for an implicit step, whose
+  // kernels aren't tiled over levels.
+  static bool is_implicit(ProcessIntegrator integrator) {
+    return (integrator == ProcessIntegrator::backward_euler) ||
+           (integrator == ProcessIntegrator::rosenbrock);
+  }
+
+  // Allocates the workspace for the group's integrator if needed.
+  void prepare_integrator() {
+    if ((integrator_ != ProcessIntegrator::split) && (rates_.extent(0) == 0)) {
+      set_integrator(integrator_);
+    }
+  }
+
+  // Enqueues the kernels that compute the summed tendencies of all processes.
+  template <typename Times, typename Levels, typename ColumnState,
+            typename Launcher>
+  Launcher enqueue_tendencies(const Times &times, const Levels &levels,
+                              const ColumnState &state,
+                              const TracersView &tendencies,
+                              const Launcher &launcher) const {
+    if constexpr (accumulates_tendencies) {
+      if (tendency_mode_ == TendencyMode::accumulate) {
+        return accumulate_fused<false>(
+            "haero::ProcessGroup::accumulate_tendencies", times, levels,
+            state, tendencies, launcher,
+            std::make_index_sequence<num_processes>());
+      }
+    }
+    return sum_tendencies(
+        levels, tendencies,
+        launch_all(times, levels, state, launcher,
+                   std::make_index_sequence<num_processes>()));
+  }
+
+  // Enqueues the kernels that advance the prognostics over one step.
+  template <typename Times, typename Levels, typename ColumnState,
+            typename Launcher>
+  Launcher enqueue_step(const Times &times, const Levels &levels,
+                        const ColumnState &state,
+                        const Launcher &launcher) const {
+    if (integrator_ == ProcessIntegrator::split) {
+      if constexpr (accumulates_tendencies) {
+        return accumulate_fused<true>(
+            "haero::ProcessGroup::split", times, levels, state, TracersView(),
+            launcher, std::make_index_sequence<num_processes>());
+      }
+    }
+    if (integrator_ == ProcessIntegrator::forward_euler) {
+      const auto rates = rates_;
+      const int num_tracers = num_tracers_;
+      return enqueue_tendencies(times, levels, state, rates, launcher)
+          .then(
+              "haero::ProcessGroup::forward_euler", num_columns_,
+              KOKKOS_LAMBDA(const ThreadTeam &team) {
+                const int col = team.league_rank();
+                const Real dt = times.step();
+                const int num_levels = levels.num_levels();
+                const int num_values = num_tracers * num_levels;
+                const auto prognostics = state.prognostics(col);
+                Kokkos::parallel_for(
+                    Kokkos::TeamThreadRange(team, num_values),
+                    [&](const int i) {
+                      const int q = i / num_levels, k = i % num_levels;
+                      prognostics(q, k) += dt * rates(q, col, k);
+                    });
+              });
+    }
+    const ImplicitStep<ColumnState> step{processes_,
+                                         state,
+                                         integrator_,
+                                         tendency_mode_,
+                                         0,
+                                         0,
+                                         max_newton_iterations_,
+                                         newton_rel_tolerance_,
+                                         newton_abs_tolerance_,
+                                         buffers_,
+                                         rates_,
+                                         stage_,
+                                         increments_,
+                                         fd_state_,
+                                         fd_tendencies_,
+                                         fd_perturbed_tendencies_,
+                                         jacobians_,
+                                         process_jacobians_,
+                                         matrices_,
+                                         rhs_};
+    return launcher.then((integrator_ == ProcessIntegrator::rosenbrock)
+                             ? "haero::ProcessGroup::rosenbrock"
+                             : "haero::ProcessGroup::backward_euler",
+                         num_columns_, KOKKOS_LAMBDA(const ThreadTeam &team) {
+                           auto timed_step = step;
+                           timed_step.t = times.time();
+                           timed_step.dt = times.step();
+                           timed_step(team);
+                         });
+  }
+
+  // Launches each process on its own branch, joining the branches.
+  template <typename Times, typename Levels, typename ColumnState,
+            typename Launcher, std::size_t... P>
+  Launcher launch_all(const Times &times, const Levels &levels,
+                      const ColumnState &state, const Launcher &launcher,
+                      std::index_sequence<P...>) const {
+    const Launcher root = fork(launcher);
+    return join(root, launch<P>(times, levels, state, branch(root, P))...);
+  }
+
+  // Launches the process with index P, which writes its tendencies to buffer
+  // P.
+  template <std::size_t P, typename Times, typename Levels,
+            typename ColumnState, typename Launcher>
+  Launcher launch(const Times &times, const Levels &levels,
+                  const ColumnState &state, const Launcher &launcher) const {
+    const auto &process = std::get<P>(processes_);
+    const TracersView buffer =
+        Kokkos::subview(buffers_, P, Kokkos::ALL, Kokkos::ALL, Kokkos::ALL);
+    const int num_tracers = num_tracers_;
+    const auto kernel = KOKKOS_LAMBDA(const ThreadTeam &team) {
+      const int col = team.league_rank();
+      const int num_levels = levels.num_levels();
+      const int num_values = num_tracers * num_levels;
+      // clear this column's tendencies, since a process need not set every
+      // tendency
+      Kokkos::parallel_for(Kokkos::TeamThreadRange(team, num_values),
+                           [&](const int i) {
+                             buffer(i / num_levels, col, i % num_levels) = 0;
+                           });
+      team.team_barrier();
+      process.compute_tendencies(team, levels, times.time(), times.step(),
+                                 state.atmosphere(col), state.surface(col),
+                                 state.prognostics(col),
+                                 state.diagnostics(col),
+                                 state.tendencies(buffer, col));
+    };
+    static_assert(sizeof(kernel) <= max_kernel_closure_size,
+                  "ProcessGroup: kernel closure is too large!");
+    return launcher.then("haero::ProcessGroup::" + process.name(),
+                         num_columns_, kernel);
+  }
+
+  // Runs every process in one kernel, accumulating their tendencies into the
+  // given tendencies, or (if Apply is true) adding dt * tendencies to the
+  // prognostics, one process after another. If the group is tiled, each team
+  // runs every process on one tile of levels before moving to the next.
+  template <bool Apply, typename Times, typename Levels, typename ColumnState,
+            typename Launcher, std::size_t... P>
+  Launcher accumulate_fused(const std::string &name, const Times &times,
+                            const Levels &levels, const ColumnState &state,
+                            const TracersView &tendencies,
+                            const Launcher &launcher,
+                            std::index_sequence<P...> order) const {
+    const auto processes = processes_;
+    const int tile_size = level_tile_size_;
+    if constexpr (vertically_local && HasLevelTiles<ColumnState>::value) {
+      if (tile_size > 0) {
+        const auto kernel = KOKKOS_LAMBDA(const ThreadTeam &team) {
+          const int col = team.league_rank();
+          const int num_levels = levels.num_levels();
+          for (int first = 0; first < num_levels; first += tile_size) {
+            const int n = (first + tile_size < num_levels) ? tile_size
+                                                           : num_levels - first;
+            accumulate_column<Apply>(team, processes, times, col, first, n,
+                                     state.level_tile(first, n), tendencies,
+                                     order);
+          }
+        };
+        static_assert(sizeof(kernel) <= max_kernel_closure_size,
+                      "ProcessGroup: kernel closure is too large!");
+        return launcher.then(name, num_columns_, kernel);
+      }
+    }
+    EKAT_REQUIRE_MSG(tile_size == 0,
+                     "ProcessGroup: level tiling requires a ColumnState with "
+                     "a level_tile method!");
+    const auto kernel = KOKKOS_LAMBDA(const ThreadTeam &team) {
+      accumulate_column<Apply>(team, processes, times, team.league_rank(), 0,
+                               levels.num_levels(), state, tendencies, order);
+    };
+    static_assert(sizeof(kernel) <= max_kernel_closure_size,
+                  "ProcessGroup: kernel closure is too large!");
+    return launcher.then(name, num_columns_, kernel);
+  }
+
+  // Runs every process on the given column of the given state, which holds
+  // the given number of levels starting at first_level (see
+  // accumulate_fused).
+  template <bool Apply, typename Times, typename ColumnState, std::size_t... P>
+  KOKKOS_INLINE_FUNCTION static void
+  accumulate_column(const ThreadTeam &team, const Processes &processes,
+                    const Times &times, const int col, const int first_level,
+                    const int num_levels, const ColumnState &state,
+                    const TracersView &tendencies, std::index_sequence<P...>) {
+    const Real t = times.time(), dt = times.step();
+    const auto target = [&]() {
+      if constexpr (Apply) {
+        return state.prognostics(col);
+      } else {
+        // clear these tendencies, since processes add to them
+        const int num_values = tendencies.extent(0) * num_levels;
+        Kokkos::parallel_for(Kokkos::TeamThreadRange(team, num_values),
+                             [&](const int i) {
+                               tendencies(i / num_levels, col,
+                                          first_level + i % num_levels) = 0;
+                             });
+        team.team_barrier();
+        return state.tendencies(tendencies, col);
+      }
+    }();
+    const Real scale = Apply ? dt : 1;
+    ((std::get<P>(processes)
+          .accumulate_tendencies(team, t, dt, state.atmosphere(col),
+                                 state.surface(col), state.prognostics(col),
+                                 state.diagnostics(col), scale, target),
+      team.team_barrier()),
+     ...);
+  }
+
+  // Sums the tendencies in the process buffers.
+  template <typename Levels, typename Launcher>
+  Launcher sum_tendencies(const Levels &levels, const TracersView &tendencies,
+                          const Launcher &launcher) const {
+    const auto buffers = buffers_;
+    const int num_tracers = num_tracers_;
+    return launcher.then(
+        "haero::ProcessGroup::sum_tendencies", num_columns_,
+        KOKKOS_LAMBDA(const ThreadTeam &team) {
+          const int col = team.league_rank();
+          const int num_levels = levels.num_levels();
+          const int num_values = num_tracers * num_levels;
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team, num_values), [&](const int i) {
+                const int q = i / num_levels, k = i % num_levels;
+                Real sum = 0;
+                for (int p = 0; p < num_processes; ++p) {
+                  sum += buffers(p, q, col, k);
+                }
+                tendencies(q, col, k) = sum;
+              });
+        });
+  }
+
+  Processes processes_;
+  // keeps the metadata of the group's processes registered
+  ProcessReferences references_;
+  int num_tracers_, num_columns_, num_levels_;
+  // the level count for which kernels are instantiated
+  AnyLevelCount levels_;
+  TendencyMode tendency_mode_;
+  // the number of levels in a tile of a tiled kernel (0 if not tiled)
+  int level_tile_size_;
+  // per-process tendency buffers, indexed by (process, tracer, column, level)
+  // (empty in accumulate mode)
+  DeviceType::view<Real ****> buffers_;
+  ProcessDispatch dispatch_;
+  std::vector<ExecutionSpace> instances_;
+  // the number of process kernels launched on instances_
+  mutable long num_concurrent_launches_;
+  ProcessIntegrator integrator_;
+  int max_newton_iterations_;
+  Real newton_rel_tolerance_;
+  Real newton_abs_tolerance_;
+  // summed tendencies, and workspace for the implicit integrators, indexed
+  // like the tracers
+  TracersView rates_, stage_, increments_;
+  TracersView fd_state_, fd_tendencies_, fd_perturbed_tendencies_;
+  // Jacobians, indexed by (column, level, tendency, prognostic)
+  DeviceType::view<Real ****> jacobians_, process_jacobians_;
+  // factored matrices and right-hand sides for each column
+  DeviceType::view<PackType ****> matrices_;
+  DeviceType::view<PackType ***> rhs_;
+  // the recorded step, and the step times it reads
+  std::optional<Kokkos::Experimental::Graph<ExecutionSpace>> step_graph_;
+  DeviceType::view_1d<Real> step_times_;
+  DeviceType::view_1d<Real>::HostMirror h_step_times_;
+  // registers the group's workspace with Haero's memory registry
+  memory::ViewTracker tracker_;
+};
+
+} // namespace haero
+
+#endif
@@ -0,0 +1,398 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_PROCESS_REGISTRY_HPP
+#define HAERO_PROCESS_REGISTRY_HPP
+
+#include <haero/aero_process.hpp>
+
+#include <ekat/ekat_assert.hpp>
+
+#include <algorithm>
+#include <new>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace haero {
+
+/// @class ProcessVariant
+/// This type holds one aerosol process whose implementation is any of a list
+/// of implementations fixed at compile time. It is a tagged union: the
+/// process is stored in place, and calls are dispatched by comparing the tag
+/// with each implementation's index, so there are no virtual calls or
+/// function pointers, and a ProcessVariant can be copied to and used on the
+/// device.
+template <typename AerosolConfig, typename... ProcessImpls>
+class ProcessVariant final {
+  template <int I>
+  using Impl = std::tuple_element_t<I, std::tuple<ProcessImpls...>>;
+
+public:
+  using AeroConfig = AerosolConfig;
+  using Prognostics = typename AerosolConfig::Prognostics;
+  using Diagnostics = typename AerosolConfig::Diagnostics;
+  using Tendencies = typename AerosolConfig::Tendencies;
+
+  /// The type of the process with the given implementation index.
+  template <int I> using Process = AeroProcess<AerosolConfig, Impl<I>>;
+
+  /// number of implementations a ProcessVariant can hold
+  static constexpr int num_impls = sizeof...(ProcessImpls);
+
+  static_assert(num_impls > 0,
+                "A ProcessVariant needs at least 1 implementation!");
+
+  /// Returns the index of the given implementation in the list of
+  /// implementations.
+  template <typename ProcessImpl> static constexpr int index_of() {
+    constexpr bool matches[] = {
+        std::is_same<ProcessImpl, ProcessImpls>::value...};
+    for (int i = 0; i < num_impls; ++i) {
+      if (matches[i]) {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  /// Constructs an empty ProcessVariant, which holds no process.
+  KOKKOS_INLINE_FUNCTION
+  ProcessVariant() : index_(-1) {}
+
+  /// Constructs a ProcessVariant holding a copy of the given process. Like
+  /// any copy of a process, the ProcessVariant holds no reference to the
+  /// process's metadata (see ProcessReferences).
+  template <typename ProcessImpl>
+  KOKKOS_INLINE_FUNCTION
+  ProcessVariant(const AeroProcess<AerosolConfig, ProcessImpl> &process)
+      : index_(index_of<ProcessImpl>()) {
+    static_assert(index_of<ProcessImpl>() >= 0,
+                  "ProcessImpl is not one of the implementations of this "
+                  "ProcessVariant!");
+    new (storage_) AeroProcess<AerosolConfig, ProcessImpl>(process);
+  }
+
+  /// Constructs a ProcessVariant holding the given process, taking over its
+  /// reference to its metadata (if any).
+  template <typename ProcessImpl>
+  KOKKOS_INLINE_FUNCTION
+  ProcessVariant(AeroProcess<AerosolConfig, ProcessImpl> &&process)
+      : index_(index_of<ProcessImpl>()) {
+    static_assert(index_of<ProcessImpl>() >= 0,
+                  "ProcessImpl is not one of the implementations of this "
+                  "ProcessVariant!");
+    new (storage_) AeroProcess<AerosolConfig, ProcessImpl>(std::move(process));
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  ProcessVariant(const ProcessVariant &other) : index_(-1) { copy(other); }
+
+  KOKKOS_INLINE_FUNCTION
+  ProcessVariant(ProcessVariant &&other) noexcept : index_(-1) {
+    move(other);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  ProcessVariant &operator=(const ProcessVariant &other) {
+    if (this != &other) {
+      destroy();
+      copy(other);
+    }
+    return *this;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  ProcessVariant &operator=(ProcessVariant &&other) noexcept {
+    if (this != &other) {
+      destroy();
+      move(other);
+    }
+    return *this;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  ~ProcessVariant() { destroy(); }
+
+  /// On host or device: returns the index of the implementation of the
+  /// process held, or -1 if the ProcessVariant is empty.
+  KOKKOS_INLINE_FUNCTION
+  int index() const { return index_; }
+
+  /// On host or device: returns true if the ProcessVariant holds no process.
+  KOKKOS_INLINE_FUNCTION
+  bool empty() const { return (index_ < 0); }
+
+  /// On host or device: calls the given function with the process held
+  /// (of type Process<index()>). Nothing is done if the ProcessVariant is
+  /// empty.
+  template <typename F> KOKKOS_INLINE_FUNCTION void visit(F &&f) const {
+    dispatch<0>(f);
+  }
+
+  /// On host: returns the name of the process held.
+  std::string name() const {
+    std::string name;
+    visit([&](const auto &process) { name = process.name(); });
+    return name;
+  }
+
+  /// On host or device: validates data with the process held (see
+  /// AeroProcess::validate).
+  KOKKOS_INLINE_FUNCTION
+  bool validate(const ThreadTeam &team, const Atmosphere &atmosphere,
+                const Surface &surface, const Prognostics &prognostics) const {
+    bool valid = false;
+    visit([&](const auto &process) {
+      valid = process.validate(team, atmosphere, surface, prognostics);
+    });
+    return valid;
+  }
+
+  /// On host or device: computes tendencies with the process held (see
+  /// AeroProcess::compute_tendencies).
+  KOKKOS_INLINE_FUNCTION
+  void compute_tendencies(const ThreadTeam &team, Real t, Real dt,
+                          const Atmosphere &atmosphere, const Surface &surface,
+                          const Prognostics &prognostics,
+                          const Diagnostics &diagnostics,
+                          const Tendencies &tendencies) const {
+    visit([&](const auto &process) {
+      process.compute_tendencies(team, t, dt, atmosphere, surface,
+                                 prognostics, diagnostics, tendencies);
+    });
+  }
+
+private:
+  // calls f with the process held if it has index I or greater
+  template <int I, typename F>
+  KOKKOS_INLINE_FUNCTION void dispatch(F &f) const {
+    if constexpr (I < num_impls) {
+      if (index_ == I) {
+        f(*reinterpret_cast<const Process<I> *>(storage_));
+      } else {
+        dispatch<I + 1>(f);
+      }
+    }
+  }
+
+  // copies the process held by other into this (empty) ProcessVariant
+  KOKKOS_INLINE_FUNCTION
+  void copy(const ProcessVariant &other) {
+    other.visit([&](const auto &process) {
+      using P = std::decay_t<decltype(process)>;
+      new (storage_) P(process);
+    });
+    index_ = other.index_;
+  }
+
+  // moves the process held by other into this (empty) ProcessVariant
+  KOKKOS_INLINE_FUNCTION
+  void move(ProcessVariant &other) {
+    other.visit([&](const auto &process) {
+      using P = std::decay_t<decltype(process)>;
+      new (storage_) P(std::move(const_cast<P &>(process)));
+    });
+    index_ = other.index_;
+  }
+
+  // destroys the process held, leaving this ProcessVariant empty
+  KOKKOS_INLINE_FUNCTION
+  void destroy() {
+    visit([&](const auto &process) {
+      using P = std::decay_t<decltype(process)>;
+      const_cast<P &>(process).~P();
+    });
+    index_ = -1;
+  }
+
+  int index_;
+  alignas(AeroProcess<AerosolConfig, ProcessImpls>...) unsigned char
+      storage_[std::max({sizeof(AeroProcess<AerosolConfig, ProcessImpls>)...})];
+};
+
+/// @class ProcessLaunchPlan
+/// This type runs a sequence of processes, selected at runtime, in a single
+/// kernel that loops over the processes within each column and sums their
+/// tendencies. The processes are copied to the device once, when the plan is
+/// created by a ProcessRegistry. Column data is provided by a ColumnState (see
+/// ProcessGroup).
+template <typename AerosolConfig, typename... ProcessImpls>
+class ProcessLaunchPlan final {
+public:
+  using Variant = ProcessVariant<AerosolConfig, ProcessImpls...>;
+
+  /// Creates a plan that runs the given processes on tracer data with the
+  /// given dimensions.
+  ProcessLaunchPlan(const std::vector<Variant> &processes, int num_tracers,
+                    int num_columns, int num_levels)
+      : processes_("haero::ProcessLaunchPlan::processes", processes.size()),
+        names_(processes.size()),
+        buffer_(Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                                   "haero::ProcessLaunchPlan::buffer"),
+                num_tracers, num_columns, num_levels) {
+    auto h_processes = Kokkos::create_mirror_view(processes_);
+    for (size_t p = 0; p < processes.size(); ++p) {
+      EKAT_REQUIRE_MSG(!processes[p].empty(),
+                       "ProcessLaunchPlan: process " << p << " is empty!");
+      h_processes(p) = processes[p];
+      processes[p].visit(
+          [&](const auto &process) { references_.add(process.id()); });
+      names_[p] = processes[p].name();
+    }
+    Kokkos::deep_copy(processes_, h_processes);
+  }
+
+  /// On host: returns the number of processes in the plan.
+  int num_processes() const { return processes_.extent(0); }
+
+  /// On host: returns the names of the processes in the plan, in order.
+  const std::vector<std::string> &names() const { return names_; }
+
+  /// On host: runs every process in the plan to compute tendencies at time t
+  /// over the step dt, storing their sum in the given tendencies.
+  /// @param [in] t The simulation time [s]
+  /// @param [in] dt The simulation time step [s]
+  /// @param [in] state The ColumnState that provides data for each column
+  /// @param [out] tendencies The summed tendencies, indexed by (tracer,
+  ///                         column, level)
+  template <typename ColumnState>
+  void compute_tendencies(Real t, Real dt, const ColumnState &state,
+                          const TracersView &tendencies) const {
+    EKAT_REQUIRE_MSG((tendencies.extent(0) == buffer_.extent(0)) &&
+                         (tendencies.extent(1) == buffer_.extent(1)) &&
+                         (tendencies.extent(2) == buffer_.extent(2)),
+                     "ProcessLaunchPlan: tendencies have the wrong "
+                     "dimensions!");
+    const auto processes = processes_;
+    const auto buffer = buffer_;
+    const int num_processes = processes.extent(0);
+    const int num_levels = buffer.extent(2);
+    const int num_values = buffer.extent(0) * num_levels;
+    const auto kernel = KOKKOS_LAMBDA(const ThreadTeam &team) {
+      const int col = team.league_rank();
+      Kokkos::parallel_for(Kokkos::TeamThreadRange(team, num_values),
+                           [&](const int i) {
+                             tendencies(i / num_levels, col, i % num_levels) =
+                                 0;
+                           });
+      for (int p = 0; p < num_processes; ++p) {
+        // a process need not set every tendency
+        Kokkos::parallel_for(Kokkos::TeamThreadRange(team, num_values),
+                             [&](const int i) {
+                               buffer(i / num_levels, col, i % num_levels) = 0;
+                             });
+        team.team_barrier();
+        processes(p).compute_tendencies(
+            team, t, dt, state.atmosphere(col), state.surface(col),
+            state.prognostics(col), state.diagnostics(col),
+            state.tendencies(buffer, col));
+        team.team_barrier();
+        Kokkos::parallel_for(Kokkos::TeamThreadRange(team, num_values),
+                             [&](const int i) {
+                               const int q = i / num_levels,
+                                         k = i % num_levels;
+                               tendencies(q, col, k) += buffer(q, col, k);
+                             });
+        team.team_barrier();
+      }
+    };
+    static_assert(sizeof(kernel) <= max_kernel_closure_size,
+                  "ProcessLaunchPlan: kernel closure is too large!");
+    Kokkos::parallel_for("haero::ProcessLaunchPlan::compute_tendencies",
+                         ThreadTeamPolicy(buffer.extent(1), Kokkos::AUTO),
+                         kernel);
+  }
+
+private:
+  DeviceType::view_1d<Variant> processes_;
+  // keeps the metadata of the plan's processes registered
+  ProcessReferences references_;
+  std::vector<std::string> names_;
+  // tendencies of the process being run
+  TracersView buffer_;
+};
+
+/// @class ProcessRegistry
+/// This type lets a host model select and configure aerosol processes at
+/// runtime (e.g. from a YAML file) from a list of implementations fixed at
+/// compile time, without instantiating each combination of processes. The
+/// registry creates processes by name as ProcessVariants, and assembles them
+/// into a ProcessLaunchPlan.
+template <typename AerosolConfig, typename... ProcessImpls>
+class ProcessRegistry final {
+public:
+  using Variant = ProcessVariant<AerosolConfig, ProcessImpls...>;
+  using LaunchPlan = ProcessLaunchPlan<AerosolConfig, ProcessImpls...>;
+
+  /// Creates a registry of processes for the given aerosol configuration.
+  explicit ProcessRegistry(const AerosolConfig &aero_config)
+      : aero_config_(aero_config), names_{ProcessImpls().name()...} {
+    for (size_t i = 0; i < names_.size(); ++i) {
+      for (size_t j = 0; j < i; ++j) {
+        EKAT_REQUIRE_MSG(names_[i] != names_[j],
+                         "ProcessRegistry: duplicate process name: "
+                             << names_[i]);
+      }
+    }
+  }
+
+  /// On host: returns the names of the registered implementations.
+  const std::vector<std::string> &names() const { return names_; }
+
+  /// On host: returns true if an implementation with the given name is
+  /// registered, false if not.
+  bool has(const std::string &name) const {
+    return (std::find(names_.begin(), names_.end(), name) != names_.end());
+  }
+
+  /// On host: creates a process with the implementation of the given name
+  /// and its default configuration.
+  Variant create(const std::string &name) const {
+    const auto iter = std::find(names_.begin(), names_.end(), name);
+    EKAT_REQUIRE_MSG(iter != names_.end(),
+                     "ProcessRegistry: unknown process: " << name);
+    return create_default<0>(iter - names_.begin());
+  }
+
+  /// On host: creates a process with the given implementation and
+  /// configuration.
+  template <typename ProcessImpl>
+  Variant create(const typename ProcessImpl::Config &config) const {
+    return Variant(AeroProcess<AerosolConfig, ProcessImpl>(aero_config_,
+                                                           config));
+  }
+
+  /// On host: creates a plan that runs the processes with the given names
+  /// (with default configurations), in order.
+  LaunchPlan plan(const std::vector<std::string> &names, int num_tracers,
+                  int num_columns, int num_levels) const {
+    std::vector<Variant> processes;
+    for (const auto &name : names) {
+      processes.push_back(create(name));
+    }
+    return LaunchPlan(processes, num_tracers, num_columns, num_levels);
+  }
+
+private:
+  template <int I> Variant create_default(int index) const {
+    if constexpr (I < Variant::num_impls) {
+      if (index == I) {
+        return Variant(typename Variant::template Process<I>(aero_config_));
+      }
+      return create_default<I + 1>(index);
+    } else {
+      return Variant();
+    }
+  }
+
+  AerosolConfig aero_config_;
+  std::vector<std::string> names_;
+};
+
+} // namespace haero
+
+#endif
@@ -0,0 +1,289 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_PROCESS_VALIDATION_HPP
+#define HAERO_PROCESS_VALIDATION_HPP
+
+#include <haero/aero_process.hpp>
+
+#include <ekat/ekat_assert.hpp>
+
+#include <algorithm>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+namespace haero {
+
+/// @struct ValidationSampling
+/// This type selects the steps and columns checked by a ProcessValidator.
+/// Validating a fraction 1 / (step_interval * column_stride) of the
+/// column-steps keeps checking cheap enough to leave on in production runs.
+struct ValidationSampling {
+  /// validate on every step_interval-th step (1 = every step)
+  int step_interval = 1;
+  /// validate every column_stride-th column on a validated step, with an
+  /// offset that rotates from one validated step to the next, so that every
+  /// column is checked over column_stride validated steps (1 = every column)
+  int column_stride = 1;
+  /// the number of failures recorded in detail (further failures are counted
+  /// but not recorded)
+  int max_failures = 64;
+};
+
+/// @struct ValidationFailure
+/// This type records a failed validation check.
+struct ValidationFailure {
+  /// the step on which the check failed
+  int step;
+  /// the index of the process that rejected the column, or -1 if the column
+  /// contains a non-finite tracer value
+  int process;
+  /// the index of the column
+  int column;
+  /// the tracer and level of the first non-finite value in the column, or
+  /// of the first value rejected by the process (-1 if the process doesn't
+  /// identify them; see AeroProcess::validate)
+  int tracer, level;
+};
+
+/// @class ProcessValidator
+/// This type runs validation checks for a set of processes on a sample of
+/// the steps and columns of a simulation (see ValidationSampling). For each
+/// sampled column, it checks that the prognostic variables are finite and
+/// calls the validate method of each process. Failures are recorded on the
+/// device with their step and column, and the checks never abort a kernel:
+/// the host inspects the failures when it chooses (see failures).
+///
+/// Checks can run on a separate execution space instance (see
+/// set_execution_space), in which case they run concurrently with other
+/// work and the host only waits for them when it asks for failures. Such an
+/// instance doesn't follow the instance that produces the prognostics, so
+/// validate first fences the producing instance alone, which may still be
+/// writing them. Because the checks then read the prognostics
+/// asynchronously, the prognostics must not be modified until the checking
+/// instance is fenced (e.g. run the checks alongside
+/// ProcessGroup::compute_tendencies, not alongside advance).
+///
+/// Column data is provided by a ColumnState (see ProcessGroup), whose
+/// Prognostics type must provide `num_tracers()`, `num_levels()` and element
+/// access `(tracer, level)`.
+template <typename AerosolConfig, typename... ProcessImpls>
+class ProcessValidator final {
+public:
+  using Processes = std::tuple<AeroProcess<AerosolConfig, ProcessImpls>...>;
+
+  /// number of processes validated
+  static constexpr int num_processes = sizeof...(ProcessImpls);
+
+  /// Constructs a validator for the given processes acting on the given
+  /// number of columns.
+  /// @param [in] num_columns The number of columns
+  /// @param [in] sampling The steps and columns to validate
+  /// @param [in] processes The processes whose validate methods are called
+  ProcessValidator(int num_columns, const ValidationSampling &sampling,
+                   const AeroProcess<AerosolConfig, ProcessImpls> &...processes)
+      : processes_(processes...), num_columns_(num_columns),
+        sampling_(sampling),
+        failures_("haero::ProcessValidator::failures",
+                  std::max(sampling.max_failures, 0)),
+        num_failures_("haero::ProcessValidator::num_failures"),
+        instance_(), producer_(), separate_instance_(false),
+        num_validated_steps_(0) {
+    EKAT_REQUIRE_MSG(sampling.step_interval > 0,
+                     "ProcessValidator: step_interval must be positive!");
+    EKAT_REQUIRE_MSG(sampling.column_stride > 0,
+                     "ProcessValidator: column_stride must be positive!");
+    (references_.add(processes.id()), ...);
+    names_ = {processes.name()...};
+  }
+
+  /// On host: returns the sampling of steps and columns.
+  const ValidationSampling &sampling() const { return sampling_; }
+
+  /// On host: runs the checks on the given execution space instance (by
+  /// default, the default instance), e.g. one created by
+  /// Kokkos::Experimental::partition_space.
+  /// @param [in] instance The instance on which the checks run
+  /// @param [in] producer The instance whose work produces the prognostics,
+  ///                      which validate fences before launching the checks
+  void set_execution_space(const ExecutionSpace &instance,
+                           const ExecutionSpace &producer = ExecutionSpace()) {
+    instance_.fence();
+    instance_ = instance;
+    producer_ = producer;
+    separate_instance_ = true;
+  }
+
+  /// On host: returns true if the given step is sampled for validation.
+  bool is_sampled(int step) const {
+    return (step % sampling_.step_interval == 0);
+  }
+
+  /// On host: launches the checks for the given step on its sampled columns,
+  /// if the step is sampled. The checks are not waited for.
+  /// @param [in] step The index of the step
+  /// @param [in] state The ColumnState that provides data for each column
+  /// @returns true if the step was sampled, false if not
+  template <typename ColumnState>
+  bool validate(int step, const ColumnState &state) {
+    if (!is_sampled(step)) {
+      return false;
+    }
+    const int stride = sampling_.column_stride;
+    const int offset = num_validated_steps_ % stride;
+    ++num_validated_steps_;
+    const int num_sampled = (num_columns_ - offset + stride - 1) / stride;
+    if (num_sampled <= 0) {
+      return true;
+    }
+    const ColumnCheck<ColumnState> check{processes_, state,    step,
+                                         offset,     stride,   failures_,
+                                         num_failures_};
+    if (separate_instance_) {
+      // order the checks after the work that produced the prognostics,
+      // waiting for the producing instance only
+      producer_.fence("haero::ProcessValidator::validate");
+    }
+    Kokkos::parallel_for("haero::ProcessValidator::validate",
+                         ThreadTeamPolicy(instance_, num_sampled, Kokkos::AUTO),
+                         check);
+    return true;
+  }
+
+  /// On host: waits for any checks in progress and returns the total number
+  /// of failures found (including those not recorded in detail).
+  int num_failures() const {
+    instance_.fence();
+    auto h_num_failures = Kokkos::create_mirror_view(num_failures_);
+    Kokkos::deep_copy(h_num_failures, num_failures_);
+    return h_num_failures();
+  }
+
+  /// On host: waits for any checks in progress and returns the recorded
+  /// failures, in no particular order.
+  std::vector<ValidationFailure> failures() const {
+    const int n = std::min(num_failures(), int(failures_.extent(0)));
+    auto h_failures = Kokkos::create_mirror_view(failures_);
+    Kokkos::deep_copy(h_failures, failures_);
+    return std::vector<ValidationFailure>(h_failures.data(),
+                                          h_failures.data() + n);
+  }
+
+  /// On host: returns a description of the given failure.
+  std::string describe(const ValidationFailure &failure) const {
+    std::string desc = "step " + std::to_string(failure.step) + ", column " +
+                       std::to_string(failure.column) + ": ";
+    if (failure.process >= 0) {
+      desc += "rejected by process " + names_[failure.process];
+      if (failure.tracer >= 0) {
+        desc += " at tracer " + std::to_string(failure.tracer) + ", level " +
+                std::to_string(failure.level);
+      }
+    } else {
+      desc += "non-finite value of tracer " + std::to_string(failure.tracer) +
+              " at level " + std::to_string(failure.level);
+    }
+    return desc;
+  }
+
+  /// On host: waits for any checks in progress and discards all failures.
+  void clear_failures() {
+    instance_.fence();
+    Kokkos::deep_copy(num_failures_, 0);
+  }
+
+private:
+  // This functor checks one sampled column per thread team.
+  template <typename ColumnState> struct ColumnCheck {
+    Processes processes;
+    ColumnState state;
+    int step, offset, stride;
+    DeviceType::view_1d<ValidationFailure> failures;
+    DeviceType::view<int> num_failures;
+
+    KOKKOS_INLINE_FUNCTION
+    void operator()(const ThreadTeam &team) const {
+      const int col = offset + team.league_rank() * stride;
+      const auto prognostics = state.prognostics(col);
+
+      // find the first non-finite value in the column
+      const int num_levels = prognostics.num_levels();
+      const int num_values = prognostics.num_tracers() * num_levels;
+      int first_bad = num_values;
+      Kokkos::parallel_reduce(
+          Kokkos::TeamThreadRange(team, num_values),
+          [&](const int i, int &first) {
+            const Real value = prognostics(i / num_levels, i % num_levels);
+            if ((isnan(value) || isinf(value)) && (i < first)) {
+              first = i;
+            }
+          },
+          Kokkos::Min<int>(first_bad));
+      if (first_bad < num_values) {
+        Kokkos::single(Kokkos::PerTeam(team), [&]() {
+          record({step, -1, col, first_bad / num_levels,
+                  first_bad % num_levels});
+        });
+      }
+
+      validate_processes(team, col, prognostics,
+                         std::make_index_sequence<num_processes>());
+    }
+
+    template <typename Prognostics, std::size_t... P>
+    KOKKOS_INLINE_FUNCTION void
+    validate_processes(const ThreadTeam &team, int col,
+                       const Prognostics &prognostics,
+                       std::index_sequence<P...>) const {
+      (validate_process(team, col, int(P), std::get<P>(processes),
+                        prognostics),
+       ...);
+    }
+
+    template <typename Process, typename Prognostics>
+    KOKKOS_INLINE_FUNCTION void
+    validate_process(const ThreadTeam &team, int col, int p,
+                     const Process &process,
+                     const Prognostics &prognostics) const {
+      int tracer, level;
+      const bool valid =
+          process.validate(team, state.atmosphere(col), state.surface(col),
+                           prognostics, tracer, level);
+      if (!valid) {
+        Kokkos::single(Kokkos::PerTeam(team),
+                       [&]() { record({step, p, col, tracer, level}); });
+      }
+    }
+
+    // records a failure, if there's room
+    KOKKOS_INLINE_FUNCTION
+    void record(const ValidationFailure &failure) const {
+      const int index = Kokkos::atomic_fetch_add(&num_failures(), 1);
+      if (index < int(failures.extent(0))) {
+        failures(index) = failure;
+      }
+    }
+  };
+
+  Processes processes_;
+  // keeps the metadata of the validated processes registered
+  ProcessReferences references_;
+  std::vector<std::string> names_;
+  int num_columns_;
+  ValidationSampling sampling_;
+  DeviceType::view_1d<ValidationFailure> failures_;
+  DeviceType::view<int> num_failures_;
+  ExecutionSpace instance_;
+  // the instance that produces the prognostics checked on instance_
+  ExecutionSpace producer_;
+  // true if the checks run on an instance given by set_execution_space
+  bool separate_instance_;
+  int num_validated_steps_;
+};
+
+} // namespace haero
+
+#endif
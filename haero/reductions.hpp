@@ -0,0 +1,212 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_REDUCTIONS_HPP
+#define HAERO_REDUCTIONS_HPP
+
+#include <haero/haero.hpp>
+
+namespace haero {
+
+/** @defgroup Reductions Reproducible reductions
+
+  Kokkos reductions combine partial results in an order that depends on the
+  team size and the backend, so floating point sums computed with them can
+  differ in their last bits from one configuration to the next. The functions
+  here produce bitwise-identical sums for any team size (and any backend that
+  respects IEEE arithmetic) by fixing the order of every floating point
+  operation:
+
+  1. The index range [0, n) is split into at most max_blocks contiguous blocks
+     whose sizes depend only on n.
+  2. Each block is summed sequentially (with compensation) by a single thread.
+  3. The block sums (and their compensation terms) are gathered exactly (each
+     is computed by one thread and combined only with -0, the additive
+     identity) and then combined with compensation in a fixed pairwise tree.
+
+  These guarantees do not survive value-unsafe compiler optimizations such as
+  -ffast-math, which may reassociate or drop the compensated terms.
+
+ @{
+*/
+
+/// Computes s = fl(a + b) and the rounding error e such that a + b = s + e
+/// exactly (Knuth's TwoSum).
+KOKKOS_INLINE_FUNCTION
+void two_sum(const Real a, const Real b, Real &s, Real &e) {
+  s = a + b;
+  const Real bb = s - a;
+  e = (a - (s - bb)) + (b - bb);
+}
+
+/// Lane-wise TwoSum for Packs.
+KOKKOS_INLINE_FUNCTION
+void two_sum(const PackType a, const PackType b, PackType &s, PackType &e) {
+  s = a + b;
+  const PackType bb = s - a;
+  e = (a - (s - bb)) + (b - bb);
+}
+
+/// @struct BlockSums
+/// Per-block partial sums (and compensation terms) gathered by a reproducible
+/// reduction.
+template <int MaxBlocks> struct BlockSums {
+  Real values[MaxBlocks];
+  Real comps[MaxBlocks];
+};
+
+/// @struct BlockSumsReducer
+/// A Kokkos reducer that gathers per-block partial sums. Since every block is
+/// assigned by exactly one thread and all other entries hold -0 (for which
+/// x + -0 == x holds bitwise, including x = +/-0), joins are exact and
+/// independent of the order in which Kokkos performs them.
+template <int MaxBlocks> struct BlockSumsReducer {
+  using reducer = BlockSumsReducer;
+  using value_type = BlockSums<MaxBlocks>;
+  using result_view_type =
+      Kokkos::View<value_type, Kokkos::HostSpace, Kokkos::MemoryUnmanaged>;
+
+  KOKKOS_INLINE_FUNCTION
+  explicit BlockSumsReducer(value_type &value) : value_(value) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void join(value_type &dest, const value_type &src) const {
+    for (int b = 0; b < MaxBlocks; ++b) {
+      dest.values[b] += src.values[b];
+      dest.comps[b] += src.comps[b];
+    }
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void init(value_type &value) const {
+    for (int b = 0; b < MaxBlocks; ++b) {
+      value.values[b] = -Real(0);
+      value.comps[b] = -Real(0);
+    }
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  value_type &reference() const { return value_; }
+
+  KOKKOS_INLINE_FUNCTION
+  result_view_type view() const { return result_view_type(&value_); }
+
+  KOKKOS_INLINE_FUNCTION
+  bool references_scalar() const { return true; }
+
+private:
+  value_type &value_;
+};
+
+/// @struct ReproducibleSum
+/// Reproducible summation of n terms using at most MaxBlocks blocks. Larger
+/// values of MaxBlocks expose more parallelism at the cost of a larger
+/// reduction value.
+template <int MaxBlocks = 32> struct ReproducibleSum {
+  static_assert(MaxBlocks > 0, "MaxBlocks must be positive!");
+
+  /// Returns the number of terms per block for a sum of n terms.
+  KOKKOS_INLINE_FUNCTION
+  static int block_size(const int n) {
+    const int size = (n + MaxBlocks - 1) / MaxBlocks;
+    return (size > 0) ? size : 1;
+  }
+
+  /// Returns the number of blocks for a sum of n terms.
+  KOKKOS_INLINE_FUNCTION
+  static int num_blocks(const int n) {
+    const int size = block_size(n);
+    return (n + size - 1) / size;
+  }
+
+  /// Computes the sum f(first) + ... + f(last - 1) in order, storing it in
+  /// sum and its accumulated rounding error in comp.
+  template <typename Func>
+  KOKKOS_INLINE_FUNCTION static void block_sum(const int first, const int last,
+                                               const Func &f, Real &sum,
+                                               Real &comp) {
+    sum = 0;
+    comp = 0;
+    for (int i = first; i < last; ++i) {
+      Real err;
+      two_sum(sum, f(i), sum, err);
+      comp += err;
+    }
+  }
+
+  /// Combines the first n block sums in a fixed pairwise tree, returning the
+  /// total.
+  KOKKOS_INLINE_FUNCTION
+  static Real combine(BlockSums<MaxBlocks> &sums, const int n) {
+    for (int stride = 1; stride < n; stride *= 2) {
+      for (int b = 0; b + stride < n; b += 2 * stride) {
+        Real err;
+        two_sum(sums.values[b], sums.values[b + stride], sums.values[b], err);
+        sums.comps[b] += sums.comps[b + stride] + err;
+      }
+    }
+    return (n > 0) ? sums.values[0] + sums.comps[0] : Real(0);
+  }
+
+  /// On device: returns the sum f(0) + f(1) + ... + f(n-1) computed by the
+  /// given team. The result is identical for every team size.
+  /// @param [in] team The Kokkos team that computes the sum
+  /// @param [in] n The number of terms (e.g. the number of vertical levels)
+  /// @param [in] f A function or lambda that returns the ith term
+  template <typename Func>
+  KOKKOS_INLINE_FUNCTION static Real sum(const ThreadTeam &team, const int n,
+                                         const Func &f) {
+    const int size = block_size(n), nb = num_blocks(n);
+    BlockSums<MaxBlocks> sums;
+    Kokkos::parallel_reduce(
+        Kokkos::TeamThreadRange(team, nb),
+        [&](const int b, BlockSums<MaxBlocks> &partial) {
+          const int last = ((b + 1) * size < n) ? (b + 1) * size : n;
+          block_sum(b * size, last, f, partial.values[b], partial.comps[b]);
+        },
+        BlockSumsReducer<MaxBlocks>(sums));
+    return combine(sums, nb);
+  }
+
+  /// On host: returns the sum f(0) + f(1) + ... + f(n-1) computed over the
+  /// default execution space. The result is identical for every backend and
+  /// thread count.
+  template <typename Func> static Real sum(const int n, const Func &f) {
+    const int size = block_size(n), nb = num_blocks(n);
+    BlockSums<MaxBlocks> sums;
+    Kokkos::parallel_reduce(
+        "haero::ReproducibleSum", Kokkos::RangePolicy<ExecutionSpace>(0, nb),
+        KOKKOS_LAMBDA(const int b, BlockSums<MaxBlocks> &partial) {
+          const int last = ((b + 1) * size < n) ? (b + 1) * size : n;
+          block_sum(b * size, last, f, partial.values[b], partial.comps[b]);
+        },
+        BlockSumsReducer<MaxBlocks>(sums));
+    return combine(sums, nb);
+  }
+};
+
+/// On device: returns the reproducible sum f(0) + ... + f(n-1) computed by the
+/// given team (see ReproducibleSum).
+template <typename Func>
+KOKKOS_INLINE_FUNCTION Real reproducible_sum(const ThreadTeam &team,
+                                             const int n, const Func &f) {
+  return ReproducibleSum<>::sum(team, n, f);
+}
+
+/// On device: returns the reproducible vertical integral of q over the n levels
+/// of a column, weighted by the level thicknesses dz (e.g. the hydrostatic
+/// pressure thickness of each level), computed by the given team.
+template <typename QView, typename DzView>
+KOKKOS_INLINE_FUNCTION Real reproducible_integral(const ThreadTeam &team,
+                                                  const int n, const QView &q,
+                                                  const DzView &dz) {
+  return ReproducibleSum<>::sum(team, n,
+                                [&](const int k) { return q(k) * dz(k); });
+}
+
+/// @} defgroup Reductions
+
+} // namespace haero
+
+#endif
@@ -144,22 +144,30 @@ template <typename ScalarFunction> struct BracketedNewtonSolver {
       value_type x = xroot - fx / f.derivative(xroot);
       // safeguard: require x to be inside current bracket
       // assure progress: guard against tiny steps
+      // (a step within tolerance is always accepted, since the root may lie
+      // at the padded edge of the bracket, but is clamped to the bracket)
       const Real pad_fac = bracket_pad_factor;
       const Real pad = pad_fac * (b - a);
-      if (!FloatingPoint<Real>::in_bounds(x, a + pad, b - pad)) {
+      const bool bisect =
+          !FloatingPoint<value_type>::zero(abs(x - xroot), conv_tol) &&
+          !FloatingPoint<Real>::in_bounds(x, a + pad, b - pad);
+      if (bisect) {
         x = 0.5 * (a + b);
+      } else {
+        x = (x < a) ? a : ((x > b) ? b : x);
       }
       fx = f(x);
-      // update bracket
-      if (fx * fa > 0) {
+      // update bracket (comparing signs, since fx * fa can underflow)
+      if ((fx != 0) && ((fx < 0) == (fa < 0))) {
         a = x;
         fa = fx;
       } else {
         b = x;
         fb = fx;
       }
-      // check convergence
-      iter_diff = abs(x - xroot);
+      // check convergence: a bisection step may land on the previous iterate,
+      // so it converges only when the bracket itself is small enough
+      iter_diff = bisect ? b - a : abs(x - xroot);
       keep_going = !FloatingPoint<value_type>::zero(iter_diff, conv_tol);
       // prevent infinite loops
       EKAT_KERNEL_ASSERT_MSG(counter <= max_iter,
@@ -245,13 +253,18 @@ template <typename ScalarFunction> struct BisectionSolver {
     while (keep_going) {
       ++counter;
       const value_type fx = f(xroot);
-      xnp1 = 0.5 * (a + b);
-      if (fx * fa < 0) {
+      // update the interval (comparing signs, since fx * fa can underflow),
+      // collapsing it if we've landed exactly on the root
+      if (fx == 0) {
+        a = xroot;
+        b = xroot;
+      } else if ((fx < 0) != (fa < 0)) {
         b = xroot;
       } else {
         a = xroot;
         fa = fx;
       }
+      xnp1 = 0.5 * (a + b);
       iter_diff = b - a;
       xroot = xnp1;
       keep_going = !(FloatingPoint<value_type>::zero(iter_diff, conv_tol));
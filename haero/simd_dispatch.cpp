@@ -0,0 +1,129 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "simd_dispatch.hpp"
+
+#include <ekat/ekat_assert.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+
+namespace haero {
+
+// These functions return the kernels compiled for each instruction set (or
+// nullptr if the build doesn't support it), and are defined in
+// simd_kernels_<isa>.cpp.
+const SimdKernels *generic_simd_kernels();
+const SimdKernels *avx2_simd_kernels();
+const SimdKernels *avx512_simd_kernels();
+
+namespace {
+
+// Instruction sets from narrowest to widest.
+const SimdIsa all_isas[] = {SimdIsa::generic, SimdIsa::avx2, SimdIsa::avx512};
+
+// Returns the kernels compiled for the given instruction set, or nullptr.
+const SimdKernels *compiled_kernels(SimdIsa isa) {
+  switch (isa) {
+  case SimdIsa::generic:
+    return generic_simd_kernels();
+  case SimdIsa::avx2:
+    return avx2_simd_kernels();
+  case SimdIsa::avx512:
+    return avx512_simd_kernels();
+  }
+  return nullptr;
+}
+
+// Returns true if the CPU supports the given instruction set. The CPUID
+// checks made by __builtin_cpu_supports include whether the operating system
+// saves the corresponding vector registers.
+bool cpu_supports(SimdIsa isa) {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+  __builtin_cpu_init();
+  switch (isa) {
+  case SimdIsa::generic:
+    return true;
+  case SimdIsa::avx2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  case SimdIsa::avx512:
+    return __builtin_cpu_supports("avx512f") &&
+           __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+  }
+  return false;
+#else
+  return (isa == SimdIsa::generic);
+#endif
+}
+
+} // namespace
+
+const char *simd_isa_name(SimdIsa isa) {
+  switch (isa) {
+  case SimdIsa::generic:
+    return "generic";
+  case SimdIsa::avx2:
+    return "avx2";
+  case SimdIsa::avx512:
+    return "avx512";
+  }
+  return "unknown";
+}
+
+SimdIsa simd_isa_from_name(const std::string &name) {
+  const SimdIsa *isa = std::find_if(
+      std::begin(all_isas), std::end(all_isas),
+      [&](SimdIsa candidate) { return name == simd_isa_name(candidate); });
+  EKAT_REQUIRE_MSG(isa != std::end(all_isas),
+                   "Invalid SIMD instruction set: "
+                       << name << " (expected 'generic', 'avx2', or 'avx512')");
+  return *isa;
+}
+
+bool simd_isa_supported(SimdIsa isa) {
+  return compiled_kernels(isa) && cpu_supports(isa);
+}
+
+SimdIsa widest_simd_isa() {
+  SimdIsa widest = SimdIsa::generic;
+  for (SimdIsa isa : all_isas) {
+    if (simd_isa_supported(isa)) {
+      widest = isa;
+    }
+  }
+  return widest;
+}
+
+SimdIsa select_simd_isa(const char *request) {
+  if (!request || !request[0] || (std::string(request) == "auto")) {
+    return widest_simd_isa();
+  }
+  const SimdIsa isa = simd_isa_from_name(request);
+  EKAT_REQUIRE_MSG(simd_isa_supported(isa),
+                   "The SIMD instruction set "
+                       << request << " isn't supported on this CPU (widest "
+                       << "supported: " << simd_isa_name(widest_simd_isa())
+                       << ")");
+  return isa;
+}
+
+SimdIsa selected_simd_isa() {
+  static const SimdIsa isa = select_simd_isa(std::getenv("HAERO_SIMD_ISA"));
+  return isa;
+}
+
+const SimdKernels &simd_kernels(SimdIsa isa) {
+  EKAT_REQUIRE_MSG(simd_isa_supported(isa),
+                   "No kernels are available for the SIMD instruction set "
+                       << simd_isa_name(isa) << " on this CPU");
+  return *compiled_kernels(isa);
+}
+
+const SimdKernels &simd_kernels() {
+  static const SimdKernels &kernels = simd_kernels(selected_simd_isa());
+  return kernels;
+}
+
+} // namespace haero
@@ -0,0 +1,87 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_SIMD_DISPATCH_HPP
+#define HAERO_SIMD_DISPATCH_HPP
+
+#include <haero/haero_config.hpp>
+
+#include <cstddef>
+#include <string>
+
+namespace haero {
+
+/// SIMD instruction sets for which Haero compiles host kernels. The Pack width
+/// of device kernels (HAERO_PACK_SIZE) is fixed when Haero is built, so a
+/// library built for the oldest CPUs in a cluster would underuse wider vector
+/// units. The host kernels in SimdKernels are instead compiled once for each
+/// of these instruction sets, and the widest one supported by the CPU is
+/// selected when a program starts.
+enum class SimdIsa {
+  /// the baseline instruction set of the build (SSE2 on x86-64), with 16-byte
+  /// vectors
+  generic = 0,
+  /// AVX2 with FMA, with 32-byte vectors
+  avx2 = 1,
+  /// AVX-512 (foundation), with 64-byte vectors
+  avx512 = 2
+};
+
+/// On host: returns the name of the given instruction set ("generic", "avx2",
+/// or "avx512").
+const char *simd_isa_name(SimdIsa isa);
+
+/// On host: returns the instruction set with the given name, throwing an
+/// exception if the name isn't recognized.
+SimdIsa simd_isa_from_name(const std::string &name);
+
+/// On host: returns true if the calling CPU supports the given instruction
+/// set and Haero was built with kernels for it. The generic instruction set
+/// is always supported.
+bool simd_isa_supported(SimdIsa isa);
+
+/// On host: returns the widest supported instruction set.
+SimdIsa widest_simd_isa();
+
+/// On host: returns the instruction set requested by the given string:
+/// the widest supported one if the request is null, empty, or "auto", and the
+/// named one otherwise. Throws an exception if the named instruction set
+/// isn't supported.
+SimdIsa select_simd_isa(const char *request);
+
+/// On host: returns the instruction set of the host kernels used by Haero,
+/// selected by select_simd_isa when first called from the HAERO_SIMD_ISA
+/// environment variable. Set HAERO_SIMD_ISA to "generic", "avx2", or "avx512"
+/// to test a narrower instruction set than the CPU supports.
+SimdIsa selected_simd_isa();
+
+/// @struct SimdKernels
+/// A table of host kernels compiled for a specific instruction set. Each
+/// kernel works on contiguous arrays of Reals in host memory, and processes
+/// pack_size Reals per vector instruction. The table holds only the column
+/// integral kernel, which compute_column_burdens_simd uses.
+struct SimdKernels {
+  /// the instruction set for which the kernels were compiled
+  SimdIsa isa;
+  /// the number of Reals in a vector register of this instruction set
+  int pack_size;
+
+  /// Computes the integrals @f$ I_i = s \sum_k q_i(k) w(k)@f$ of ntracers
+  /// tracers over nlev levels, where q_i(k) = q[i * tracer_stride + k].
+  void (*integrate)(int ntracers, int nlev, const Real *q,
+                    std::ptrdiff_t tracer_stride, const Real *w, Real scale,
+                    Real *integrals);
+};
+
+/// On host: returns the kernels compiled for the given instruction set,
+/// throwing an exception if it isn't supported.
+const SimdKernels &simd_kernels(SimdIsa isa);
+
+/// On host: returns the kernels for the selected instruction set (see
+/// selected_simd_isa).
+const SimdKernels &simd_kernels();
+
+} // namespace haero
+
+#endif
@@ -0,0 +1,27 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "simd_dispatch.hpp"
+
+// AVX2 kernels are available on x86 with compilers that support target
+// attributes (GCC, Clang, and Intel's compilers).
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define HAERO_SIMD_VARIANT avx2
+#define HAERO_SIMD_BYTES 32
+#define HAERO_SIMD_TARGET __attribute__((target("avx2,fma")))
+#include "simd_kernels_impl.hpp"
+#endif
+
+namespace haero {
+
+// Returns the AVX2 kernels, or nullptr if they aren't available.
+const SimdKernels *avx2_simd_kernels() {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+  return &avx2::kernels;
+#else
+  return nullptr;
+#endif
+}
+
+} // namespace haero
@@ -0,0 +1,17 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "simd_dispatch.hpp"
+
+#define HAERO_SIMD_VARIANT generic
+#define HAERO_SIMD_BYTES 16
+#define HAERO_SIMD_TARGET
+#include "simd_kernels_impl.hpp"
+
+namespace haero {
+
+// Returns the kernels for the baseline instruction set.
+const SimdKernels *generic_simd_kernels() { return &generic::kernels; }
+
+} // namespace haero
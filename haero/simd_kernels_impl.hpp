@@ -0,0 +1,60 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+// This file defines the kernels in SimdKernels. It is included by each
+// simd_kernels_<isa>.cpp file, which defines
+// * HAERO_SIMD_VARIANT, the namespace in which the kernels are defined
+// * HAERO_SIMD_BYTES, the size of a vector register in bytes
+// * HAERO_SIMD_TARGET, the target attribute that enables the instruction set
+//   for each kernel
+//
+// Only the kernels are compiled for the instruction set; the rest of each file
+// (including any static initializers from headers) uses the baseline flags, so
+// the library loads on any CPU. For the same reason, the kernels must not call
+// inline functions (such as ekat::Pack operators), which would be compiled
+// without the instruction set or, if inlined, rejected by the compiler. They
+// use compiler vector types instead, which are lowered to the widest
+// instructions enabled for the kernel.
+
+#include <haero/simd_dispatch.hpp>
+
+namespace haero {
+namespace HAERO_SIMD_VARIANT {
+
+// the number of Reals in a vector register
+constexpr int pack_size = HAERO_SIMD_BYTES / sizeof(Real);
+
+// a vector register of Reals
+typedef Real SimdPack __attribute__((vector_size(HAERO_SIMD_BYTES)));
+
+HAERO_SIMD_TARGET void integrate(int ntracers, int nlev, const Real *q,
+                                 std::ptrdiff_t tracer_stride, const Real *w,
+                                 Real scale, Real *integrals) {
+  const int nvec = nlev / pack_size;
+  for (int i = 0; i < ntracers; ++i) {
+    const Real *qi = q + i * tracer_stride;
+    // accumulate whole vectors of levels, then the remaining levels
+    SimdPack acc = {};
+    for (int v = 0; v < nvec; ++v) {
+      SimdPack x, y;
+      __builtin_memcpy(&x, qi + v * pack_size, sizeof(SimdPack));
+      __builtin_memcpy(&y, w + v * pack_size, sizeof(SimdPack));
+      acc += x * y;
+    }
+    Real sum = 0;
+    for (int s = 0; s < pack_size; ++s) {
+      sum += acc[s];
+    }
+    for (int k = nvec * pack_size; k < nlev; ++k) {
+      sum += qi[k] * w[k];
+    }
+    integrals[i] = scale * sum;
+  }
+}
+
+const SimdKernels kernels = {SimdIsa::HAERO_SIMD_VARIANT, pack_size,
+                             integrate};
+
+} // namespace HAERO_SIMD_VARIANT
+} // namespace haero
@@ -0,0 +1,95 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "staging_pipeline.hpp"
+
+namespace haero {
+
+StagingPipeline::StagingPipeline(int num_tracers, int num_levels,
+                                 int chunk_size)
+    : num_tracers_(num_tracers), num_levels_(num_levels),
+      chunk_size_(chunk_size), slots_(num_slots) {
+  EKAT_REQUIRE_MSG(num_tracers > 0, "StagingPipeline: num_tracers must be > 0");
+  EKAT_REQUIRE_MSG(num_levels > 0, "StagingPipeline: num_levels must be > 0");
+  EKAT_REQUIRE_MSG(chunk_size > 0, "StagingPipeline: chunk_size must be > 0");
+#ifdef KOKKOS_ENABLE_CUDA
+  // give each slot its own stream
+  const auto instances = Kokkos::Experimental::partition_space(
+      ExecutionSpace(), std::vector<int>(num_slots, 1));
+#else
+  // on host, partitioning would only shrink the thread pool for each chunk
+  const std::vector<ExecutionSpace> instances(num_slots, ExecutionSpace());
+#endif
+  const int chunk_length = num_tracers * chunk_size * num_levels;
+  for (int s = 0; s < num_slots; ++s) {
+    auto &slot = slots_[s];
+    slot.instance = instances[s];
+    slot.pinned_in = PinnedView(
+        Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                           "haero::StagingPipeline::pinned_in"),
+        chunk_length);
+    slot.pinned_out = PinnedView(
+        Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                           "haero::StagingPipeline::pinned_out"),
+        chunk_length);
+    slot.device_in = DeviceType::view_1d<Real>(
+        Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                           "haero::StagingPipeline::device_in"),
+        chunk_length);
+    slot.device_out = DeviceType::view_1d<Real>(
+        Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                           "haero::StagingPipeline::device_out"),
+        chunk_length);
+    for (const auto &pinned : {slot.pinned_in, slot.pinned_out}) {
+      tracker_.track(pinned, "staging", "haero::StagingPipeline");
+    }
+    for (const auto &buffer : {slot.device_in, slot.device_out}) {
+      tracker_.track(buffer, "staging", "haero::StagingPipeline");
+    }
+    slot.first_column = 0;
+    slot.num_columns = 0;
+  }
+}
+
+void StagingPipeline::stage_in(const ConstHostTracersView &input,
+                               Slot &slot) const {
+  const auto pinned = pinned_chunk(slot.pinned_in, slot.num_columns);
+  const int first_column = slot.first_column, num_columns = slot.num_columns;
+  const int num_levels = num_levels_;
+  Kokkos::parallel_for(
+      "haero::StagingPipeline::stage_in",
+      HostType::RangePolicy(0, num_tracers_ * num_columns * num_levels),
+      [=](const int i) {
+        const int q = i / (num_columns * num_levels);
+        const int col = (i / num_levels) % num_columns, k = i % num_levels;
+        pinned(q, col, k) = input(q, first_column + col, k);
+      });
+  // the copy mustn't start before the packing is done
+  HostType::ExeSpace().fence();
+  Kokkos::deep_copy(slot.instance, device_chunk(slot.device_in, num_columns),
+                    pinned);
+}
+
+void StagingPipeline::stage_out(Slot &slot,
+                                const HostTracersView &output) const {
+  if (slot.num_columns == 0) {
+    return;
+  }
+  slot.instance.fence();
+  const auto pinned = pinned_chunk(slot.pinned_out, slot.num_columns);
+  const int first_column = slot.first_column, num_columns = slot.num_columns;
+  const int num_levels = num_levels_;
+  Kokkos::parallel_for(
+      "haero::StagingPipeline::stage_out",
+      HostType::RangePolicy(0, num_tracers_ * num_columns * num_levels),
+      [=](const int i) {
+        const int q = i / (num_columns * num_levels);
+        const int col = (i / num_levels) % num_columns, k = i % num_levels;
+        output(q, first_column + col, k) = pinned(q, col, k);
+      });
+  HostType::ExeSpace().fence();
+  slot.num_columns = 0;
+}
+
+} // namespace haero
@@ -0,0 +1,168 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_STAGING_PIPELINE_HPP
+#define HAERO_STAGING_PIPELINE_HPP
+
+#include <haero/haero.hpp>
+#include <haero/memory.hpp>
+
+#include <ekat/ekat_assert.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace haero {
+
+/// PinnedMemorySpace refers to page-locked host memory, which can be copied to
+/// and from the device asynchronously.
+#ifdef KOKKOS_ENABLE_CUDA
+typedef Kokkos::CudaHostPinnedSpace PinnedMemorySpace;
+#else
+typedef Kokkos::HostSpace PinnedMemorySpace;
+#endif
+
+/// @class StagingPipeline
+/// This type couples Haero to a host model that stores its tracers in host
+/// memory. Rather than copying all columns to the device, computing, and
+/// copying them back, a StagingPipeline splits the columns into chunks and
+/// moves each chunk through pinned host buffers and device buffers on its own
+/// execution space instance, so that the copy of one chunk to the device, the
+/// computation on the previous chunk, and the copy of the chunk before that
+/// back to the host all proceed at once. Packing chunks into the pinned
+/// buffers on the host also overlaps with work on the device.
+///
+/// If the device is the host (Serial or OpenMP backends), chunks are simply
+/// processed in order on the default execution space instance.
+class StagingPipeline final {
+public:
+  /// tracer data in host memory, indexed by (tracer, column, level)
+  using HostTracersView = HostType::view_3d<Real>;
+  using ConstHostTracersView = HostType::view_3d<const Real>;
+
+  /// the number of chunks in flight at once: one being copied to the device,
+  /// one being computed, and one being copied back to the host
+  static constexpr int num_slots = 3;
+
+  /// Constructs a pipeline for tracer data with the given dimensions, which
+  /// moves the given number of columns at a time.
+  /// @param [in] num_tracers The number of tracers in each column
+  /// @param [in] num_levels The number of vertical levels in each column
+  /// @param [in] chunk_size The (maximum) number of columns in a chunk
+  StagingPipeline(int num_tracers, int num_levels, int chunk_size);
+
+  StagingPipeline(const StagingPipeline &) = delete;
+  StagingPipeline &operator=(const StagingPipeline &) = delete;
+
+  /// Returns the number of tracers in each column.
+  int num_tracers() const { return num_tracers_; }
+
+  /// Returns the number of vertical levels in each column.
+  int num_levels() const { return num_levels_; }
+
+  /// Returns the (maximum) number of columns in a chunk.
+  int chunk_size() const { return chunk_size_; }
+
+  /// Returns the number of chunks into which the given number of columns are
+  /// split.
+  int num_chunks(int num_columns) const {
+    return (num_columns + chunk_size_ - 1) / chunk_size_;
+  }
+
+  /// On host: runs the given computation on every column of the given input,
+  /// one chunk at a time, storing its results in the given output. The
+  /// computation is a callable object with the signature
+  /// ```
+  /// void compute(const ExecutionSpace &instance, const TracersView &input,
+  ///              const TracersView &output, int first_column)
+  /// ```
+  /// that launches kernels on the given instance reading the input columns
+  /// of a chunk (whose first column has the given index) and writing its
+  /// output columns. It must not fence the instance or wait for its kernels.
+  /// The input and output may be the same view.
+  /// @param [in] input The input tracers, indexed by (tracer, column, level)
+  /// @param [out] output The output tracers, with the same dimensions
+  /// @param [in] compute The computation to run on each chunk
+  template <typename ChunkCompute>
+  void run(const ConstHostTracersView &input, const HostTracersView &output,
+           const ChunkCompute &compute) {
+    EKAT_REQUIRE_MSG((input.extent(0) == num_tracers_) &&
+                         (input.extent(2) == num_levels_),
+                     "StagingPipeline: input has the wrong dimensions!");
+    EKAT_REQUIRE_MSG((output.extent(0) == input.extent(0)) &&
+                         (output.extent(1) == input.extent(1)) &&
+                         (output.extent(2) == input.extent(2)),
+                     "StagingPipeline: output and input dimensions differ!");
+    const int num_columns = input.extent(1);
+    const int nchunks = num_chunks(num_columns);
+    for (int chunk = 0; chunk < nchunks; ++chunk) {
+      auto &slot = slots_[chunk % num_slots];
+      // retire the chunk that last used this slot, freeing its buffers
+      stage_out(slot, output);
+      slot.first_column = chunk * chunk_size_;
+      slot.num_columns = std::min(chunk_size_, num_columns - slot.first_column);
+      stage_in(input, slot);
+      compute(slot.instance, device_chunk(slot.device_in, slot.num_columns),
+              device_chunk(slot.device_out, slot.num_columns),
+              slot.first_column);
+      Kokkos::deep_copy(slot.instance,
+                        pinned_chunk(slot.pinned_out, slot.num_columns),
+                        device_chunk(slot.device_out, slot.num_columns));
+    }
+    // retire the chunks still in flight, in order
+    for (int chunk = std::max(0, nchunks - num_slots); chunk < nchunks;
+         ++chunk) {
+      stage_out(slots_[chunk % num_slots], output);
+    }
+  }
+
+private:
+  using PinnedView = Kokkos::View<Real *, PinnedMemorySpace>;
+  using PinnedTracersView =
+      Kokkos::View<Real ***, Kokkos::LayoutRight, PinnedMemorySpace,
+                   Kokkos::MemoryUnmanaged>;
+
+  // buffers and execution space instance for one chunk in flight
+  struct Slot {
+    ExecutionSpace instance;
+    PinnedView pinned_in, pinned_out;
+    DeviceType::view_1d<Real> device_in, device_out;
+    // the chunk occupying the slot (num_columns == 0 if none)
+    int first_column, num_columns;
+  };
+
+  // returns the tracers for a chunk with the given number of columns in the
+  // given (contiguous) pinned buffer
+  PinnedTracersView pinned_chunk(const PinnedView &buffer,
+                                 int num_columns) const {
+    return PinnedTracersView(buffer.data(), num_tracers_, num_columns,
+                             num_levels_);
+  }
+
+  // returns the tracers for a chunk with the given number of columns in the
+  // given (contiguous) device buffer
+  TracersView device_chunk(const DeviceType::view_1d<Real> &buffer,
+                           int num_columns) const {
+    return TracersView(buffer.data(), num_tracers_, num_columns, num_levels_);
+  }
+
+  // packs the slot's chunk of the input into its pinned buffer and starts
+  // copying it to the device
+  void stage_in(const ConstHostTracersView &input, Slot &slot) const;
+
+  // waits for the slot's chunk (if any) to finish and unpacks it from its
+  // pinned buffer into the output
+  void stage_out(Slot &slot, const HostTracersView &output) const;
+
+  int num_tracers_;
+  int num_levels_;
+  int chunk_size_;
+  std::vector<Slot> slots_;
+  // registers the slots' buffers with Haero's memory registry
+  memory::ViewTracker tracker_;
+};
+
+} // namespace haero
+
+#endif
@@ -0,0 +1,311 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "table_cache.hpp"
+#include "memory.hpp"
+
+#include <ekat/ekat_assert.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define HAERO_TABLE_CACHE_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace haero {
+
+namespace {
+
+// The first bytes of every cache file.
+const char file_magic[8] = {'H', 'A', 'E', 'R', 'O', 'T', 'B', 'L'};
+
+// The version of the cache file format.
+const std::uint32_t file_format_version = 1;
+
+// The header of a cache file, which is followed by the table's values. Its
+// size keeps the values aligned within a mapped file.
+struct FileHeader {
+  char magic[8];
+  std::uint32_t format_version;
+  std::uint32_t real_size;
+  std::uint64_t key_hash;
+  std::uint64_t size;
+  std::uint64_t checksum;
+  char padding[24];
+};
+static_assert(sizeof(FileHeader) == 64, "FileHeader must be 64 bytes!");
+
+// Returns the 64-bit FNV-1a hash of the given bytes.
+std::uint64_t fnv1a(const void *data, std::size_t bytes) {
+  const unsigned char *p = static_cast<const unsigned char *>(data);
+  std::uint64_t hash = 14695981039346656037ull;
+  for (std::size_t i = 0; i < bytes; ++i) {
+    hash = (hash ^ p[i]) * 1099511628211ull;
+  }
+  return hash;
+}
+
+// Appends the given string to the given bytes, preceded by its length.
+void append_string(std::string &bytes, const std::string &s) {
+  const std::uint64_t length = s.size();
+  bytes.append(reinterpret_cast<const char *>(&length), sizeof(length));
+  bytes.append(s);
+}
+
+// Returns true if the given file contents hold a table with the given key
+// hash and number of values, whose values match their checksum.
+bool valid_table(const char *contents, std::size_t bytes,
+                 std::uint64_t key_hash, std::size_t size) {
+  if (bytes != sizeof(FileHeader) + size * sizeof(Real)) {
+    return false;
+  }
+  FileHeader header;
+  std::memcpy(&header, contents, sizeof(FileHeader));
+  return (std::memcmp(header.magic, file_magic, sizeof(file_magic)) == 0) &&
+         (header.format_version == file_format_version) &&
+         (header.real_size == sizeof(Real)) && (header.key_hash == key_hash) &&
+         (header.size == size) &&
+         (header.checksum ==
+          fnv1a(contents + sizeof(FileHeader), size * sizeof(Real)));
+}
+
+// Maps the file at the given path into memory, returning its address and
+// setting bytes to its size. Sets found to true if the file exists. Returns
+// nullptr if the file doesn't exist, can't be read, or is empty.
+void *map_file(const std::string &path, std::size_t &bytes, bool &found) {
+  bytes = 0;
+#ifdef HAERO_TABLE_CACHE_MMAP
+  const int fd = open(path.c_str(), O_RDONLY);
+  found = (fd >= 0);
+  if (fd < 0) {
+    return nullptr;
+  }
+  void *mapping = nullptr;
+  struct stat status;
+  if ((fstat(fd, &status) == 0) && (status.st_size > 0)) {
+    bytes = status.st_size;
+    mapping = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      mapping = nullptr;
+    }
+  }
+  close(fd);
+  return mapping;
+#else
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  found = file.is_open();
+  const std::streamoff length = found ? std::streamoff(file.tellg()) : 0;
+  if (length <= 0) {
+    return nullptr;
+  }
+  bytes = length;
+  char *contents = new char[bytes];
+  file.seekg(0);
+  if (!file.read(contents, bytes)) {
+    delete[] contents;
+    return nullptr;
+  }
+  return contents;
+#endif
+}
+
+// Releases memory obtained from map_file.
+void unmap_file(void *mapping, std::size_t bytes) {
+#ifdef HAERO_TABLE_CACHE_MMAP
+  munmap(mapping, bytes);
+#else
+  delete[] static_cast<char *>(mapping);
+#endif
+}
+
+// Creates the given directory and any missing parents, ignoring errors.
+void create_directory(const std::string &directory) {
+#ifdef HAERO_TABLE_CACHE_MMAP
+  std::size_t slash = 0;
+  do {
+    slash = directory.find('/', slash + 1);
+    mkdir(directory.substr(0, slash).c_str(), 0777);
+  } while (slash != std::string::npos);
+#endif
+}
+
+// Returns a suffix for a temporary file name that is unique to this host and
+// process, and random, so that writers sharing a directory (from different
+// nodes of a cluster, whose process IDs may coincide) never share a file.
+std::string temp_suffix() {
+  std::ostringstream suffix;
+#ifdef HAERO_TABLE_CACHE_MMAP
+  char host[256] = {};
+  if (gethostname(host, sizeof(host) - 1) == 0) {
+    suffix << host << ".";
+  }
+  suffix << getpid() << ".";
+#endif
+  std::random_device random;
+  suffix << std::hex << std::setfill('0') << std::setw(8) << random()
+         << std::setw(8) << random();
+  return suffix.str();
+}
+
+// Writes the table with the given key hash and values to the file at the
+// given path, returning true on success. The table is written to a
+// temporary file that is then renamed, so readers never see a partial file.
+bool write_file(const std::string &path, std::uint64_t key_hash,
+                const Real *values, std::size_t size) {
+  FileHeader header{};
+  std::memcpy(header.magic, file_magic, sizeof(file_magic));
+  header.format_version = file_format_version;
+  header.real_size = sizeof(Real);
+  header.key_hash = key_hash;
+  header.size = size;
+  header.checksum = fnv1a(values, size * sizeof(Real));
+
+  const std::string temp_path = path + ".tmp." + temp_suffix();
+  std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char *>(&header), sizeof(FileHeader));
+  file.write(reinterpret_cast<const char *>(values), size * sizeof(Real));
+  file.close();
+  if (!file || (std::rename(temp_path.c_str(), path.c_str()) != 0)) {
+    std::remove(temp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+// Records a table's values with Haero's memory registry.
+void track_table(const Real *data, std::size_t size) {
+  if (size > 0) {
+    memory::record_allocation(data, size * sizeof(Real),
+                              Kokkos::HostSpace::name(), "tables",
+                              "haero::TableCache");
+  }
+}
+
+// Returns true if the given character may appear in a table name.
+bool valid_name_char(char c) {
+  return std::isalnum(static_cast<unsigned char>(c)) || (c == '_') ||
+         (c == '-') || (c == '.');
+}
+
+} // namespace
+
+TableKey::TableKey(const std::string &name) : name_(name) {
+  EKAT_REQUIRE_MSG(!name.empty() && std::all_of(name.begin(), name.end(),
+                                                valid_name_char),
+                   "Invalid table name: '" << name << "'");
+}
+
+TableKey &TableKey::add(const std::string &parameter) {
+  append_string(parameters_, parameter);
+  return *this;
+}
+
+std::uint64_t TableKey::hash(std::size_t size) const {
+  std::string bytes;
+  append_string(bytes, name_);
+  append_string(bytes, parameters_);
+  const std::uint64_t num_values = size;
+  bytes.append(reinterpret_cast<const char *>(&num_values),
+               sizeof(num_values));
+  const std::uint32_t real_size = sizeof(Real);
+  bytes.append(reinterpret_cast<const char *>(&real_size), sizeof(real_size));
+  append_string(bytes, version());
+  append_string(bytes, revision());
+  return fnv1a(bytes.data(), bytes.size());
+}
+
+CachedTable::~CachedTable() {
+  if (data_ && memory::is_tracked(data_)) {
+    memory::record_deallocation(data_);
+  }
+  if (mapping_) {
+    unmap_file(mapping_, mapping_bytes_);
+  }
+}
+
+TableCache::TableCache(const std::string &directory) : directory_(directory) {}
+
+TableCache TableCache::from_environment() {
+  const char *directory = std::getenv("HAERO_TABLE_CACHE");
+  return TableCache(directory ? directory : "");
+}
+
+std::string TableCache::path(const TableKey &key, std::size_t size) const {
+  std::ostringstream path;
+  path << directory_ << "/" << key.name() << "-" << std::hex
+       << std::setfill('0') << std::setw(16) << key.hash(size) << ".tbl";
+  return path.str();
+}
+
+std::shared_ptr<const CachedTable>
+TableCache::table(const TableKey &key, std::size_t size,
+                  const std::function<void(Real *values)> &generate) {
+  std::shared_ptr<CachedTable> table(new CachedTable());
+  table->size_ = size;
+  const std::uint64_t key_hash = key.hash(size);
+  const std::string file_path = enabled() ? path(key, size) : "";
+  if (enabled()) {
+    std::size_t bytes;
+    bool found;
+    void *mapping = map_file(file_path, bytes, found);
+    if (mapping &&
+        valid_table(static_cast<const char *>(mapping), bytes, key_hash,
+                    size)) {
+      table->mapping_ = mapping;
+      table->mapping_bytes_ = bytes;
+      table->data_ = reinterpret_cast<const Real *>(
+          static_cast<const char *>(mapping) + sizeof(FileHeader));
+      track_table(table->data_, size);
+      ++num_hits_;
+      return table;
+    }
+    if (mapping) {
+      unmap_file(mapping, bytes);
+    }
+    if (found) {
+      ++num_rejected_;
+    } else {
+      ++num_misses_;
+    }
+  } else {
+    ++num_misses_;
+  }
+
+  table->values_.resize(size);
+  generate(table->values_.data());
+  table->data_ = table->values_.data();
+  track_table(table->data_, size);
+  if (enabled()) {
+    create_directory(directory_);
+    write_file(file_path, key_hash, table->data_, size);
+  }
+  return table;
+}
+
+DeviceType::view_1d<Real>
+TableCache::device_table(const TableKey &key, std::size_t size,
+                         const std::function<void(Real *values)> &generate,
+                         memory::ViewTracker &tracker,
+                         const std::string &owner) {
+  auto values = table(key, size, generate);
+  DeviceType::view_1d<Real> d_values(
+      Kokkos::view_alloc(Kokkos::WithoutInitializing, key.name()), size);
+  tracker.track(d_values, "tables", owner);
+  Kokkos::deep_copy(d_values, values->view());
+  return d_values;
+}
+
+} // namespace haero
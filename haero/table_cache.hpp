@@ -0,0 +1,194 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_TABLE_CACHE_HPP
+#define HAERO_TABLE_CACHE_HPP
+
+#include <haero/haero.hpp>
+#include <haero/memory.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace haero {
+
+/// @class TableKey
+/// This type identifies a table of values precomputed at initialization (a
+/// lookup table of nucleation rates, say, or a set of quadrature weights). A
+/// key consists of the name of the table's generator and the parameters
+/// passed to it, e.g.
+/// ```
+/// TableKey key("kohler_radii");
+/// key.add(config.num_bins).add(config.min_radius).add(config.max_radius);
+/// ```
+/// Two tables have the same key only if they have the same name and the same
+/// parameters, added in the same order. Tables with the same key but
+/// different numbers of values are stored separately.
+class TableKey final {
+public:
+  /// Creates a key for the generator with the given name, which may contain
+  /// only letters, digits, underscores, hyphens, and periods, since it forms
+  /// part of the name of a cache file.
+  explicit TableKey(const std::string &name);
+
+  /// Adds the given integer, float, double, or enumerated parameter to the
+  /// key, returning the key. The parameter's bytes form part of the key, so
+  /// types whose representations can contain padding (such as long double)
+  /// are rejected.
+  template <typename T> TableKey &add(const T &parameter) {
+    static_assert(std::is_integral<T>::value || std::is_enum<T>::value ||
+                      std::is_same<T, float>::value ||
+                      std::is_same<T, double>::value,
+                  "Table parameters must be integers, floats, doubles, "
+                  "enums, or strings!");
+    parameters_.append(reinterpret_cast<const char *>(&parameter), sizeof(T));
+    return *this;
+  }
+
+  /// Adds the given string parameter to the key, returning the key.
+  TableKey &add(const std::string &parameter);
+
+  /// Adds the given string parameter to the key, returning the key.
+  TableKey &add(const char *parameter) { return add(std::string(parameter)); }
+
+  /// Returns the name of the table's generator.
+  const std::string &name() const { return name_; }
+
+  /// Returns a 64-bit hash of the key's name and parameters, the given number
+  /// of values in its table, the size of Haero's Real type, and Haero's
+  /// version and revision, so a table of another size, or generated by
+  /// another version of Haero or in another precision, has a different hash.
+  std::uint64_t hash(std::size_t size) const;
+
+private:
+  std::string name_;
+  // parameter bytes, with strings preceded by their lengths
+  std::string parameters_;
+};
+
+/// @class CachedTable
+/// This type holds a read-only table of Reals, either memory-mapped from a
+/// cache file or generated in memory. Its data remain valid as long as the
+/// table exists.
+class CachedTable final {
+public:
+  CachedTable(const CachedTable &) = delete;
+  CachedTable &operator=(const CachedTable &) = delete;
+  ~CachedTable();
+
+  /// Returns the number of values in the table.
+  std::size_t size() const { return size_; }
+
+  /// Returns a pointer to the table's values.
+  const Real *data() const { return data_; }
+
+  /// Returns true if the table was read from a cache file, and false if it
+  /// was generated.
+  bool from_cache() const { return mapping_ != nullptr; }
+
+  /// Returns an unmanaged host view of the table's values.
+  ekat::Unmanaged<HostType::view_1d<const Real>> view() const {
+    return ekat::Unmanaged<HostType::view_1d<const Real>>(data_, size_);
+  }
+
+private:
+  friend class TableCache;
+  CachedTable() = default;
+
+  // the memory-mapped cache file (or a copy of its contents on systems
+  // without mmap), or nullptr for a generated table
+  void *mapping_ = nullptr;
+  std::size_t mapping_bytes_ = 0;
+  // storage for a generated table
+  std::vector<Real> values_;
+  const Real *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+/// @class TableCache
+/// This type stores tables precomputed at initialization in files within a
+/// directory, so that later runs (including the other members of an
+/// ensemble) map the tables into memory instead of regenerating them. Each
+/// file is named after its table's key, and holds a header with the key's
+/// hash, the size of Real, the number of values, and a checksum of the
+/// values. A file whose header or checksum doesn't match is rejected and
+/// replaced by a regenerated table, so corrupted or truncated files (and
+/// files from other versions of Haero) are never used. Files are written to
+/// a temporary file with a name unique to the writing host and process, and
+/// renamed, so concurrent runs sharing a directory (even across the nodes of
+/// a cluster) never read partially-written tables.
+class TableCache final {
+public:
+  /// On host: creates a cache that stores tables in the given directory,
+  /// which is created when the first table is stored. If the directory is
+  /// empty, the cache is disabled, and every table is generated.
+  explicit TableCache(const std::string &directory = "");
+
+  /// On host: creates a cache that stores tables in the directory given by
+  /// the HAERO_TABLE_CACHE environment variable, or a disabled cache if it
+  /// isn't set.
+  static TableCache from_environment();
+
+  /// On host: returns true if the cache stores tables, false if not.
+  bool enabled() const { return !directory_.empty(); }
+
+  /// On host: returns the cache's directory (empty if disabled).
+  const std::string &directory() const { return directory_; }
+
+  /// On host: returns the path of the file storing the table with the given
+  /// key and number of values.
+  std::string path(const TableKey &key, std::size_t size) const;
+
+  /// On host: returns the table with the given key and number of values,
+  /// mapping it from its cache file if a valid one exists, and otherwise
+  /// calling the given generator to fill it in and storing it in the cache.
+  /// Failure to store a table isn't an error, since the table can always be
+  /// regenerated.
+  /// @param [in] key The key identifying the table
+  /// @param [in] size The number of values in the table
+  /// @param [in] generate A function that fills in the given array of size
+  ///                      values
+  std::shared_ptr<const CachedTable>
+  table(const TableKey &key, std::size_t size,
+        const std::function<void(Real *values)> &generate);
+
+  /// On host: returns a device view holding a copy of the table with the
+  /// given key and number of values, obtained as described for table. The
+  /// caller owns the view, which is recorded with Haero's memory registry (as
+  /// "tables") in the given tracker.
+  /// @param [in] key The key identifying the table
+  /// @param [in] size The number of values in the table
+  /// @param [in] generate A function that fills in the given array of size
+  ///                      values
+  /// @param [in] tracker The caller's tracker, which holds the view's record
+  /// @param [in] owner The part of Haero (or the host) that owns the view
+  DeviceType::view_1d<Real>
+  device_table(const TableKey &key, std::size_t size,
+               const std::function<void(Real *values)> &generate,
+               memory::ViewTracker &tracker, const std::string &owner);
+
+  /// On host: returns the number of tables read from cache files.
+  int num_hits() const { return num_hits_; }
+
+  /// On host: returns the number of tables generated because they had no
+  /// cache file (or the cache is disabled).
+  int num_misses() const { return num_misses_; }
+
+  /// On host: returns the number of cache files rejected because they were
+  /// corrupted or didn't match their keys.
+  int num_rejected() const { return num_rejected_; }
+
+private:
+  std::string directory_;
+  int num_hits_ = 0, num_misses_ = 0, num_rejected_ = 0;
+};
+
+} // namespace haero
+
+#endif
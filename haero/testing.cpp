@@ -3,6 +3,9 @@
 // SPDX-License-Identifier: BSD-3-Clause
 
 #include "testing.hpp"
+#include "first_touch.hpp"
+#include "memory.hpp"
+#include "thread_binding.hpp"
 
 #include <ekat/ekat_session.hpp>
 
@@ -14,31 +17,47 @@ using Real = haero::Real;
 
 // A simple memory allocation pool for standalone ColumnViews to be used in
 // (e.g.) unit tests. A ColumnPool manages a number of ColumnViews with a fixed
-// number of vertical levels.
+// number of vertical levels. Columns are allocated in contiguous blocks, which
+// are zeroed with one thread team per column so that each column's pages are
+// placed near the threads that work on it (see FirstTouch).
 class ColumnPool {
   size_t num_levels_;          // number of vertical levels per column (fixed)
   size_t num_cols_;            // number of allocated columns
   std::vector<int> col_used_;  // columns that are being used already
   std::vector<Real *> memory_; // per-column memory itself (allocated on device)
+  std::vector<Real *> blocks_; // blocks of columns (allocated on device)
+
+  // allocates a block of the given number of columns, appending them to the
+  // pool
+  void allocate_block(size_t num_cols) {
+    Real *block = reinterpret_cast<Real *>(
+        memory::allocate("ColumnPool", "haero::testing",
+                         sizeof(Real) * num_levels_ * num_cols));
+    first_touch_columns(
+        ekat::Unmanaged<DeviceType::view_2d<Real>>(block, num_cols,
+                                                   num_levels_));
+    blocks_.push_back(block);
+    for (size_t i = 0; i < num_cols; ++i) {
+      memory_.push_back(block + i * num_levels_);
+      col_used_.push_back(0);
+    }
+    num_cols_ += num_cols;
+  }
+
 public:
   // constructs a column pool with the given initial number of columns, each
   // with the given number of vertical levels.`
   ColumnPool(size_t num_vertical_levels, size_t initial_num_columns = 64)
-      : num_levels_(num_vertical_levels), num_cols_(initial_num_columns),
-        col_used_(initial_num_columns, 0),
-        memory_(initial_num_columns, nullptr) {
-    for (size_t i = 0; i < num_cols_; ++i) {
-      memory_[i] = reinterpret_cast<Real *>(Kokkos::kokkos_malloc(
-          "Column pool", sizeof(Real) * num_vertical_levels));
-    }
+      : num_levels_(num_vertical_levels), num_cols_(0) {
+    allocate_block(initial_num_columns);
   }
 
   // no copying of the pool
 
   // destructor
   ~ColumnPool() {
-    for (size_t i = 0; i < num_cols_; ++i) {
-      Kokkos::kokkos_free(memory_[i]);
+    for (Real *block : blocks_) {
+      memory::deallocate(block);
     }
   }
 
@@ -53,14 +72,7 @@ public:
     }
     if (i == num_cols_) { // all columns in the pool are in use!
       // double the number of allocated columns in the pool
-      size_t new_num_cols = 2 * num_cols_;
-      col_used_.resize(new_num_cols, 0);
-      memory_.resize(new_num_cols, nullptr);
-      for (size_t i = num_cols_; i < new_num_cols; ++i) {
-        memory_[i] = reinterpret_cast<Real *>(
-            Kokkos::kokkos_malloc(sizeof(Real) * num_levels_));
-      }
-      num_cols_ = new_num_cols;
+      allocate_block(num_cols_);
     }
 
     col_used_[i] = 1;
@@ -122,16 +134,20 @@ Surface create_surface() { return Surface(); }
 // default implementations.
 //------------------------------------------------------------------------
 
-// This implementation of ekat_initialize_test_session is identical to the
-// default provided by EKAT.
+// This implementation of ekat_initialize_test_session calls the default
+// provided by EKAT, and then reports or validates host thread bindings if
+// requested by the HAERO_THREAD_BINDING environment variable.
 void ekat_initialize_test_session(int argc, char **argv,
                                   const bool print_config) {
   ekat::initialize_ekat_session(argc, argv, print_config);
+  haero::check_thread_bindings();
 }
 
 // This implementation of ekat_finalize_test_session calls
-// haero::testing::finalize() to deallocate all ColumnView pools.
+// haero::testing::finalize() to deallocate all ColumnView pools, and then
+// haero::memory::finalize() to report Haero's memory usage (if requested).
 void ekat_finalize_test_session() {
   haero::testing::finalize();
+  haero::memory::finalize();
   ekat::finalize_ekat_session();
 }
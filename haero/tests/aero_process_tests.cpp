@@ -0,0 +1,134 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/aero_process.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "process_tests.hpp"
+
+using namespace haero;
+using namespace haero::testing;
+
+TEST_CASE("aero_process_metadata", "") {
+  TestAeroConfig aero_config{2};
+  DecayProcess::Config decay_config;
+  decay_config.rate = 3e-3;
+  AeroProcess<TestAeroConfig, DecayProcess> decay(aero_config, decay_config);
+  AeroProcess<TestAeroConfig, SourceProcess> source(aero_config);
+
+  // names and configurations live on the host, identified by the process id
+  REQUIRE(decay.id() != source.id());
+  REQUIRE(decay.name() == "decay");
+  REQUIRE(source.name() == "source");
+  REQUIRE(decay.process_config().rate == decay_config.rate);
+
+  // copies share metadata
+  AeroProcess<TestAeroConfig, DecayProcess> copy(decay);
+  REQUIRE(copy.id() == decay.id());
+  REQUIRE(copy.name() == "decay");
+
+  // re-initialization gives a process new metadata, and copies keep the
+  // configuration that matches their implementations, registered as long as
+  // something that holds them (a ProcessGroup, say) refers to it
+  ProcessReferences copy_references;
+  copy_references.add(copy.id());
+  const Real old_rate = decay_config.rate;
+  decay_config.rate = 4e-3;
+  decay.init(decay_config);
+  REQUIRE(decay.id() != copy.id());
+  REQUIRE(decay.name() == "decay");
+  REQUIRE(decay.process_config().rate == decay_config.rate);
+  REQUIRE(copy.process_config().rate == old_rate);
+
+  // metadata is released with the process that registered it (copies hold
+  // no references to it), and its id is reused
+  int id;
+  {
+    AeroProcess<TestAeroConfig, DecayProcess> temp(aero_config);
+    id = temp.id();
+    {
+      AeroProcess<TestAeroConfig, DecayProcess> temp_copy(temp);
+    }
+    REQUIRE(registered_process_name(id) == "decay");
+  }
+  REQUIRE_THROWS(registered_process_name(id));
+  AeroProcess<TestAeroConfig, SourceProcess> reused(aero_config);
+  REQUIRE(reused.id() == id);
+  REQUIRE(reused.name() == "source");
+
+  // moves transfer the reference, and a ProcessReferences (and its copies)
+  // keeps metadata registered after its process is gone
+  {
+    ProcessReferences outer;
+    {
+      AeroProcess<TestAeroConfig, DecayProcess> temp(aero_config);
+      AeroProcess<TestAeroConfig, DecayProcess> moved(std::move(temp));
+      id = moved.id();
+      ProcessReferences references;
+      references.add(id);
+      outer = references;
+    }
+    REQUIRE(registered_process_name(id) == "decay");
+  }
+  REQUIRE_THROWS(registered_process_name(id));
+
+  // copies of a re-initialized copy keep their new metadata registered
+  {
+    AeroProcess<TestAeroConfig, DecayProcess> copy_of_copy(copy);
+    copy_of_copy.init(decay_config);
+    REQUIRE(copy_of_copy.id() != copy.id());
+    REQUIRE(copy_of_copy.process_config().rate == decay_config.rate);
+  }
+  REQUIRE(copy.process_config().rate == old_rate);
+
+  // processes carry only an id and device-needed state (the aerosol
+  // configuration and the implementation) into kernels
+  REQUIRE(sizeof(decay) <= 2 * sizeof(int) + sizeof(TestAeroConfig) +
+                               sizeof(DecayProcess) + alignof(DecayProcess));
+
+  REQUIRE_THROWS(registered_process_name(-1));
+}
+
+TEST_CASE("aero_process_incremental_init", "") {
+  TestAeroConfig aero_config{1};
+  const int initial_builds = TabulatedProcess::num_table_builds;
+  AeroProcess<TestAeroConfig, TabulatedProcess> process(aero_config);
+  static_assert(HasIncrementalInit<TestAeroConfig, TabulatedProcess>::value,
+                "TabulatedProcess supports incremental initialization!");
+  static_assert(!HasIncrementalInit<TestAeroConfig, DecayProcess>::value,
+                "DecayProcess doesn't support incremental initialization!");
+
+  // returns the number of times the process has built its table
+  auto num_builds = [&]() {
+    return TabulatedProcess::num_table_builds - initial_builds;
+  };
+  REQUIRE(num_builds() == 1);
+
+  // changing a field that the table doesn't depend on doesn't rebuild it
+  auto config = process.process_config();
+  for (int i = 0; i < 10; ++i) {
+    config.factor = 1e-3 * (i + 1);
+    process.init(config);
+  }
+  REQUIRE(num_builds() == 1);
+  REQUIRE(process.process_config().factor == config.factor);
+
+  // changing a field that the table depends on does
+  config.num_bins = 32;
+  process.init(config);
+  REQUIRE(num_builds() == 2);
+  config.scale = 2;
+  process.init(config);
+  REQUIRE(num_builds() == 3);
+  process.init(config);
+  REQUIRE(num_builds() == 3);
+
+  // config_changed compares the given fields only
+  TabulatedProcess::Config a, b;
+  b.factor = 2 * a.factor;
+  REQUIRE(!config_changed(a, b, &TabulatedProcess::Config::num_bins,
+                          &TabulatedProcess::Config::scale));
+  REQUIRE(config_changed(a, b, &TabulatedProcess::Config::factor));
+}
@@ -0,0 +1,140 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/change_detection.hpp>
+#include <haero/math.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+
+using namespace haero;
+
+namespace {
+
+// Updates the diagnostic r = (v * (1 + h))^(1/3) (a radius from a volume v
+// and a growth factor h) on every level whose inputs have changed.
+void update_radius(const ChangeDetector<2> &detector,
+                   const DeviceType::view_2d<Real> &volume,
+                   const DeviceType::view_2d<Real> &humidity,
+                   const DeviceType::view_2d<Real> &radius) {
+  const int num_cols = volume.extent(0), num_levels = volume.extent(1);
+  Kokkos::parallel_for(
+      ThreadTeamPolicy(num_cols, Kokkos::AUTO),
+      KOKKOS_LAMBDA(const ThreadTeam &team) {
+        const int col = team.league_rank();
+        Kokkos::parallel_for(
+            Kokkos::TeamThreadRange(team, num_levels), [&](const int k) {
+              const Real inputs[2] = {volume(col, k), humidity(col, k)};
+              if (detector.needs_update(col, k, inputs)) {
+                radius(col, k) =
+                    cbrt(volume(col, k) * (1 + humidity(col, k)));
+              }
+            });
+      });
+}
+
+} // namespace
+
+TEST_CASE("change_detection_skips", "") {
+  const int num_cols = 3, num_levels = 10;
+  const Real threshold = 1e-6;
+  ChangeDetector<2> detector(num_cols, num_levels, threshold);
+  REQUIRE(detector.rel_threshold() == threshold);
+  REQUIRE(detector.abs_threshold() == 0);
+  REQUIRE(detector.skip_fraction() == 0);
+  REQUIRE_THROWS(ChangeDetector<2>(num_cols, num_levels, -1));
+
+  DeviceType::view_2d<Real> volume("volume", num_cols, num_levels);
+  DeviceType::view_2d<Real> humidity("humidity", num_cols, num_levels);
+  DeviceType::view_2d<Real> radius("radius", num_cols, num_levels);
+  auto h_volume = Kokkos::create_mirror_view(volume);
+  auto h_humidity = Kokkos::create_mirror_view(humidity);
+  for (int col = 0; col < num_cols; ++col) {
+    for (int k = 0; k < num_levels; ++k) {
+      h_volume(col, k) = 1 + k;
+      h_humidity(col, k) = 0.5;
+    }
+  }
+  Kokkos::deep_copy(volume, h_volume);
+  Kokkos::deep_copy(humidity, h_humidity);
+
+  // every level is computed the first time
+  update_radius(detector, volume, humidity, radius);
+  REQUIRE(detector.num_checks() == num_cols * num_levels);
+  REQUIRE(detector.num_updates() == num_cols * num_levels);
+
+  // unchanged inputs and changes within the threshold are skipped, and
+  // larger changes in either input are recomputed
+  detector.reset_statistics();
+  update_radius(detector, volume, humidity, radius);
+  REQUIRE(detector.num_updates() == 0);
+  REQUIRE(detector.skip_fraction() == 1);
+  for (int col = 0; col < num_cols; ++col) {
+    h_volume(col, 0) *= 1 + 0.5 * threshold;
+    h_volume(col, 1) *= 1 + 10 * threshold;
+    h_humidity(col, 2) *= 1 - 10 * threshold;
+  }
+  Kokkos::deep_copy(volume, h_volume);
+  Kokkos::deep_copy(humidity, h_humidity);
+  update_radius(detector, volume, humidity, radius);
+  REQUIRE(detector.num_checks() == 2 * num_cols * num_levels);
+  REQUIRE(detector.num_updates() == 2 * num_cols);
+  REQUIRE(detector.skip_fraction() == Approx(1 - 0.1));
+
+  // invalidation recomputes every level
+  detector.invalidate();
+  detector.reset_statistics();
+  update_radius(detector, volume, humidity, radius);
+  REQUIRE(detector.num_updates() == num_cols * num_levels);
+
+  // an absolute threshold lets inputs near zero be reused
+  ChangeDetector<2> abs_detector(num_cols, num_levels, threshold, 1e-12);
+  Kokkos::deep_copy(humidity, 0);
+  update_radius(abs_detector, volume, humidity, radius);
+  Kokkos::deep_copy(humidity, 1e-13);
+  update_radius(abs_detector, volume, humidity, radius);
+  REQUIRE(abs_detector.num_updates() == num_cols * num_levels);
+}
+
+TEST_CASE("change_detection_error_bound", "") {
+  // inputs drift by less than the threshold in every step, but reused
+  // diagnostics stay within the error implied by the threshold: relative
+  // changes of at most r in v and h change v (1 + h) by a relative amount of
+  // at most about 2r, and hence the radius by at most about 2r/3
+  const int num_cols = 4, num_levels = 16, num_steps = 200;
+  const Real threshold = 1e-4;
+  ChangeDetector<2> detector(num_cols, num_levels, threshold);
+  DeviceType::view_2d<Real> volume("volume", num_cols, num_levels);
+  DeviceType::view_2d<Real> humidity("humidity", num_cols, num_levels);
+  DeviceType::view_2d<Real> radius("radius", num_cols, num_levels);
+  auto h_volume = Kokkos::create_mirror_view(volume);
+  auto h_humidity = Kokkos::create_mirror_view(humidity);
+  auto h_radius = Kokkos::create_mirror_view(radius);
+  const Real bound = cbrt((1 + threshold) * (1 + threshold)) - 1;
+  for (int step = 0; step < num_steps; ++step) {
+    for (int col = 0; col < num_cols; ++col) {
+      for (int k = 0; k < num_levels; ++k) {
+        // upper levels (small k) barely change, lower ones drift faster
+        const Real rate = 1e-7 * (1 + k * k) * (1 + col);
+        h_volume(col, k) = (1 + k) * std::exp(rate * step);
+        h_humidity(col, k) = 0.5 + 0.5 * std::sin(rate * step);
+      }
+    }
+    Kokkos::deep_copy(volume, h_volume);
+    Kokkos::deep_copy(humidity, h_humidity);
+    update_radius(detector, volume, humidity, radius);
+    Kokkos::deep_copy(h_radius, radius);
+    for (int col = 0; col < num_cols; ++col) {
+      for (int k = 0; k < num_levels; ++k) {
+        const Real exact =
+            std::cbrt(h_volume(col, k) * (1 + h_humidity(col, k)));
+        const Real error = std::abs(h_radius(col, k) - exact) / exact;
+        REQUIRE(error <= bound * (1 + 1e-3) + 4 * epsilon());
+      }
+    }
+  }
+  // most checks are skipped
+  REQUIRE(detector.skip_fraction() > 0.5);
+}
@@ -0,0 +1,223 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/column_batches.hpp>
+#include <haero/process_group.hpp>
+
+#include "process_tests.hpp"
+
+#include <catch2/catch.hpp>
+
+using namespace haero;
+using namespace haero::testing;
+
+namespace {
+
+// A ColumnState whose "columns" are the batches of an AtmosphereSet.
+struct BatchState {
+  TracersView tracers;
+  AtmosphereSet atmospheres;
+  Surface sfc;
+
+  KOKKOS_INLINE_FUNCTION
+  Atmosphere atmosphere(const int batch) const {
+    return atmospheres.atmosphere(batch);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  Surface surface(const int batch) const { return sfc; }
+
+  KOKKOS_INLINE_FUNCTION
+  ColumnTracers prognostics(const int batch) const {
+    return ColumnTracers(tracers, batch);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  NoDiagnostics diagnostics(const int batch) const { return NoDiagnostics(); }
+
+  KOKKOS_INLINE_FUNCTION
+  ColumnTracers tendencies(const TracersView &buffer, const int batch) const {
+    return ColumnTracers(buffer, batch);
+  }
+};
+
+// Returns tracers that vary by tracer, column, and level.
+TracersView create_tracers(int num_tracers, int num_columns, int num_levels) {
+  TracersView tracers("tracers", num_tracers, num_columns, num_levels);
+  auto h_tracers = Kokkos::create_mirror_view(tracers);
+  for (int q = 0; q < num_tracers; ++q) {
+    for (int col = 0; col < num_columns; ++col) {
+      for (int k = 0; k < num_levels; ++k) {
+        h_tracers(q, col, k) = 1 + q + 0.1 * col + 0.01 * k;
+      }
+    }
+  }
+  Kokkos::deep_copy(tracers, h_tracers);
+  return tracers;
+}
+
+// Returns an AtmosphereSet for the given batches, with temperatures that vary
+// by column and level, and boundary layer heights that vary by batch.
+AtmosphereSet create_atmospheres(const ColumnBatches &batches) {
+  AtmosphereSet atmospheres(batches);
+  const int num_levels = batches.num_levels();
+  for (int col = 0; col < batches.num_columns(); ++col) {
+    auto atm =
+        create_atmosphere(num_levels, 100.0 * (batches.batch(col) + 1));
+    // the testing column pool owns the (mutable) atmospheric data
+    ColumnView temperature(const_cast<Real *>(atm.temperature.data()),
+                           num_levels);
+    auto h_temperature = Kokkos::create_mirror_view(temperature);
+    for (int k = 0; k < num_levels; ++k) {
+      h_temperature(k) = 250 + col + 5 * k;
+    }
+    Kokkos::deep_copy(temperature, h_temperature);
+    atmospheres.set_column(col, atm);
+  }
+  return atmospheres;
+}
+
+} // namespace
+
+TEST_CASE("column_batches_layout", "") {
+  // level-innermost batches are columns
+  ColumnBatches columns(10, 3);
+  REQUIRE(columns.batch_size() == 1);
+  REQUIRE(columns.num_batches() == 10);
+  REQUIRE(columns.batch_levels() == 3);
+  REQUIRE(columns.batch(7) == 7);
+  REQUIRE(columns.batch_level(7, 2) == 2);
+  REQUIRE_THROWS(ColumnBatches(10, 3, ColumnLayout::level_innermost, 4));
+
+  // column-innermost batches interleave columns at each level
+  ColumnBatches batches(10, 3, ColumnLayout::column_innermost, 4);
+  REQUIRE(batches.num_batches() == 3);
+  REQUIRE(batches.batch_levels() == 12);
+  REQUIRE(batches.batch(7) == 1);
+  REQUIRE(batches.batch_level(7, 2) == 2 * 4 + 3);
+
+  // default batches hold whole Packs of columns, and enough of them to fill
+  // min_batch_levels levels (if there are enough columns)
+  ColumnBatches parcels(1000, 1, ColumnLayout::column_innermost);
+  REQUIRE(parcels.batch_size() % HAERO_PACK_SIZE == 0);
+  REQUIRE(parcels.batch_levels() >= ColumnBatches::min_batch_levels);
+  REQUIRE(parcels.batch_levels() <
+          ColumnBatches::min_batch_levels + HAERO_PACK_SIZE);
+  ColumnBatches few(3, 1, ColumnLayout::column_innermost);
+  REQUIRE(few.num_batches() == 1);
+  REQUIRE(few.batch_size() == PackInfo::num_packs(3) * HAERO_PACK_SIZE);
+
+  // tracers survive a round trip, and padding copies the last column
+  const int num_tracers = 2;
+  auto tracers = create_tracers(num_tracers, 10, 3);
+  memory::ViewTracker tracker;
+  auto batched = batches.create_tracers("batched", num_tracers, tracker,
+                                        "column_batches_tests");
+  REQUIRE(memory::is_tracked(batched.data()));
+  batches.gather_tracers(tracers, batched);
+  auto h_tracers = Kokkos::create_mirror_view(tracers);
+  Kokkos::deep_copy(h_tracers, tracers);
+  auto h_batched = Kokkos::create_mirror_view(batched);
+  Kokkos::deep_copy(h_batched, batched);
+  for (int q = 0; q < num_tracers; ++q) {
+    for (int k = 0; k < 3; ++k) {
+      for (int col = 0; col < 12; ++col) {
+        const int src = (col < 10) ? col : 9;
+        REQUIRE(h_batched(q, batches.batch(col), batches.batch_level(col, k)) ==
+                h_tracers(q, src, k));
+      }
+    }
+  }
+  TracersView unbatched("unbatched", num_tracers, 10, 3);
+  batches.scatter_tracers(batched, unbatched);
+  auto h_unbatched = Kokkos::create_mirror_view(unbatched);
+  Kokkos::deep_copy(h_unbatched, unbatched);
+  for (int q = 0; q < num_tracers; ++q) {
+    for (int col = 0; col < 10; ++col) {
+      for (int k = 0; k < 3; ++k) {
+        REQUIRE(h_unbatched(q, col, k) == h_tracers(q, col, k));
+      }
+    }
+  }
+}
+
+TEST_CASE("atmosphere_set", "") {
+  ColumnBatches batches(10, 3, ColumnLayout::column_innermost, 4);
+  auto atmospheres = create_atmospheres(batches);
+  REQUIRE_THROWS(atmospheres.set_column(10, create_atmosphere(3, 0.0)));
+  REQUIRE_THROWS(atmospheres.set_column(0, create_atmosphere(4, 0.0)));
+  // the columns of a batch must share a boundary layer height
+  REQUIRE_THROWS(atmospheres.set_column(5, create_atmosphere(3, 150.0)));
+  AtmosphereSet single(batches);
+  single.set_column(5, create_atmosphere(3, 150.0));
+  single.set_column(5, create_atmosphere(3, 250.0));
+  single.set_column(6, create_atmosphere(3, 250.0));
+  REQUIRE_THROWS(single.set_column(4, create_atmosphere(3, 150.0)));
+
+  for (int b = 0; b < batches.num_batches(); ++b) {
+    const Atmosphere atm = atmospheres.atmosphere(b);
+    REQUIRE(atm.num_levels() == batches.batch_levels());
+    REQUIRE(atm.planetary_boundary_layer_height == 100.0 * (b + 1));
+    DeviceType::view_1d<Real> temperature("temperature", atm.num_levels());
+    Kokkos::deep_copy(temperature, atm.temperature);
+    auto h_temperature = Kokkos::create_mirror_view(temperature);
+    Kokkos::deep_copy(h_temperature, temperature);
+    for (int c = 0; c < batches.batch_size(); ++c) {
+      // padding copies the last column
+      const int col = (4 * b + c < 10) ? 4 * b + c : 9;
+      for (int k = 0; k < 3; ++k) {
+        REQUIRE(h_temperature(batches.batch_level(c, k)) == 250 + col + 5 * k);
+      }
+    }
+  }
+}
+
+TEST_CASE("column_innermost_processes", "") {
+  // shallow columns run the same processes in either layout
+  const int num_tracers = 3, num_columns = 21;
+  const Real t = 0, dt = 10;
+  using Group = ProcessGroup<TestAeroConfig, DecayProcess, SourceProcess,
+                             ExchangeProcess>;
+  TestAeroConfig config{num_tracers};
+  AeroProcess<TestAeroConfig, DecayProcess> decay(config);
+  AeroProcess<TestAeroConfig, SourceProcess> source(config);
+  AeroProcess<TestAeroConfig, ExchangeProcess> exchange(config);
+
+  for (int num_levels : {1, 2, 5}) {
+    auto tracers = create_tracers(num_tracers, num_columns, num_levels);
+
+    // level-innermost reference
+    ColumnBatches columns(num_columns, num_levels);
+    BatchState ref_state{create_tracers(num_tracers, num_columns, num_levels),
+                         create_atmospheres(columns), create_surface()};
+    Group ref_group(num_tracers, columns.num_batches(), columns.batch_levels(),
+                    decay, source, exchange);
+    ref_group.advance(t, dt, ref_state);
+
+    // column-innermost batches
+    ColumnBatches batches(num_columns, num_levels,
+                          ColumnLayout::column_innermost);
+    memory::ViewTracker tracker;
+    BatchState state{batches.create_tracers("batched", num_tracers, tracker,
+                                            "column_batches_tests"),
+                     create_atmospheres(batches), create_surface()};
+    batches.gather_tracers(tracers, state.tracers);
+    Group group(num_tracers, batches.num_batches(), batches.batch_levels(),
+                decay, source, exchange);
+    group.advance(t, dt, state);
+    batches.scatter_tracers(state.tracers, tracers);
+
+    auto h_ref = Kokkos::create_mirror_view(ref_state.tracers);
+    Kokkos::deep_copy(h_ref, ref_state.tracers);
+    auto h_tracers = Kokkos::create_mirror_view(tracers);
+    Kokkos::deep_copy(h_tracers, tracers);
+    for (int q = 0; q < num_tracers; ++q) {
+      for (int col = 0; col < num_columns; ++col) {
+        for (int k = 0; k < num_levels; ++k) {
+          REQUIRE(h_tracers(q, col, k) == h_ref(q, col, k));
+        }
+      }
+    }
+  }
+}
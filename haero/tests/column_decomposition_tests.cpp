@@ -0,0 +1,120 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/column_decomposition.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+using namespace haero;
+
+// These tests run on any number of MPI ranks (including 1).
+
+TEST_CASE("column_decomposition_partition", "") {
+  for (int num_cols : {0, 1, 2, 3, 17, 64, 1000}) {
+    ColumnDecomposition decomp(num_cols);
+    REQUIRE(decomp.num_global_columns() == num_cols);
+
+    // the ranks' column ranges tile [0, num_cols) in order, and their sizes
+    // differ by at most one
+    int next_col = 0;
+    for (int r = 0; r < decomp.num_ranks(); ++r) {
+      REQUIRE(decomp.first_column(r) == next_col);
+      const int n = decomp.num_local_columns(r);
+      REQUIRE(n >= num_cols / decomp.num_ranks());
+      REQUIRE(n <= num_cols / decomp.num_ranks() + 1);
+      for (int col = next_col; col < next_col + n; ++col) {
+        REQUIRE(decomp.owner(col) == r);
+      }
+      next_col += n;
+    }
+    REQUIRE(next_col == num_cols);
+
+    REQUIRE(decomp.global_column(0) == decomp.first_column());
+    REQUIRE(decomp.global_sum(Real(decomp.num_local_columns())) ==
+            Real(num_cols));
+  }
+}
+
+TEST_CASE("column_decomposition_local_views", "") {
+  const int num_cols = 37, num_tracers = 5, num_levels = 72;
+  ColumnDecomposition decomp(num_cols);
+
+  memory::ViewTracker tracker;
+  auto tracers = decomp.create_tracers("tracers", num_tracers, num_levels,
+                                       tracker, "column_decomposition_tests");
+  REQUIRE(tracers.extent(0) == num_tracers);
+  REQUIRE(static_cast<int>(tracers.extent(1)) == decomp.num_local_columns());
+  REQUIRE(tracers.extent(2) == num_levels);
+
+  auto temperature = decomp.create_column_field(
+      "temperature", num_levels, tracker, "column_decomposition_tests");
+  REQUIRE(memory::is_tracked(tracers.data()));
+  REQUIRE(memory::is_tracked(temperature.data()));
+  REQUIRE(static_cast<int>(temperature.extent(0)) ==
+          decomp.num_local_columns());
+  REQUIRE(temperature.extent(1) == num_levels);
+}
+
+TEST_CASE("column_decomposition_reductions", "") {
+  ColumnDecomposition decomp(100);
+  const int n = decomp.num_ranks();
+  const Real rank = decomp.rank();
+
+  REQUIRE(decomp.global_sum(rank) == Real(n * (n - 1) / 2));
+  REQUIRE(decomp.global_min(rank) == 0);
+  REQUIRE(decomp.global_max(rank) == Real(n - 1));
+
+  std::vector<Real> values = {rank, 1, -rank};
+  decomp.global_sum(values);
+  REQUIRE(values[0] == Real(n * (n - 1) / 2));
+  REQUIRE(values[1] == Real(n));
+  REQUIRE(values[2] == -Real(n * (n - 1) / 2));
+
+  values = {rank, -rank};
+  decomp.global_min(values);
+  REQUIRE(values[0] == 0);
+  REQUIRE(values[1] == -Real(n - 1));
+
+  values = {rank, -rank};
+  decomp.global_max(values);
+  REQUIRE(values[0] == Real(n - 1));
+  REQUIRE(values[1] == 0);
+}
+
+TEST_CASE("column_decomposition_gather", "") {
+  for (int num_cols : {1, 7, 50}) {
+    ColumnDecomposition decomp(num_cols);
+    const int num_local = decomp.num_local_columns(), num_fields = 3;
+
+    // each row holds the global column index and the owning rank
+    HostType::view_2d<Real> local("local", num_local, num_fields);
+    HostType::view_1d<Real> local_1d("local_1d", num_local);
+    for (int i = 0; i < num_local; ++i) {
+      local(i, 0) = decomp.global_column(i);
+      local(i, 1) = decomp.rank();
+      local(i, 2) = -decomp.global_column(i);
+      local_1d(i) = 10 * decomp.global_column(i);
+    }
+
+    auto global = decomp.gather(local);
+    auto global_1d = decomp.gather(local_1d);
+    if (decomp.is_root()) {
+      REQUIRE(static_cast<int>(global.extent(0)) == num_cols);
+      REQUIRE(static_cast<int>(global.extent(1)) == num_fields);
+      REQUIRE(static_cast<int>(global_1d.extent(0)) == num_cols);
+      for (int col = 0; col < num_cols; ++col) {
+        REQUIRE(global(col, 0) == Real(col));
+        REQUIRE(global(col, 1) == Real(decomp.owner(col)));
+        REQUIRE(global(col, 2) == Real(-col));
+        REQUIRE(global_1d(col) == Real(10 * col));
+      }
+    } else {
+      REQUIRE(global.extent(0) == 0);
+      REQUIRE(global_1d.extent(0) == 0);
+    }
+    decomp.barrier();
+  }
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/column_integrals.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <limits>
+
+using namespace haero;
+
+TEST_CASE("column_burdens", "") {
+  // use a number of tracers that spans several passes and a partial pack
+  const int ntracers = ColumnIntegrals::packs_per_pass * HAERO_PACK_SIZE + 5;
+  const int ncols = 3;
+  const int nlev = 72;
+
+  TracersView tracers("tracers", ntracers, ncols, nlev);
+  DeviceType::view_2d<Real> dp("hydrostatic_dp", ncols, nlev);
+  auto h_tracers = Kokkos::create_mirror_view(tracers);
+  auto h_dp = Kokkos::create_mirror_view(dp);
+  for (int icol = 0; icol < ncols; ++icol) {
+    for (int k = 0; k < nlev; ++k) {
+      h_dp(icol, k) = 500 + 10 * k + icol;
+      for (int i = 0; i < ntracers; ++i) {
+        h_tracers(i, icol, k) = 1e-9 * (i + 1) * (k + 1) + 1e-12 * icol;
+      }
+    }
+  }
+  Kokkos::deep_copy(tracers, h_tracers);
+  Kokkos::deep_copy(dp, h_dp);
+
+  for (bool compensated : {false, true}) {
+    DeviceType::view_2d<Real> burdens("burdens", ncols, ntracers);
+    compute_column_burdens(tracers, dp, burdens, compensated);
+    auto h_burdens = Kokkos::create_mirror_view(burdens);
+    Kokkos::deep_copy(h_burdens, burdens);
+
+    for (int icol = 0; icol < ncols; ++icol) {
+      for (int i = 0; i < ntracers; ++i) {
+        double ref = 0;
+        for (int k = 0; k < nlev; ++k) {
+          ref += double(h_tracers(i, icol, k)) * h_dp(icol, k);
+        }
+        ref /= Constants::gravity;
+        REQUIRE(h_burdens(icol, i) == Approx(ref));
+      }
+    }
+  }
+
+#ifndef HAERO_ENABLE_GPU
+  // the opt-in SIMD kernels agree with the default kernels to round-off
+  DeviceType::view_2d<Real> burdens("burdens", ncols, ntracers);
+  DeviceType::view_2d<Real> simd_burdens("simd_burdens", ncols, ntracers);
+  compute_column_burdens(tracers, dp, burdens);
+  compute_column_burdens_simd(tracers, dp, simd_burdens);
+  auto h_burdens = Kokkos::create_mirror_view(burdens);
+  auto h_simd_burdens = Kokkos::create_mirror_view(simd_burdens);
+  Kokkos::deep_copy(h_burdens, burdens);
+  Kokkos::deep_copy(h_simd_burdens, simd_burdens);
+  const Real tol = 2 * nlev * std::numeric_limits<Real>::epsilon();
+  for (int icol = 0; icol < ncols; ++icol) {
+    for (int i = 0; i < ntracers; ++i) {
+      REQUIRE(std::abs(h_simd_burdens(icol, i) - h_burdens(icol, i)) <=
+              tol * std::abs(h_burdens(icol, i)));
+    }
+  }
+
+  REQUIRE_THROWS(compute_column_burdens_simd(
+      tracers, dp, DeviceType::view_2d<Real>("burdens", ncols + 1, ntracers)));
+#endif
+}
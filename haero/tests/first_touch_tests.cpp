@@ -0,0 +1,93 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/first_touch.hpp>
+#include <haero/testing.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace haero;
+
+namespace {
+
+// Fills the given view with nonzero values.
+template <typename ViewType> void fill(const ViewType &view) {
+  Kokkos::deep_copy(view, 1);
+}
+
+} // namespace
+
+TEST_CASE("first_touch_tracers", "") {
+  const int num_tracers = 4, num_cols = 13, num_levels = 72;
+  memory::ViewTracker tracker;
+  auto tracers = create_tracers("tracers", num_tracers, num_cols, num_levels,
+                                tracker, "first_touch_tests");
+  REQUIRE(tracers.extent(0) == num_tracers);
+  REQUIRE(tracers.extent(1) == num_cols);
+  REQUIRE(tracers.extent(2) == num_levels);
+
+  // the view is zeroed on creation, and can be zeroed again with a
+  // compute kernel's policy
+  for (int pass = 0; pass < 2; ++pass) {
+    auto h_tracers = Kokkos::create_mirror_view(tracers);
+    Kokkos::deep_copy(h_tracers, tracers);
+    for (int i = 0; i < num_tracers; ++i) {
+      for (int col = 0; col < num_cols; ++col) {
+        for (int k = 0; k < num_levels; ++k) {
+          REQUIRE(h_tracers(i, col, k) == 0);
+        }
+      }
+    }
+    fill(tracers);
+    first_touch_tracers(tracers, ThreadTeamPolicy(num_cols, 1));
+  }
+
+  // the policy must have one team per column
+  REQUIRE_THROWS(first_touch_tracers(tracers, column_policy(num_cols + 1)));
+
+  // the view is recorded with the memory registry until the caller's tracker
+  // releases it
+  const std::string space = TracersView::memory_space::name();
+  REQUIRE(memory::is_tracked(tracers.data()));
+  REQUIRE(memory::usage_by_category(space)["tracers"]["first_touch_tests"]
+              .current_bytes == tracers.span() * sizeof(Real));
+  tracker.untrack(tracers);
+  REQUIRE(!memory::is_tracked(tracers.data()));
+}
+
+TEST_CASE("first_touch_columns", "") {
+  const int num_cols = 7, num_levels = 20;
+  memory::ViewTracker tracker;
+  auto data = create_column_field("data", num_cols, num_levels, tracker,
+                                  "first_touch_tests");
+  REQUIRE(memory::is_tracked(data.data()));
+  REQUIRE(data.extent(0) == num_cols);
+  REQUIRE(data.extent(1) == num_levels);
+
+  for (int pass = 0; pass < 2; ++pass) {
+    auto h_data = Kokkos::create_mirror_view(data);
+    Kokkos::deep_copy(h_data, data);
+    for (int col = 0; col < num_cols; ++col) {
+      for (int k = 0; k < num_levels; ++k) {
+        REQUIRE(h_data(col, k) == 0);
+      }
+    }
+    fill(data);
+    first_touch_columns(data, column_policy(num_cols));
+  }
+}
+
+TEST_CASE("first_touch_column_pool", "") {
+  // columns from the testing pool are zeroed, including those in blocks
+  // allocated when the pool grows
+  const int num_levels = 17;
+  for (int c = 0; c < 200; ++c) {
+    auto column = testing::create_column_view(num_levels);
+    auto h_column = Kokkos::create_mirror_view(column);
+    Kokkos::deep_copy(h_column, column);
+    for (int k = 0; k < num_levels; ++k) {
+      REQUIRE(h_column(k) == 0);
+    }
+  }
+}
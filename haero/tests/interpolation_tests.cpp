@@ -0,0 +1,236 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/interpolation.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace haero;
+
+namespace {
+
+// Returns the tolerance for comparing interpolated values.
+Real tolerance() { return std::is_same<Real, float>::value ? 1e-4 : 1e-11; }
+
+// Fills a device view of grid coordinates, indexed by column and point, with
+// the given function of the column and point.
+template <typename F>
+DeviceType::view_2d<Real> create_grids(int ncols, int npts, F coord) {
+  DeviceType::view_2d<Real> grids("grids", ncols, npts);
+  auto h_grids = Kokkos::create_mirror_view(grids);
+  for (int col = 0; col < ncols; ++col) {
+    for (int i = 0; i < npts; ++i) {
+      h_grids(col, i) = coord(col, i);
+    }
+  }
+  Kokkos::deep_copy(grids, h_grids);
+  return grids;
+}
+
+// Fills a device view of field values, indexed by field, column, and level,
+// with the given function of the field, column, and level.
+template <typename F>
+DeviceType::view_3d<Real> create_fields(int nfields, int ncols, int nlev,
+                                        F value) {
+  DeviceType::view_3d<Real> fields("fields", nfields, ncols, nlev);
+  auto h_fields = Kokkos::create_mirror_view(fields);
+  for (int f = 0; f < nfields; ++f) {
+    for (int col = 0; col < ncols; ++col) {
+      for (int k = 0; k < nlev; ++k) {
+        h_fields(f, col, k) = value(f, col, k);
+      }
+    }
+  }
+  Kokkos::deep_copy(fields, h_fields);
+  return fields;
+}
+
+} // namespace
+
+TEST_CASE("interpolation_linear", "") {
+  // source grids increase in some columns and decrease in others, and target
+  // grids extend past both ends of the source grids
+  const int ncols = 4, nsrc = 23, nlev = 40, nfields = 3;
+  auto src_x = create_grids(ncols, nsrc, [](int col, int i) {
+    const Real x = 100 * std::pow(Real(i) / (nsrc - 1), 1.5) + col;
+    return (col % 2) ? 100 + 2 * col - x : x;
+  });
+  auto tgt_x = create_grids(ncols, nlev, [](int col, int k) {
+    return -5 + 110 * Real(k) / (nlev - 1) + 0.1 * col;
+  });
+  auto h_src_x = Kokkos::create_mirror_view(src_x);
+  auto h_tgt_x = Kokkos::create_mirror_view(tgt_x);
+  Kokkos::deep_copy(h_src_x, src_x);
+  Kokkos::deep_copy(h_tgt_x, tgt_x);
+  // linear functions of the coordinate are reproduced exactly
+  auto f = [](int field, Real x) { return (field + 1) * x - 3 * field; };
+  auto src_values = create_fields(
+      nfields, ncols, nsrc,
+      [&](int i, int col, int k) { return f(i, h_src_x(col, k)); });
+  DeviceType::view_3d<Real> values("values", nfields, ncols, nlev);
+
+  ColumnInterpolator interp(ncols, nsrc, nlev);
+  REQUIRE(interp.mode() == InterpolationMode::linear);
+  REQUIRE(interp.num_points(nlev) == nlev);
+  interp.set_grids(src_x, tgt_x);
+  interp.interpolate(src_values, values);
+  auto h_values = Kokkos::create_mirror_view(values);
+  Kokkos::deep_copy(h_values, values);
+  for (int col = 0; col < ncols; ++col) {
+    const Real x_min = std::min(h_src_x(col, 0), h_src_x(col, nsrc - 1));
+    const Real x_max = std::max(h_src_x(col, 0), h_src_x(col, nsrc - 1));
+    for (int i = 0; i < nfields; ++i) {
+      for (int k = 0; k < nlev; ++k) {
+        // targets outside the source grid take the nearest source value
+        const Real x = std::min(std::max(h_tgt_x(col, k), x_min), x_max);
+        REQUIRE(std::abs(h_values(i, col, k) - f(i, x)) <=
+                tolerance() * 100 * (i + 1));
+      }
+    }
+  }
+
+  // invalid grids are rejected
+  auto bad_x = create_grids(ncols, nsrc, [](int col, int i) {
+    return (col == 2 && i == 5) ? Real(0) : Real(i);
+  });
+  REQUIRE_THROWS(interp.set_grids(bad_x, tgt_x));
+  REQUIRE_THROWS(ColumnInterpolator(ncols, 1, nlev));
+}
+
+TEST_CASE("interpolation_merge_search", "") {
+  // the merge-style search finds the same intervals as a binary search for
+  // irregular source grids and decreasing target grids
+  const int ncols = 16, nsrc = 57, nlev = 72;
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<Real> uniform(0.1, 1);
+  std::vector<Real> steps(ncols * nsrc);
+  for (Real &step : steps) {
+    step = uniform(gen);
+  }
+  auto src_x = create_grids(ncols, nsrc, [&](int col, int i) {
+    Real x = 0;
+    for (int j = 0; j <= i; ++j) {
+      x += steps[col * nsrc + j];
+    }
+    return x;
+  });
+  auto h_src_x = Kokkos::create_mirror_view(src_x);
+  Kokkos::deep_copy(h_src_x, src_x);
+  auto tgt_x = create_grids(ncols, nlev, [&](int col, int k) {
+    return h_src_x(col, nsrc - 1) * (nlev - k) / nlev;
+  });
+  auto h_tgt_x = Kokkos::create_mirror_view(tgt_x);
+  Kokkos::deep_copy(h_tgt_x, tgt_x);
+  auto src_values = create_fields(1, ncols, nsrc, [&](int, int col, int i) {
+    return std::sin(h_src_x(col, i));
+  });
+  DeviceType::view_3d<Real> values("values", 1, ncols, nlev);
+  ColumnInterpolator interp(ncols, nsrc, nlev);
+  interp.set_grids(src_x, tgt_x);
+  interp.interpolate(src_values, values);
+  auto h_values = Kokkos::create_mirror_view(values);
+  Kokkos::deep_copy(h_values, values);
+  for (int col = 0; col < ncols; ++col) {
+    std::vector<Real> x(nsrc);
+    for (int i = 0; i < nsrc; ++i) {
+      x[i] = h_src_x(col, i);
+    }
+    for (int k = 0; k < nlev; ++k) {
+      const Real xk = std::max(h_tgt_x(col, k), x[0]);
+      const int i = std::min(
+          int(std::upper_bound(x.begin(), x.end(), xk) - x.begin()) - 1,
+          nsrc - 2);
+      const Real w = (xk - x[i]) / (x[i + 1] - x[i]);
+      const Real ref = (1 - w) * std::sin(x[i]) + w * std::sin(x[i + 1]);
+      REQUIRE(std::abs(h_values(0, col, k) - ref) <= tolerance());
+    }
+  }
+}
+
+TEST_CASE("interpolation_log_pressure", "") {
+  // functions linear in log pressure are reproduced exactly
+  const int ncols = 2, nsrc = 30, nlev = 20;
+  auto src_p = create_grids(ncols, nsrc, [](int col, int i) {
+    return 100 * std::pow(Real(1000), Real(i) / (nsrc - 1)) * (1 + 0.01 * col);
+  });
+  auto tgt_p = create_grids(ncols, nlev, [](int col, int k) {
+    return 150 * std::pow(Real(500), Real(k) / (nlev - 1));
+  });
+  auto h_src_p = Kokkos::create_mirror_view(src_p);
+  auto h_tgt_p = Kokkos::create_mirror_view(tgt_p);
+  Kokkos::deep_copy(h_src_p, src_p);
+  Kokkos::deep_copy(h_tgt_p, tgt_p);
+  auto src_values = create_fields(1, ncols, nsrc, [&](int, int col, int i) {
+    return 7 * std::log(h_src_p(col, i)) + 2;
+  });
+  DeviceType::view_3d<Real> values("values", 1, ncols, nlev);
+  ColumnInterpolator interp(ncols, nsrc, nlev,
+                            InterpolationMode::log_pressure);
+  interp.set_grids(src_p, tgt_p);
+  interp.interpolate(src_values, values);
+  auto h_values = Kokkos::create_mirror_view(values);
+  Kokkos::deep_copy(h_values, values);
+  for (int col = 0; col < ncols; ++col) {
+    for (int k = 0; k < nlev; ++k) {
+      const Real ref = 7 * std::log(h_tgt_p(col, k)) + 2;
+      REQUIRE(std::abs(h_values(0, col, k) - ref) <= tolerance() * 100);
+    }
+  }
+
+  // pressures must be positive
+  auto bad_p = create_grids(ncols, nsrc, [](int, int i) { return Real(i); });
+  REQUIRE_THROWS(interp.set_grids(bad_p, tgt_p));
+}
+
+TEST_CASE("interpolation_conservative", "") {
+  // a fine source grid (increasing interface pressures) is remapped onto a
+  // coarser, irregular target grid (decreasing interface heights, say)
+  const int ncols = 3, nsrc = 50, nlev = 17, nfields = 2;
+  auto src_x = create_grids(ncols, nsrc + 1, [](int col, int i) {
+    return 1000 * std::pow(Real(i) / nsrc, 1.3);
+  });
+  auto tgt_x = create_grids(ncols, nlev + 1, [](int col, int k) {
+    const Real s = Real(nlev - k) / nlev;
+    return 1000 * (s + 0.2 * s * (1 - s) * (col + 1) / ncols);
+  });
+  auto h_src_x = Kokkos::create_mirror_view(src_x);
+  auto h_tgt_x = Kokkos::create_mirror_view(tgt_x);
+  Kokkos::deep_copy(h_src_x, src_x);
+  Kokkos::deep_copy(h_tgt_x, tgt_x);
+  // field 0 is constant, and field 1 varies from level to level
+  auto src_values =
+      create_fields(nfields, ncols, nsrc, [](int f, int col, int i) {
+        return (f == 0) ? Real(3) : Real(1 + (i * 7) % 5 + col);
+      });
+  auto h_src_values = Kokkos::create_mirror_view(src_values);
+  Kokkos::deep_copy(h_src_values, src_values);
+  DeviceType::view_3d<Real> values("values", nfields, ncols, nlev);
+  ColumnInterpolator interp(ncols, nsrc, nlev,
+                            InterpolationMode::conservative);
+  REQUIRE(interp.num_points(nlev) == nlev + 1);
+  interp.set_grids(src_x, tgt_x);
+  interp.interpolate(src_values, values);
+  auto h_values = Kokkos::create_mirror_view(values);
+  Kokkos::deep_copy(h_values, values);
+  for (int col = 0; col < ncols; ++col) {
+    // constants are preserved, and column integrals are conserved
+    double src_integral = 0, tgt_integral = 0;
+    for (int i = 0; i < nsrc; ++i) {
+      src_integral +=
+          h_src_values(1, col, i) * (h_src_x(col, i + 1) - h_src_x(col, i));
+    }
+    for (int k = 0; k < nlev; ++k) {
+      REQUIRE(std::abs(h_values(0, col, k) - 3) <= tolerance() * 10);
+      tgt_integral +=
+          h_values(1, col, k) * (h_tgt_x(col, k) - h_tgt_x(col, k + 1));
+    }
+    REQUIRE(std::abs(tgt_integral - src_integral) <=
+            tolerance() * std::abs(src_integral));
+  }
+}
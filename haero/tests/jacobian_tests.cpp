@@ -0,0 +1,163 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/aero_process.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "process_tests.hpp"
+
+using namespace haero;
+using namespace haero::testing;
+
+namespace {
+
+// Jacobians for every column, indexed by (column, level, tendency,
+// prognostic)
+using JacobiansView = DeviceType::view<Real ****>;
+
+// Computes the Jacobian of the given process in every column of the given
+// state, by the process's own method (analytic if available) or by finite
+// differences.
+template <typename Process>
+JacobiansView compute_jacobians(const Process &process,
+                                const TestColumnState &state,
+                                bool finite_differences) {
+  const int num_tracers = state.tracers.extent(0);
+  const int num_cols = state.tracers.extent(1);
+  const int num_levels = state.tracers.extent(2);
+  JacobiansView jacobians("jacobians", num_cols, num_levels, num_tracers,
+                          num_tracers);
+  TracersView work_state("work_state", num_tracers, num_cols, num_levels);
+  TracersView work_tends("work_tends", num_tracers, num_cols, num_levels);
+  TracersView work_perturbed("work_perturbed", num_tracers, num_cols,
+                             num_levels);
+  Kokkos::parallel_for(
+      "compute_jacobians", ThreadTeamPolicy(num_cols, Kokkos::AUTO),
+      KOKKOS_LAMBDA(const ThreadTeam &team) {
+        const int col = team.league_rank();
+        typename Process::Workspace workspace{
+            ColumnTracers(work_state, col), ColumnTracers(work_tends, col),
+            ColumnTracers(work_perturbed, col)};
+        ColumnJacobianView jacobian(Kokkos::subview(
+            jacobians, col, Kokkos::ALL, Kokkos::ALL, Kokkos::ALL));
+        if (finite_differences) {
+          process.compute_fd_jacobian(team, 0.0, 60.0, state.atmosphere(col),
+                                      state.surface(col),
+                                      state.prognostics(col),
+                                      state.diagnostics(col), workspace,
+                                      jacobian);
+        } else {
+          process.compute_jacobian(team, 0.0, 60.0, state.atmosphere(col),
+                                   state.surface(col), state.prognostics(col),
+                                   state.diagnostics(col), workspace,
+                                   jacobian);
+        }
+      });
+  return jacobians;
+}
+
+// Checks that the analytic and finite-difference Jacobians of the given
+// process agree to within the given relative tolerance (with respect to the
+// largest entry of the analytic Jacobian).
+template <typename Process>
+void check_jacobians(const Process &process, const TestColumnState &state,
+                     Real tolerance) {
+  auto analytic = compute_jacobians(process, state, false);
+  auto numerical = compute_jacobians(process, state, true);
+  auto h_analytic = Kokkos::create_mirror_view(analytic);
+  auto h_numerical = Kokkos::create_mirror_view(numerical);
+  Kokkos::deep_copy(h_analytic, analytic);
+  Kokkos::deep_copy(h_numerical, numerical);
+
+  Real scale = 0;
+  for (size_t i = 0; i < h_analytic.size(); ++i) {
+    scale = std::max(scale, std::abs(h_analytic.data()[i]));
+  }
+  REQUIRE(scale > 0);
+  for (size_t i = 0; i < h_analytic.size(); ++i) {
+    REQUIRE(std::abs(h_numerical.data()[i] - h_analytic.data()[i]) <=
+            tolerance * scale);
+  }
+}
+
+} // namespace
+
+TEST_CASE("jacobian", "") {
+  const int num_tracers = 3, num_cols = 5, num_levels = 12;
+  auto state = create_column_state(num_tracers, num_cols, num_levels);
+  TestAeroConfig aero_config{num_tracers};
+
+  // finite differences of the first order in sqrt(epsilon)
+  const Real tolerance = 10 * std::sqrt(std::numeric_limits<Real>::epsilon());
+
+  SECTION("decay") {
+    AeroProcess<TestAeroConfig, DecayProcess> decay(aero_config);
+    static_assert(decltype(decay)::has_analytic_jacobian,
+                  "DecayProcess has an analytic Jacobian!");
+    check_jacobians(decay, state, tolerance);
+
+    // J = -rate * I
+    auto jacobians = compute_jacobians(decay, state, false);
+    auto h_jacobians = Kokkos::create_mirror_view(jacobians);
+    Kokkos::deep_copy(h_jacobians, jacobians);
+    const Real rate = decay.process_config().rate;
+    for (int col = 0; col < num_cols; ++col) {
+      for (int k = 0; k < num_levels; ++k) {
+        for (int q = 0; q < num_tracers; ++q) {
+          for (int p = 0; p < num_tracers; ++p) {
+            REQUIRE(h_jacobians(col, k, q, p) == ((q == p) ? -rate : 0));
+          }
+        }
+      }
+    }
+  }
+
+  SECTION("exchange") {
+    AeroProcess<TestAeroConfig, ExchangeProcess> exchange(aero_config);
+    static_assert(decltype(exchange)::has_analytic_jacobian,
+                  "ExchangeProcess has an analytic Jacobian!");
+    check_jacobians(exchange, state, tolerance);
+  }
+
+  SECTION("finite_difference_fallback") {
+    // SourceProcess has no analytic Jacobian, and its tendencies don't
+    // depend on the tracers
+    AeroProcess<TestAeroConfig, SourceProcess> source(aero_config);
+    static_assert(!decltype(source)::has_analytic_jacobian,
+                  "SourceProcess has no analytic Jacobian!");
+    auto jacobians = compute_jacobians(source, state, false);
+    auto h_jacobians = Kokkos::create_mirror_view(jacobians);
+    Kokkos::deep_copy(h_jacobians, jacobians);
+    for (size_t i = 0; i < h_jacobians.size(); ++i) {
+      REQUIRE(h_jacobians.data()[i] == 0);
+    }
+  }
+
+  SECTION("partial_tendencies") {
+    // PresenceProcess sets the first tracer's tendency only at perturbed
+    // states in which it is present, so its tendency mustn't carry over from
+    // the state perturbed in the first tracer to the others
+    Kokkos::deep_copy(
+        Kokkos::subview(state.tracers, 0, Kokkos::ALL, Kokkos::ALL), 0);
+    AeroProcess<TestAeroConfig, PresenceProcess> presence(aero_config);
+    auto jacobians = compute_jacobians(presence, state, true);
+    auto h_jacobians = Kokkos::create_mirror_view(jacobians);
+    Kokkos::deep_copy(h_jacobians, jacobians);
+    for (int col = 0; col < num_cols; ++col) {
+      for (int k = 0; k < num_levels; ++k) {
+        REQUIRE(h_jacobians(col, k, 0, 0) > 0);
+        for (int q = 0; q < num_tracers; ++q) {
+          for (int p = 1; p < num_tracers; ++p) {
+            REQUIRE(h_jacobians(col, k, q, p) == 0);
+          }
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/column_integrals.hpp>
+#include <haero/level_count.hpp>
+#include <haero/process_group.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "process_tests.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace haero;
+using namespace haero::testing;
+
+namespace {
+
+// Returns the level counts in the given list.
+template <int... N>
+std::vector<int> level_counts(std::integer_sequence<int, N...>) {
+  return {N...};
+}
+
+// Returns a number of levels that is not one of the FixedLevelCounts.
+int unspecialized_level_count() {
+  const auto fixed = level_counts(FixedLevelCounts());
+  int num_levels = 13;
+  while (std::find(fixed.begin(), fixed.end(), num_levels) != fixed.end()) {
+    ++num_levels;
+  }
+  return num_levels;
+}
+
+// Returns true if the given level count is fixed, false if not.
+bool is_fixed(const AnyLevelCount &levels) {
+  return std::visit([](const auto &l) { return l.is_fixed; }, levels);
+}
+
+// Returns the number of levels in the given level count.
+int num_levels_in(const AnyLevelCount &levels) {
+  return std::visit([](const auto &l) { return l.num_levels(); }, levels);
+}
+
+} // namespace
+
+TEST_CASE("level_count", "") {
+  static_assert(LevelCount<72>::is_fixed, "");
+  static_assert(LevelCount<72>::num_levels() == 72, "");
+  static_assert(LevelCount<72>::num_packs() == PackInfo::num_packs(72), "");
+  static_assert(num_levels_of(LevelCount<128>()) == 128, "");
+  static_assert(num_levels_of(17) == 17, "");
+
+  const LevelCount<dynamic_levels> levels(41);
+  REQUIRE(!levels.is_fixed);
+  REQUIRE(levels.num_levels() == 41);
+  REQUIRE(levels.num_packs() == PackInfo::num_packs(41));
+  REQUIRE(num_levels_of(levels) == 41);
+
+  // configured level counts get fixed kernels, and others don't
+  for (int num_levels : level_counts(FixedLevelCounts())) {
+    REQUIRE(is_fixed(make_level_count(num_levels)));
+    REQUIRE(num_levels_in(make_level_count(num_levels)) == num_levels);
+  }
+  const int num_levels = unspecialized_level_count();
+  REQUIRE(!is_fixed(make_level_count(num_levels)));
+  REQUIRE(num_levels_in(make_level_count(num_levels)) == num_levels);
+  REQUIRE(dispatch_level_count(num_levels, [](const auto &l) {
+            return l.num_levels();
+          }) == num_levels);
+}
+
+TEST_CASE("level_count_kernels", "") {
+  // processes can provide kernels specialized for level counts
+  static_assert(HasLevelCountTendencies<TestAeroConfig, DecayProcess,
+                                        LevelCount<72>>::value,
+                "");
+  static_assert(HasLevelCountTendencies<TestAeroConfig, DecayProcess,
+                                        LevelCount<dynamic_levels>>::value,
+                "");
+  static_assert(!HasLevelCountTendencies<TestAeroConfig, SourceProcess,
+                                         LevelCount<72>>::value,
+                "");
+
+  // specialized and general kernels give the same results
+  auto fixed = level_counts(FixedLevelCounts());
+  std::vector<int> all_levels = {unspecialized_level_count()};
+  all_levels.insert(all_levels.end(), fixed.begin(), fixed.end());
+  const int num_tracers = 3, num_cols = 4;
+  TestAeroConfig aero_config{num_tracers};
+  DecayProcess::Config decay_config;
+  SourceProcess::Config source_config;
+  for (int num_levels : all_levels) {
+    auto state = create_column_state(num_tracers, num_cols, num_levels);
+    ProcessGroup<TestAeroConfig, DecayProcess, SourceProcess> group(
+        num_tracers, num_cols, num_levels,
+        AeroProcess<TestAeroConfig, DecayProcess>(aero_config, decay_config),
+        AeroProcess<TestAeroConfig, SourceProcess>(aero_config,
+                                                   source_config));
+    REQUIRE(is_fixed(group.level_count()) ==
+            (std::find(fixed.begin(), fixed.end(), num_levels) !=
+             fixed.end()));
+    TracersView tendencies("tendencies", num_tracers, num_cols, num_levels);
+    group.compute_tendencies(0.0, 60.0, state, tendencies);
+    auto h_tracers = Kokkos::create_mirror_view(state.tracers);
+    auto h_tends = Kokkos::create_mirror_view(tendencies);
+    Kokkos::deep_copy(h_tracers, state.tracers);
+    Kokkos::deep_copy(h_tends, tendencies);
+    for (int q = 0; q < num_tracers; ++q) {
+      for (int col = 0; col < num_cols; ++col) {
+        for (int k = 0; k < num_levels; ++k) {
+          const Real expected =
+              -decay_config.rate * h_tracers(q, col, k) +
+              ((q == 0) ? source_config.source * 300.0 : 0.0);
+          REQUIRE(h_tends(q, col, k) == Approx(expected));
+        }
+      }
+    }
+
+    // column burdens
+    DeviceType::view_2d<Real> dp("hydrostatic_dp", num_cols, num_levels);
+    Kokkos::deep_copy(dp, 1000.0);
+    DeviceType::view_2d<Real> burdens("burdens", num_cols, num_tracers);
+    compute_column_burdens(state.tracers, dp, burdens);
+    auto h_burdens = Kokkos::create_mirror_view(burdens);
+    Kokkos::deep_copy(h_burdens, burdens);
+    for (int col = 0; col < num_cols; ++col) {
+      for (int q = 0; q < num_tracers; ++q) {
+        double ref = 0;
+        for (int k = 0; k < num_levels; ++k) {
+          ref += 1000.0 * h_tracers(q, col, k);
+        }
+        REQUIRE(h_burdens(col, q) == Approx(ref / Constants::gravity));
+      }
+    }
+  }
+}
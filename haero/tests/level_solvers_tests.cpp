@@ -0,0 +1,63 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/level_solvers.hpp>
+
+#include <catch2/catch.hpp>
+
+using namespace haero;
+
+TEST_CASE("level_solvers", "") {
+  const int n = 4, num_levels = 13;
+  const int num_packs = PackInfo::num_packs(num_levels);
+
+  // a diagonally dominant matrix and a right-hand side for each level
+  auto matrix = [](int i, int j, int k) {
+    return (i == j) ? 10.0 + k : 1.0 / (1 + i + 2 * j + k);
+  };
+  auto rhs = [](int i, int k) { return 1.0 + i - 0.1 * k; };
+
+  DeviceType::view_3d<PackType> A("A", n, n, num_packs);
+  DeviceType::view_2d<PackType> b("b", n, num_packs);
+  auto h_A = Kokkos::create_mirror_view(A);
+  auto h_b = Kokkos::create_mirror_view(b);
+  for (int k = 0; k < num_levels; ++k) {
+    const int p = k / PackType::n, s = k % PackType::n;
+    for (int i = 0; i < n; ++i) {
+      for (int j = 0; j < n; ++j) {
+        h_A(i, j, p)[s] = matrix(i, j, k);
+      }
+      h_b(i, p)[s] = rhs(i, k);
+    }
+  }
+  // pad unused levels with the identity
+  for (int k = num_levels; k < num_packs * PackType::n; ++k) {
+    const int p = k / PackType::n, s = k % PackType::n;
+    for (int i = 0; i < n; ++i) {
+      h_A(i, i, p)[s] = 1;
+    }
+  }
+  Kokkos::deep_copy(A, h_A);
+  Kokkos::deep_copy(b, h_b);
+
+  Kokkos::parallel_for(
+      ThreadTeamPolicy(1, Kokkos::AUTO), KOKKOS_LAMBDA(const ThreadTeam &team) {
+        factor_level_matrices(team, A);
+        team.team_barrier();
+        solve_level_systems(team, A, b);
+      });
+  Kokkos::deep_copy(h_b, b);
+
+  // the residual A x - b vanishes on every level
+  for (int k = 0; k < num_levels; ++k) {
+    const int p = k / PackType::n, s = k % PackType::n;
+    for (int i = 0; i < n; ++i) {
+      Real Ax = 0;
+      for (int j = 0; j < n; ++j) {
+        Ax += matrix(i, j, k) * h_b(j, p)[s];
+      }
+      REQUIRE(Ax == Approx(rhs(i, k)));
+    }
+  }
+}
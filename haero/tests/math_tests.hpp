@@ -121,6 +121,86 @@ template <typename T> struct MonicParabola {
   }
 };
 
+/** @brief Cubic polynomial with known roots, @f$ (x - r_1)(x - r_2)(x - r_3)
+  @f$
+
+  This struct is used by the solver stress tests, which generate many random
+  instances with known roots.
+*/
+template <typename T> struct CubicWithRoots {
+  static_assert(std::is_floating_point<
+                    typename ekat::ScalarTraits<T>::scalar_type>::value,
+                "floating point type.");
+  using value_type = T;
+  using scalar_type = typename ekat::ScalarTraits<T>::scalar_type;
+
+  Real r1;
+  Real r2;
+  Real r3;
+
+  KOKKOS_INLINE_FUNCTION
+  CubicWithRoots(const Real root1, const Real root2, const Real root3)
+      : r1(root1), r2(root2), r3(root3) {}
+
+  KOKKOS_INLINE_FUNCTION
+  T operator()(const T xin) const {
+    return (xin - r1) * (xin - r2) * (xin - r3);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  T derivative(const T xin) const {
+    return (xin - r2) * (xin - r3) + (xin - r1) * (xin - r3) +
+           (xin - r1) * (xin - r2);
+  }
+};
+
+/** @brief Kohler polynomial for the equilibrium wet radius of a particle,
+
+  @f$ K(r) = \log(s) r^4 - A r^3 + (B - \log(s)) r_d^3 r + A r_d^3 @f$
+
+  where @f$ s @f$ is the relative humidity, @f$ A @f$ is the Kelvin
+  coefficient, @f$ B @f$ is the hygroscopicity, and @f$ r_d @f$ is the dry
+  radius (radii in microns). For @f$ s < 1 @f$, @f$ K(r_d) = B r_d^4 > 0 @f$
+  and @f$ K(r) \to -\infty @f$ as @f$ r \to \infty @f$, so a root is
+  bracketed by @f$ [r_d, r_{max}] @f$ for large enough @f$ r_{max} @f$.
+
+  This struct is used by the solver stress tests to exercise the root finders
+  over physical parameter ranges.
+*/
+template <typename T> struct KohlerTestPolynomial {
+  static_assert(std::is_floating_point<
+                    typename ekat::ScalarTraits<T>::scalar_type>::value,
+                "floating point type.");
+  using value_type = T;
+  using scalar_type = typename ekat::ScalarTraits<T>::scalar_type;
+
+  /// Kelvin coefficient at 298 K [microns]
+  static constexpr Real kelvin_a = 1.104e-3;
+
+  Real log_rh;
+  Real hygroscopicity;
+  Real dry_radius_cubed;
+
+  KOKKOS_INLINE_FUNCTION
+  KohlerTestPolynomial(const Real rel_humidity, const Real hyg,
+                       const Real dry_radius_microns)
+      : log_rh(log(rel_humidity)), hygroscopicity(hyg),
+        dry_radius_cubed(cube(dry_radius_microns)) {}
+
+  KOKKOS_INLINE_FUNCTION
+  T operator()(const T r) const {
+    return log_rh * pow(r, 4) - kelvin_a * cube(r) +
+           (hygroscopicity - log_rh) * dry_radius_cubed * r +
+           kelvin_a * dry_radius_cubed;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  T derivative(const T r) const {
+    return 4 * log_rh * cube(r) - 3 * kelvin_a * square(r) +
+           (hygroscopicity - log_rh) * dry_radius_cubed;
+  }
+};
+
 } // namespace math
 } // namespace haero
 #endif
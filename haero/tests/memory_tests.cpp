@@ -0,0 +1,126 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/memory.hpp>
+#include <haero/testing.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+
+using namespace haero;
+
+TEST_CASE("memory_allocate", "") {
+  const std::string space = MemorySpace::name();
+  const auto before = memory::usage(space);
+
+  void *p1 = memory::allocate("tables", "memory_tests", 1000);
+  void *p2 = memory::allocate("tables", "memory_tests", 500);
+  REQUIRE(memory::is_tracked(p1));
+  REQUIRE(memory::is_tracked(p2));
+
+  auto usage = memory::usage(space);
+  REQUIRE(usage.current_bytes == before.current_bytes + 1500);
+  REQUIRE(usage.num_allocations == before.num_allocations + 2);
+
+  auto categories = memory::usage_by_category(space);
+  REQUIRE(categories["tables"]["memory_tests"].current_bytes == 1500);
+
+  memory::deallocate(p1);
+  usage = memory::usage(space);
+  REQUIRE(usage.current_bytes == before.current_bytes + 500);
+  REQUIRE(usage.peak_bytes >= before.current_bytes + 1500);
+  REQUIRE(!memory::is_tracked(p1));
+
+  memory::deallocate(p2);
+  categories = memory::usage_by_category(space);
+  REQUIRE(categories["tables"]["memory_tests"].current_bytes == 0);
+  REQUIRE(categories["tables"]["memory_tests"].peak_bytes == 1500);
+}
+
+TEST_CASE("memory_track_view", "") {
+  TracersView tracers("tracers", 4, 8, 72);
+  using ViewSpace = typename TracersView::memory_space;
+  const std::string space = ViewSpace::name();
+  const auto before = memory::usage(space);
+
+  memory::track_view(tracers, "tracers", "memory_tests");
+  // tracking a view that shares storage doesn't count it twice
+  auto alias = tracers;
+  memory::track_view(alias, "tracers", "memory_tests");
+  REQUIRE(memory::usage(space).current_bytes ==
+          before.current_bytes + 4 * 8 * 72 * sizeof(Real));
+
+  memory::untrack_view(tracers);
+  REQUIRE(memory::usage(space).current_bytes == before.current_bytes);
+}
+
+TEST_CASE("memory_view_tracker", "") {
+  TracersView tracers("tracers", 4, 8, 72);
+  DeviceType::view_2d<Real> field("field", 8, 72);
+  using ViewSpace = typename TracersView::memory_space;
+  const std::string space = ViewSpace::name();
+  const auto before = memory::usage(space);
+  const std::size_t tracer_bytes = 4 * 8 * 72 * sizeof(Real),
+                    field_bytes = 8 * 72 * sizeof(Real);
+  {
+    memory::ViewTracker tracker;
+    tracker.track(tracers, "tracers", "memory_tests");
+    tracker.track(field, "workspace", "memory_tests");
+    // views that are already tracked aren't counted twice
+    tracker.track(tracers, "tracers", "memory_tests");
+    REQUIRE(memory::usage(space).current_bytes ==
+            before.current_bytes + tracer_bytes + field_bytes);
+    {
+      // a copy of the tracker refers to the same records, so untracking a
+      // view in one copy leaves it recorded for the other
+      auto copy = tracker;
+      copy.untrack(field);
+      REQUIRE(memory::is_tracked(field.data()));
+      tracker.untrack(field);
+      REQUIRE(!memory::is_tracked(field.data()));
+      tracker.track(field, "workspace", "memory_tests");
+    }
+    REQUIRE(memory::is_tracked(tracers.data()));
+    REQUIRE(memory::is_tracked(field.data()));
+    tracker.untrack(field);
+    REQUIRE(!memory::is_tracked(field.data()));
+    REQUIRE(memory::usage(space).current_bytes ==
+            before.current_bytes + tracer_bytes);
+
+    // another tracker shares the record of the same storage
+    memory::ViewTracker other;
+    other.track(tracers, "tracers", "memory_tests");
+    REQUIRE(memory::usage(space).current_bytes ==
+            before.current_bytes + tracer_bytes);
+    tracker = memory::ViewTracker();
+    REQUIRE(memory::is_tracked(tracers.data()));
+  }
+  // the records are released with the last tracker that refers to them
+  REQUIRE(!memory::is_tracked(tracers.data()));
+  REQUIRE(memory::usage(space).current_bytes == before.current_bytes);
+
+  // storage recorded directly isn't counted twice, or released by a tracker
+  memory::track_view(field, "workspace", "memory_tests");
+  {
+    memory::ViewTracker tracker;
+    tracker.track(field, "workspace", "memory_tests");
+  }
+  REQUIRE(memory::is_tracked(field.data()));
+  memory::untrack_view(field);
+}
+
+TEST_CASE("memory_column_pool", "") {
+  const std::string space = MemorySpace::name();
+  const auto before = memory::usage(space);
+  testing::create_column_view(37);
+  auto categories = memory::usage_by_category(space);
+  REQUIRE(categories["ColumnPool"]["haero::testing"].current_bytes >=
+          37 * sizeof(Real));
+  REQUIRE(memory::usage(space).current_bytes > before.current_bytes);
+
+  std::ostringstream ss;
+  memory::report(ss);
+  REQUIRE(ss.str().find("ColumnPool") != std::string::npos);
+}
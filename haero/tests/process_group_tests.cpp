@@ -0,0 +1,425 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/process_group.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "process_tests.hpp"
+
+#include <cmath>
+
+using namespace haero;
+using namespace haero::testing;
+
+TEST_CASE("process_group", "") {
+  const int num_tracers = 3, num_cols = 17, num_levels = 24;
+  auto state = create_column_state(num_tracers, num_cols, num_levels);
+
+  TestAeroConfig aero_config{num_tracers};
+  DecayProcess::Config decay_config;
+  decay_config.rate = 2e-3;
+  SourceProcess::Config source_config;
+  source_config.source = 5e-6;
+  AeroProcess<TestAeroConfig, DecayProcess> decay(aero_config, decay_config);
+  AeroProcess<TestAeroConfig, SourceProcess> source(aero_config,
+                                                    source_config);
+
+  ProcessGroup<TestAeroConfig, DecayProcess, SourceProcess> group(
+      num_tracers, num_cols, num_levels, decay, source);
+  REQUIRE(group.num_processes == 2);
+  REQUIRE(group.dispatch() == ProcessDispatch::sequential);
+
+  // the expected sum of the tendencies
+  auto h_tracers = Kokkos::create_mirror_view(state.tracers);
+  Kokkos::deep_copy(h_tracers, state.tracers);
+  auto expected_tendency = [&](int q, int col, int k) {
+    return -decay_config.rate * h_tracers(q, col, k) +
+           ((q == 0) ? source_config.source * 300.0 : 0.0);
+  };
+
+  auto check = [&](const TracersView &tendencies) {
+    auto h_tends = Kokkos::create_mirror_view(tendencies);
+    Kokkos::deep_copy(h_tends, tendencies);
+    for (int q = 0; q < num_tracers; ++q) {
+      for (int col = 0; col < num_cols; ++col) {
+        for (int k = 0; k < num_levels; ++k) {
+          REQUIRE(h_tends(q, col, k) == Approx(expected_tendency(q, col, k)));
+        }
+      }
+    }
+  };
+
+  SECTION("sequential") {
+    TracersView tendencies("tendencies", num_tracers, num_cols, num_levels);
+    // run twice to make sure that buffers are cleared between steps
+    for (int step = 0; step < 2; ++step) {
+      group.compute_tendencies(0.0, 60.0, state, tendencies);
+      check(tendencies);
+    }
+  }
+
+  SECTION("concurrent") {
+#ifdef HAERO_ENABLE_GPU
+    group.set_concurrent_dispatch({3, 1});
+    REQUIRE(group.dispatch() == ProcessDispatch::concurrent);
+    TracersView tendencies("tendencies", num_tracers, num_cols, num_levels);
+    for (int step = 0; step < 2; ++step) {
+      group.compute_tendencies(0.0, 60.0, state, tendencies);
+      check(tendencies);
+      // each process ran on its own instance
+      REQUIRE(group.num_concurrent_launches() == 2 * (step + 1));
+    }
+
+    // sequential and concurrent dispatch give identical results
+    TracersView seq_tendencies("tendencies", num_tracers, num_cols,
+                               num_levels);
+    group.set_sequential_dispatch();
+    group.compute_tendencies(0.0, 60.0, state, seq_tendencies);
+    REQUIRE(group.num_concurrent_launches() == 4);
+    auto h_tends = Kokkos::create_mirror_view(tendencies);
+    auto h_seq_tends = Kokkos::create_mirror_view(seq_tendencies);
+    Kokkos::deep_copy(h_tends, tendencies);
+    Kokkos::deep_copy(h_seq_tends, seq_tendencies);
+    for (int q = 0; q < num_tracers; ++q) {
+      for (int col = 0; col < num_cols; ++col) {
+        for (int k = 0; k < num_levels; ++k) {
+          REQUIRE(h_tends(q, col, k) == h_seq_tends(q, col, k));
+        }
+      }
+    }
+#else
+    // host backends can't run processes concurrently from one host thread
+    REQUIRE_THROWS(group.set_concurrent_dispatch({3, 1}));
+    REQUIRE(group.dispatch() == ProcessDispatch::sequential);
+    TracersView tendencies("tendencies", num_tracers, num_cols, num_levels);
+    group.compute_tendencies(0.0, 60.0, state, tendencies);
+    check(tendencies);
+    REQUIRE(group.num_concurrent_launches() == 0);
+#endif
+  }
+
+  SECTION("accumulate") {
+    // processes add their tendencies to a shared array, without buffers
+    REQUIRE(group.accumulates_tendencies);
+    group.set_tendency_mode(TendencyMode::accumulate);
+    REQUIRE(group.tendency_mode() == TendencyMode::accumulate);
+    TracersView tendencies("tendencies", num_tracers, num_cols, num_levels);
+    for (int step = 0; step < 2; ++step) {
+      group.compute_tendencies(0.0, 60.0, state, tendencies);
+      check(tendencies);
+    }
+    group.set_tendency_mode(TendencyMode::buffered);
+    group.compute_tendencies(0.0, 60.0, state, tendencies);
+    check(tendencies);
+  }
+
+  SECTION("bad_weights") { REQUIRE_THROWS(group.set_concurrent_dispatch({1})); }
+
+  SECTION("no_accumulation") {
+    // a process without accumulate_tendencies rules out accumulation
+    ProcessGroup<TestAeroConfig, DecayProcess, TabulatedProcess> tab_group(
+        num_tracers, num_cols, num_levels, decay,
+        AeroProcess<TestAeroConfig, TabulatedProcess>(aero_config));
+    REQUIRE(!tab_group.accumulates_tendencies);
+    // the group keeps the metadata of its temporary process registered
+    REQUIRE(std::get<1>(tab_group.processes()).name() == "tabulated");
+    REQUIRE_THROWS(tab_group.set_tendency_mode(TendencyMode::accumulate));
+    REQUIRE_THROWS(tab_group.set_integrator(ProcessIntegrator::split));
+  }
+}
+
+TEST_CASE("process_group_integrators", "") {
+  const int num_tracers = 3, num_cols = 4, num_levels = 11;
+  TestAeroConfig aero_config{num_tracers};
+
+  // returns a copy of the tracers of the given state on host
+  auto host_tracers = [](const TestColumnState &state) {
+    auto h_tracers = Kokkos::create_mirror(state.tracers);
+    Kokkos::deep_copy(h_tracers, state.tracers);
+    return h_tracers;
+  };
+
+  SECTION("stiff_decay") {
+    // a decay rate far beyond the explicit stability limit
+    DecayProcess::Config decay_config;
+    decay_config.rate = 1e3;
+    const Real dt = 1, z = -decay_config.rate * dt;
+    ProcessGroup<TestAeroConfig, DecayProcess> group(
+        num_tracers, num_cols, num_levels,
+        AeroProcess<TestAeroConfig, DecayProcess>(aero_config, decay_config));
+    REQUIRE(group.integrator() == ProcessIntegrator::forward_euler);
+
+    // the amplification factor of each integrator for dq/dt = z q / dt
+    const Real gamma = 1 + 1 / std::sqrt(2.0);
+    const Real w = 1 - gamma * z;
+    const Real k1 = z / w, k2 = (z * (1 + k1) - 2 * k1) / w;
+    const std::vector<std::pair<ProcessIntegrator, Real>> factors = {
+        {ProcessIntegrator::forward_euler, 1 + z},
+        {ProcessIntegrator::backward_euler, 1 / (1 - z)},
+        {ProcessIntegrator::rosenbrock, 1 + 1.5 * k1 + 0.5 * k2}};
+    for (const auto &factor : factors) {
+      group.set_integrator(factor.first);
+      auto state = create_column_state(num_tracers, num_cols, num_levels);
+      auto q0 = host_tracers(state);
+      group.advance(0.0, dt, state);
+      auto q1 = host_tracers(state);
+      for (int q = 0; q < num_tracers; ++q) {
+        for (int col = 0; col < num_cols; ++col) {
+          for (int k = 0; k < num_levels; ++k) {
+            REQUIRE(q1(q, col, k) ==
+                    Approx(factor.second * q0(q, col, k)).epsilon(1e-5));
+          }
+        }
+      }
+      // the implicit integrators damp the stiff mode
+      if (factor.first != ProcessIntegrator::forward_euler) {
+        REQUIRE(std::abs(factor.second) < 1);
+      }
+    }
+  }
+
+  SECTION("rosenbrock_accuracy") {
+    // for a nonstiff decay, ROS2 agrees with the exact solution to second
+    // order (its local error is about 1.1 |z|^3)
+    DecayProcess::Config decay_config;
+    const Real dt = 60, z = -decay_config.rate * dt;
+    ProcessGroup<TestAeroConfig, DecayProcess> group(
+        num_tracers, num_cols, num_levels,
+        AeroProcess<TestAeroConfig, DecayProcess>(aero_config, decay_config));
+    group.set_integrator(ProcessIntegrator::rosenbrock);
+    auto state = create_column_state(num_tracers, num_cols, num_levels);
+    auto q0 = host_tracers(state);
+    group.advance(0.0, dt, state);
+    auto q1 = host_tracers(state);
+    for (int q = 0; q < num_tracers; ++q) {
+      for (int col = 0; col < num_cols; ++col) {
+        for (int k = 0; k < num_levels; ++k) {
+          REQUIRE(std::abs(q1(q, col, k) - std::exp(z) * q0(q, col, k)) <=
+                  2 * std::abs(z * z * z) * q0(q, col, k));
+        }
+      }
+    }
+  }
+
+  SECTION("backward_euler_forced") {
+    // decay with a source in the first tracer, whose Jacobian comes from the
+    // finite-difference fallback: backward Euler is exact for this linear
+    // problem
+    DecayProcess::Config decay_config;
+    decay_config.rate = 50;
+    SourceProcess::Config source_config;
+    const Real dt = 10;
+    ProcessGroup<TestAeroConfig, DecayProcess, SourceProcess> group(
+        num_tracers, num_cols, num_levels,
+        AeroProcess<TestAeroConfig, DecayProcess>(aero_config, decay_config),
+        AeroProcess<TestAeroConfig, SourceProcess>(aero_config,
+                                                   source_config));
+    group.set_integrator(ProcessIntegrator::backward_euler);
+    auto state = create_column_state(num_tracers, num_cols, num_levels);
+    auto q0 = host_tracers(state);
+    group.advance(0.0, dt, state);
+    auto q1 = host_tracers(state);
+    for (int q = 0; q < num_tracers; ++q) {
+      const Real source = (q == 0) ? source_config.source * 300.0 : 0.0;
+      for (int col = 0; col < num_cols; ++col) {
+        for (int k = 0; k < num_levels; ++k) {
+          REQUIRE(q1(q, col, k) ==
+                  Approx((q0(q, col, k) + dt * source) /
+                         (1 + decay_config.rate * dt)));
+        }
+      }
+    }
+  }
+
+  SECTION("backward_euler_nonlinear") {
+    // the Newton iteration solves the nonlinear backward Euler equations
+    ExchangeProcess::Config exchange_config;
+    exchange_config.c = 0.05;
+    exchange_config.d = 0.02;
+    const Real dt = 10;
+    ProcessGroup<TestAeroConfig, ExchangeProcess> group(
+        num_tracers, num_cols, num_levels,
+        AeroProcess<TestAeroConfig, ExchangeProcess>(aero_config,
+                                                     exchange_config));
+    group.set_integrator(ProcessIntegrator::backward_euler);
+    group.set_newton_iteration(50, 1e-7, 0);
+    auto state = create_column_state(num_tracers, num_cols, num_levels);
+    auto q0 = host_tracers(state);
+    group.advance(0.0, dt, state);
+    auto q1 = host_tracers(state);
+    const Real c = exchange_config.c, d = exchange_config.d;
+    for (int col = 0; col < num_cols; ++col) {
+      for (int k = 0; k < num_levels; ++k) {
+        const Real y0 = q1(0, col, k), y1 = q1(1, col, k);
+        REQUIRE(y0 - q0(0, col, k) ==
+                Approx(dt * (-c * y0 * y1 - d * y0 * y0)).epsilon(1e-4));
+        REQUIRE(y1 - q0(1, col, k) ==
+                Approx(dt * (c * y0 * y1)).epsilon(1e-4));
+        REQUIRE(q1(2, col, k) == q0(2, col, k));
+      }
+    }
+
+    // accumulated tendencies give the same solution
+    group.set_tendency_mode(TendencyMode::accumulate);
+    auto acc_state = create_column_state(num_tracers, num_cols, num_levels);
+    group.advance(0.0, dt, acc_state);
+    auto q2 = host_tracers(acc_state);
+    for (int q = 0; q < num_tracers; ++q) {
+      for (int col = 0; col < num_cols; ++col) {
+        for (int k = 0; k < num_levels; ++k) {
+          REQUIRE(q2(q, col, k) == Approx(q1(q, col, k)));
+        }
+      }
+    }
+
+    REQUIRE_THROWS(group.set_newton_iteration(0, 1e-6, 0));
+  }
+
+  SECTION("split") {
+    // decay, then exchange from the decayed state, each applied in place
+    DecayProcess::Config decay_config;
+    decay_config.rate = 1e-2;
+    ExchangeProcess::Config exchange_config;
+    const Real dt = 5;
+    ProcessGroup<TestAeroConfig, DecayProcess, ExchangeProcess> group(
+        num_tracers, num_cols, num_levels,
+        AeroProcess<TestAeroConfig, DecayProcess>(aero_config, decay_config),
+        AeroProcess<TestAeroConfig, ExchangeProcess>(aero_config,
+                                                     exchange_config));
+    group.set_integrator(ProcessIntegrator::split);
+    auto state = create_column_state(num_tracers, num_cols, num_levels);
+    auto q0 = host_tracers(state);
+    group.advance(0.0, dt, state);
+    auto q1 = host_tracers(state);
+    const Real c = exchange_config.c, d = exchange_config.d;
+    for (int col = 0; col < num_cols; ++col) {
+      for (int k = 0; k < num_levels; ++k) {
+        const Real decay = 1 - decay_config.rate * dt;
+        const Real y0 = decay * q0(0, col, k), y1 = decay * q0(1, col, k);
+        REQUIRE(q1(0, col, k) ==
+                Approx(y0 + dt * (-c * y0 * y1 - d * y0 * y0)));
+        REQUIRE(q1(1, col, k) == Approx(y1 + dt * c * y0 * y1));
+        REQUIRE(q1(2, col, k) == Approx(decay * q0(2, col, k)));
+      }
+    }
+  }
+}
+
+namespace {
+
+// A ColumnState that can't be tiled over levels.
+struct UntiledState {
+  TestColumnState state;
+
+  KOKKOS_INLINE_FUNCTION
+  Atmosphere atmosphere(const int col) const { return state.atmosphere(col); }
+
+  KOKKOS_INLINE_FUNCTION
+  Surface surface(const int col) const { return state.surface(col); }
+
+  KOKKOS_INLINE_FUNCTION
+  ColumnTracers prognostics(const int col) const {
+    return state.prognostics(col);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  NoDiagnostics diagnostics(const int col) const {
+    return state.diagnostics(col);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  ColumnTracers tendencies(const TracersView &buffer, const int col) const {
+    return state.tendencies(buffer, col);
+  }
+};
+
+} // namespace
+
+TEST_CASE("process_group_level_tiling", "") {
+  const int num_tracers = 3, num_cols = 5, num_levels = 24;
+  TestAeroConfig aero_config{num_tracers};
+  AeroProcess<TestAeroConfig, DecayProcess> decay(aero_config);
+  AeroProcess<TestAeroConfig, SourceProcess> source(aero_config);
+  AeroProcess<TestAeroConfig, ExchangeProcess> exchange(aero_config);
+  using Group = ProcessGroup<TestAeroConfig, DecayProcess, SourceProcess,
+                             ExchangeProcess>;
+  static_assert(Group::vertically_local, "processes should be local!");
+  static_assert(HasLevelTiles<TestColumnState>::value,
+                "TestColumnState should have level tiles!");
+  static_assert(!HasLevelTiles<UntiledState>::value,
+                "UntiledState should not have level tiles!");
+
+  // tiles of any size give the same results as whole columns, including
+  // tiles that don't divide the number of levels
+  for (auto integrator :
+       {ProcessIntegrator::forward_euler, ProcessIntegrator::split}) {
+    Group group(num_tracers, num_cols, num_levels, decay, source, exchange);
+    group.set_tendency_mode(TendencyMode::accumulate);
+    group.set_integrator(integrator);
+    REQUIRE(group.level_tile_size() == 0);
+    auto ref_state = create_column_state(num_tracers, num_cols, num_levels);
+    TracersView ref_tendencies("tendencies", num_tracers, num_cols,
+                               num_levels);
+    group.compute_tendencies(0.0, 30.0, ref_state, ref_tendencies);
+    group.advance(0.0, 30.0, ref_state);
+    auto h_ref_tends = Kokkos::create_mirror_view(ref_tendencies);
+    Kokkos::deep_copy(h_ref_tends, ref_tendencies);
+    auto h_ref = Kokkos::create_mirror_view(ref_state.tracers);
+    Kokkos::deep_copy(h_ref, ref_state.tracers);
+
+    for (int tile_size : {1, 5, 8, 24, 100}) {
+      group.set_level_tile_size(tile_size);
+      REQUIRE(group.level_tile_size() == tile_size);
+      auto state = create_column_state(num_tracers, num_cols, num_levels);
+      TracersView tendencies("tendencies", num_tracers, num_cols, num_levels);
+      group.compute_tendencies(0.0, 30.0, state, tendencies);
+      group.advance(0.0, 30.0, state);
+      auto h_tends = Kokkos::create_mirror_view(tendencies);
+      Kokkos::deep_copy(h_tends, tendencies);
+      auto h_tracers = Kokkos::create_mirror_view(state.tracers);
+      Kokkos::deep_copy(h_tracers, state.tracers);
+      for (int q = 0; q < num_tracers; ++q) {
+        for (int col = 0; col < num_cols; ++col) {
+          for (int k = 0; k < num_levels; ++k) {
+            REQUIRE(h_tends(q, col, k) == h_ref_tends(q, col, k));
+            REQUIRE(h_tracers(q, col, k) == h_ref(q, col, k));
+          }
+        }
+      }
+    }
+
+    // tiling needs a ColumnState with level tiles
+    group.set_level_tile_size(8);
+    UntiledState untiled{create_column_state(num_tracers, num_cols,
+                                             num_levels)};
+    TracersView tendencies("tendencies", num_tracers, num_cols, num_levels);
+    REQUIRE_THROWS(group.compute_tendencies(0.0, 30.0, untiled, tendencies));
+    group.set_level_tile_size(0);
+    group.compute_tendencies(0.0, 30.0, untiled, tendencies);
+
+    // tiling is rejected for kernels it doesn't apply to
+    group.set_level_tile_size(8);
+    REQUIRE_THROWS(group.set_tendency_mode(TendencyMode::buffered));
+    REQUIRE_THROWS(group.set_integrator(ProcessIntegrator::backward_euler));
+    REQUIRE_THROWS(group.set_integrator(ProcessIntegrator::rosenbrock));
+    REQUIRE(group.tendency_mode() == TendencyMode::accumulate);
+    REQUIRE(group.integrator() == integrator);
+    group.set_level_tile_size(0);
+    group.set_integrator(ProcessIntegrator::backward_euler);
+    REQUIRE_THROWS(group.set_level_tile_size(8));
+    group.set_integrator(integrator);
+    group.set_tendency_mode(TendencyMode::buffered);
+    REQUIRE_THROWS(group.set_level_tile_size(8));
+  }
+
+  // processes that aren't vertically local can't be tiled
+  ProcessGroup<TestAeroConfig, DecayProcess, TabulatedProcess> tab_group(
+      num_tracers, num_cols, num_levels, decay,
+      AeroProcess<TestAeroConfig, TabulatedProcess>(aero_config));
+  REQUIRE(!tab_group.vertically_local);
+  REQUIRE_THROWS(tab_group.set_level_tile_size(8));
+  Group group(num_tracers, num_cols, num_levels, decay, source, exchange);
+  REQUIRE_THROWS(group.set_level_tile_size(-1));
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/process_group.hpp>
+#include <haero/process_registry.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "process_tests.hpp"
+
+using namespace haero;
+using namespace haero::testing;
+
+using Registry = ProcessRegistry<TestAeroConfig, DecayProcess, SourceProcess,
+                                 ExchangeProcess>;
+using Variant = Registry::Variant;
+
+TEST_CASE("process_variant", "") {
+  TestAeroConfig aero_config{2};
+  REQUIRE(Variant::num_impls == 3);
+  REQUIRE(Variant::index_of<DecayProcess>() == 0);
+  REQUIRE(Variant::index_of<SourceProcess>() == 1);
+  REQUIRE(Variant::index_of<ExchangeProcess>() == 2);
+  REQUIRE(Variant::index_of<int>() == -1);
+
+  Variant empty;
+  REQUIRE(empty.empty());
+  REQUIRE(empty.index() == -1);
+
+  SourceProcess::Config source_config;
+  source_config.source = 7e-6;
+  Variant source(
+      AeroProcess<TestAeroConfig, SourceProcess>(aero_config, source_config));
+  REQUIRE(!source.empty());
+  REQUIRE(source.index() == 1);
+  REQUIRE(source.name() == "source");
+
+  // copies carry the process and its configuration
+  Variant copy(source);
+  REQUIRE(copy.index() == 1);
+  Real source_rate = 0;
+  copy.visit([&](const auto &process) {
+    using P = std::decay_t<decltype(process)>;
+    if constexpr (std::is_same<typename P::ProcessImpl, SourceProcess>::value) {
+      source_rate = process.process_config().source;
+    }
+  });
+  REQUIRE(source_rate == source_config.source);
+
+  // assignment replaces the process
+  copy = Variant(AeroProcess<TestAeroConfig, DecayProcess>(aero_config));
+  REQUIRE(copy.index() == 0);
+  REQUIRE(copy.name() == "decay");
+  copy = empty;
+  REQUIRE(copy.empty());
+}
+
+TEST_CASE("process_registry", "") {
+  const int num_tracers = 2, num_cols = 7, num_levels = 19;
+  TestAeroConfig aero_config{num_tracers};
+  Registry registry(aero_config);
+  REQUIRE(registry.names() ==
+          std::vector<std::string>({"decay", "source", "exchange"}));
+  REQUIRE(registry.has("exchange"));
+  REQUIRE(!registry.has("nucleation"));
+  REQUIRE(registry.create("exchange").index() == 2);
+  REQUIRE_THROWS(registry.create("nucleation"));
+
+  // a plan chosen at runtime matches the equivalent static ProcessGroup
+  auto state = create_column_state(num_tracers, num_cols, num_levels);
+  auto plan = registry.plan({"decay", "source", "exchange"}, num_tracers,
+                            num_cols, num_levels);
+  REQUIRE(plan.num_processes() == 3);
+  REQUIRE(plan.names() == registry.names());
+  TracersView tendencies("tendencies", num_tracers, num_cols, num_levels);
+  plan.compute_tendencies(0.0, 60.0, state, tendencies);
+
+  ProcessGroup<TestAeroConfig, DecayProcess, SourceProcess, ExchangeProcess>
+      group(num_tracers, num_cols, num_levels,
+            AeroProcess<TestAeroConfig, DecayProcess>(aero_config),
+            AeroProcess<TestAeroConfig, SourceProcess>(aero_config),
+            AeroProcess<TestAeroConfig, ExchangeProcess>(aero_config));
+  TracersView group_tendencies("group_tendencies", num_tracers, num_cols,
+                               num_levels);
+  group.compute_tendencies(0.0, 60.0, state, group_tendencies);
+
+  auto h_tends = Kokkos::create_mirror_view(tendencies);
+  auto h_group_tends = Kokkos::create_mirror_view(group_tendencies);
+  Kokkos::deep_copy(h_tends, tendencies);
+  Kokkos::deep_copy(h_group_tends, group_tendencies);
+  for (int q = 0; q < num_tracers; ++q) {
+    for (int col = 0; col < num_cols; ++col) {
+      for (int k = 0; k < num_levels; ++k) {
+        REQUIRE(h_tends(q, col, k) == Approx(h_group_tends(q, col, k)));
+      }
+    }
+  }
+
+  // configured processes can be planned too
+  DecayProcess::Config decay_config;
+  decay_config.rate = 0.5;
+  Registry::LaunchPlan decay_plan({registry.create<DecayProcess>(decay_config)},
+                                  num_tracers, num_cols, num_levels);
+  decay_plan.compute_tendencies(0.0, 60.0, state, tendencies);
+  auto h_tracers = Kokkos::create_mirror_view(state.tracers);
+  Kokkos::deep_copy(h_tracers, state.tracers);
+  Kokkos::deep_copy(h_tends, tendencies);
+  REQUIRE(h_tends(1, 3, 5) == Approx(-0.5 * h_tracers(1, 3, 5)));
+
+  REQUIRE_THROWS(Registry::LaunchPlan({Variant()}, num_tracers, num_cols,
+                                      num_levels));
+}
@@ -0,0 +1,543 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_PROCESS_TESTS_HPP
+#define HAERO_PROCESS_TESTS_HPP
+
+#include "haero/aero_process.hpp"
+#include "haero/haero.hpp"
+#include "haero/testing.hpp"
+
+namespace haero {
+namespace testing {
+
+/// @class ColumnTracers
+/// This type stores the tracers for a single column, indexed by (tracer,
+/// level), within a (tracer, column, level) TracersView. It is used for
+/// prognostics and tendencies by the aerosol configuration in these tests.
+class ColumnTracers {
+public:
+  using View = Kokkos::View<Real **, Kokkos::LayoutStride, DeviceType::Device,
+                            Kokkos::MemoryUnmanaged>;
+
+  KOKKOS_INLINE_FUNCTION
+  ColumnTracers() = default;
+
+  /// Creates a ColumnTracers object for the given column of the given
+  /// tracers.
+  KOKKOS_INLINE_FUNCTION
+  ColumnTracers(const TracersView &tracers, const int col)
+      : data(Kokkos::subview(tracers, Kokkos::ALL, col, Kokkos::ALL)) {}
+
+  /// Creates a ColumnTracers object for the given levels of the given column
+  /// of the given tracers.
+  KOKKOS_INLINE_FUNCTION
+  ColumnTracers(const TracersView &tracers, const int col,
+                const int first_level, const int num_levels)
+      : data(Kokkos::subview(
+            tracers, Kokkos::ALL, col,
+            Kokkos::make_pair(first_level, first_level + num_levels))) {}
+
+  /// Returns the number of tracers.
+  KOKKOS_INLINE_FUNCTION
+  int num_tracers() const { return data.extent(0); }
+
+  /// Returns the number of vertical levels.
+  KOKKOS_INLINE_FUNCTION
+  int num_levels() const { return data.extent(1); }
+
+  /// Returns the value of the given tracer at the given level.
+  KOKKOS_INLINE_FUNCTION
+  Real &operator()(const int q, const int k) const { return data(q, k); }
+
+  /// the tracer data, indexed by (tracer, level)
+  View data;
+};
+
+/// @struct NoDiagnostics
+/// Diagnostics for an aerosol configuration that has none.
+struct NoDiagnostics {};
+
+/// @struct TestAeroConfig
+/// A minimal aerosol configuration for testing processes.
+struct TestAeroConfig {
+  using Prognostics = ColumnTracers;
+  using Diagnostics = NoDiagnostics;
+  using Tendencies = ColumnTracers;
+
+  /// number of tracers
+  int num_tracers;
+};
+
+/// @struct DecayProcess
+/// A process in which every tracer decays exponentially: dq/dt = -rate * q.
+/// It rejects columns with negative tracer values.
+struct DecayProcess {
+  struct Config {
+    Real rate = 1e-3; // [1/s]
+  };
+
+  static constexpr bool vertically_local = true;
+
+  const char *name() const { return "decay"; }
+
+  void init(const TestAeroConfig &aero_config, const Config &config) {
+    rate = config.rate;
+  }
+
+  // rejects negative tracer values, reporting the first one
+  KOKKOS_INLINE_FUNCTION
+  bool validate(const TestAeroConfig &aero_config, const ThreadTeam &team,
+                const Atmosphere &atmosphere, const Surface &surface,
+                const ColumnTracers &prognostics, int &tracer,
+                int &level) const {
+    const int nlev = prognostics.num_levels();
+    const int n = prognostics.num_tracers() * nlev;
+    int first_negative = n;
+    Kokkos::parallel_reduce(
+        Kokkos::TeamThreadRange(team, n),
+        [&](const int i, int &first) {
+          if ((prognostics(i / nlev, i % nlev) < 0) && (i < first)) {
+            first = i;
+          }
+        },
+        Kokkos::Min<int>(first_negative));
+    if (first_negative < n) {
+      tracer = first_negative / nlev;
+      level = first_negative % nlev;
+      return false;
+    }
+    return true;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void compute_tendencies(const TestAeroConfig &aero_config,
+                          const ThreadTeam &team, Real t, Real dt,
+                          const Atmosphere &atmosphere, const Surface &surface,
+                          const ColumnTracers &prognostics,
+                          const NoDiagnostics &diagnostics,
+                          const ColumnTracers &tendencies) const {
+    const int nlev = prognostics.num_levels();
+    const int n = prognostics.num_tracers() * nlev;
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(team, n), [&](const int i) {
+      const int q = i / nlev, k = i % nlev;
+      tendencies.data(q, k) = -rate * prognostics.data(q, k);
+    });
+  }
+
+  // tendencies for a given level count, whose level loops have compile-time
+  // trip counts for fixed level counts
+  template <int N>
+  KOKKOS_INLINE_FUNCTION void
+  compute_tendencies(const TestAeroConfig &aero_config, const ThreadTeam &team,
+                     const LevelCount<N> &levels, Real t, Real dt,
+                     const Atmosphere &atmosphere, const Surface &surface,
+                     const ColumnTracers &prognostics,
+                     const NoDiagnostics &diagnostics,
+                     const ColumnTracers &tendencies) const {
+    const int nlev = levels.num_levels();
+    Kokkos::parallel_for(
+        Kokkos::TeamThreadRange(team, prognostics.num_tracers()),
+        [&](const int q) {
+          Kokkos::parallel_for(Kokkos::ThreadVectorRange(team, nlev),
+                               [&](const int k) {
+                                 tendencies(q, k) = -rate * prognostics(q, k);
+                               });
+        });
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void accumulate_tendencies(const TestAeroConfig &aero_config,
+                             const ThreadTeam &team, Real t, Real dt,
+                             const Atmosphere &atmosphere,
+                             const Surface &surface,
+                             const ColumnTracers &prognostics,
+                             const NoDiagnostics &diagnostics, Real scale,
+                             const ColumnTracers &tendencies) const {
+    const int nlev = prognostics.num_levels();
+    const int n = prognostics.num_tracers() * nlev;
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(team, n), [&](const int i) {
+      const int q = i / nlev, k = i % nlev;
+      tendencies(q, k) += -scale * rate * prognostics(q, k);
+    });
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void compute_jacobian(const TestAeroConfig &aero_config,
+                        const ThreadTeam &team, Real t, Real dt,
+                        const Atmosphere &atmosphere, const Surface &surface,
+                        const ColumnTracers &prognostics,
+                        const NoDiagnostics &diagnostics,
+                        const ColumnJacobianView &jacobian) const {
+    const int ntr = prognostics.num_tracers();
+    const int n = prognostics.num_levels() * ntr * ntr;
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(team, n), [&](const int i) {
+      const int k = i / (ntr * ntr), q = (i / ntr) % ntr, p = i % ntr;
+      jacobian(k, q, p) = (q == p) ? -rate : 0;
+    });
+  }
+
+  Real rate;
+};
+
+/// @struct SourceProcess
+/// A process that emits the first tracer at a rate proportional to the air
+/// temperature, and leaves the tendencies of all other tracers unset.
+struct SourceProcess {
+  struct Config {
+    Real source = 1e-6; // [1/s/K]
+  };
+
+  static constexpr bool vertically_local = true;
+
+  const char *name() const { return "source"; }
+
+  void init(const TestAeroConfig &aero_config, const Config &config) {
+    source = config.source;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  bool validate(const TestAeroConfig &aero_config, const ThreadTeam &team,
+                const Atmosphere &atmosphere, const Surface &surface,
+                const ColumnTracers &prognostics) const {
+    return true;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void compute_tendencies(const TestAeroConfig &aero_config,
+                          const ThreadTeam &team, Real t, Real dt,
+                          const Atmosphere &atmosphere, const Surface &surface,
+                          const ColumnTracers &prognostics,
+                          const NoDiagnostics &diagnostics,
+                          const ColumnTracers &tendencies) const {
+    Kokkos::parallel_for(
+        Kokkos::TeamThreadRange(team, prognostics.num_levels()),
+        [&](const int k) {
+          tendencies.data(0, k) = source * atmosphere.temperature(k);
+        });
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void accumulate_tendencies(const TestAeroConfig &aero_config,
+                             const ThreadTeam &team, Real t, Real dt,
+                             const Atmosphere &atmosphere,
+                             const Surface &surface,
+                             const ColumnTracers &prognostics,
+                             const NoDiagnostics &diagnostics, Real scale,
+                             const ColumnTracers &tendencies) const {
+    Kokkos::parallel_for(
+        Kokkos::TeamThreadRange(team, prognostics.num_levels()),
+        [&](const int k) {
+          tendencies(0, k) += scale * source * atmosphere.temperature(k);
+        });
+  }
+
+  Real source;
+};
+
+/// @struct PresenceProcess
+/// A process that emits each tracer at a constant rate at the levels where
+/// it is present (positive), and leaves its tendencies unset elsewhere, so
+/// the tendencies it sets depend on the state.
+struct PresenceProcess {
+  struct Config {
+    Real rate = 1e-6; // [1/s]
+  };
+
+  const char *name() const { return "presence"; }
+
+  void init(const TestAeroConfig &aero_config, const Config &config) {
+    rate = config.rate;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  bool validate(const TestAeroConfig &aero_config, const ThreadTeam &team,
+                const Atmosphere &atmosphere, const Surface &surface,
+                const ColumnTracers &prognostics) const {
+    return true;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void compute_tendencies(const TestAeroConfig &aero_config,
+                          const ThreadTeam &team, Real t, Real dt,
+                          const Atmosphere &atmosphere, const Surface &surface,
+                          const ColumnTracers &prognostics,
+                          const NoDiagnostics &diagnostics,
+                          const ColumnTracers &tendencies) const {
+    const int nlev = prognostics.num_levels();
+    const int n = prognostics.num_tracers() * nlev;
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(team, n), [&](const int i) {
+      const int q = i / nlev, k = i % nlev;
+      if (prognostics(q, k) > 0) {
+        tendencies(q, k) = rate;
+      }
+    });
+  }
+
+  Real rate;
+};
+
+/// @struct ExchangeProcess
+/// A nonlinear process in which the first tracer is lost through reactions
+/// with itself and with the second tracer, which it feeds:
+/// dq0/dt = -c q0 q1 - d q0^2, dq1/dt = c q0 q1. Other tracers are unchanged.
+/// This process requires at least 2 tracers.
+struct ExchangeProcess {
+  struct Config {
+    Real c = 2e-2; // [1/s]
+    Real d = 5e-3; // [1/s]
+  };
+
+  static constexpr bool vertically_local = true;
+
+  const char *name() const { return "exchange"; }
+
+  void init(const TestAeroConfig &aero_config, const Config &config) {
+    c = config.c;
+    d = config.d;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  bool validate(const TestAeroConfig &aero_config, const ThreadTeam &team,
+                const Atmosphere &atmosphere, const Surface &surface,
+                const ColumnTracers &prognostics) const {
+    return (prognostics.num_tracers() >= 2);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void compute_tendencies(const TestAeroConfig &aero_config,
+                          const ThreadTeam &team, Real t, Real dt,
+                          const Atmosphere &atmosphere, const Surface &surface,
+                          const ColumnTracers &prognostics,
+                          const NoDiagnostics &diagnostics,
+                          const ColumnTracers &tendencies) const {
+    const int nlev = prognostics.num_levels();
+    const int n = prognostics.num_tracers() * nlev;
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(team, n), [&](const int i) {
+      const int q = i / nlev, k = i % nlev;
+      const Real q0 = prognostics(0, k), q1 = prognostics(1, k);
+      if (q == 0) {
+        tendencies(q, k) = -c * q0 * q1 - d * q0 * q0;
+      } else if (q == 1) {
+        tendencies(q, k) = c * q0 * q1;
+      } else {
+        tendencies(q, k) = 0;
+      }
+    });
+  }
+
+  // both tracers at a level are read before either is updated, so the
+  // tendencies may alias the prognostics
+  KOKKOS_INLINE_FUNCTION
+  void accumulate_tendencies(const TestAeroConfig &aero_config,
+                             const ThreadTeam &team, Real t, Real dt,
+                             const Atmosphere &atmosphere,
+                             const Surface &surface,
+                             const ColumnTracers &prognostics,
+                             const NoDiagnostics &diagnostics, Real scale,
+                             const ColumnTracers &tendencies) const {
+    Kokkos::parallel_for(
+        Kokkos::TeamThreadRange(team, prognostics.num_levels()),
+        [&](const int k) {
+          const Real q0 = prognostics(0, k), q1 = prognostics(1, k);
+          tendencies(0, k) += scale * (-c * q0 * q1 - d * q0 * q0);
+          tendencies(1, k) += scale * c * q0 * q1;
+        });
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void compute_jacobian(const TestAeroConfig &aero_config,
+                        const ThreadTeam &team, Real t, Real dt,
+                        const Atmosphere &atmosphere, const Surface &surface,
+                        const ColumnTracers &prognostics,
+                        const NoDiagnostics &diagnostics,
+                        const ColumnJacobianView &jacobian) const {
+    const int ntr = prognostics.num_tracers();
+    const int n = prognostics.num_levels() * ntr * ntr;
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(team, n), [&](const int i) {
+      const int k = i / (ntr * ntr), q = (i / ntr) % ntr, p = i % ntr;
+      const Real q0 = prognostics(0, k), q1 = prognostics(1, k);
+      Real dtdq = 0;
+      if ((q == 0) && (p == 0)) {
+        dtdq = -c * q1 - 2 * d * q0;
+      } else if ((q == 0) && (p == 1)) {
+        dtdq = -c * q0;
+      } else if ((q == 1) && (p == 0)) {
+        dtdq = c * q1;
+      } else if ((q == 1) && (p == 1)) {
+        dtdq = c * q0;
+      }
+      jacobian(k, q, p) = dtdq;
+    });
+  }
+
+  Real c, d;
+};
+
+/// @struct TabulatedProcess
+/// A process whose tendencies are interpolated from a precomputed table of
+/// num_bins values of scale * x^2 on [0, 1], at x = (level index) /
+/// (number of levels), scaled by a separate factor. Only the table depends on
+/// num_bins and scale, so it supports incremental re-initialization.
+struct TabulatedProcess {
+  struct Config {
+    int num_bins = 16;
+    Real scale = 1;
+    Real factor = 1e-3; // [1/s]
+  };
+
+  const char *name() const { return "tabulated"; }
+
+  void init(const TestAeroConfig &aero_config, const Config &config) {
+    build_table(config);
+    factor = config.factor;
+  }
+
+  void reinit(const TestAeroConfig &aero_config, const Config &old_config,
+              const Config &new_config) {
+    if (config_changed(old_config, new_config, &Config::num_bins,
+                       &Config::scale)) {
+      build_table(new_config);
+    }
+    factor = new_config.factor;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  bool validate(const TestAeroConfig &aero_config, const ThreadTeam &team,
+                const Atmosphere &atmosphere, const Surface &surface,
+                const ColumnTracers &prognostics) const {
+    return true;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void compute_tendencies(const TestAeroConfig &aero_config,
+                          const ThreadTeam &team, Real t, Real dt,
+                          const Atmosphere &atmosphere, const Surface &surface,
+                          const ColumnTracers &prognostics,
+                          const NoDiagnostics &diagnostics,
+                          const ColumnTracers &tendencies) const {
+    const int nlev = prognostics.num_levels();
+    const int n = prognostics.num_tracers() * nlev;
+    const int num_bins = table.extent(0);
+    Kokkos::parallel_for(Kokkos::TeamThreadRange(team, n), [&](const int i) {
+      const int q = i / nlev, k = i % nlev;
+      const Real x = Real(k) / nlev * (num_bins - 1);
+      const int b = (x < num_bins - 1) ? int(x) : num_bins - 2;
+      const Real w = x - b;
+      tendencies(q, k) = factor * ((1 - w) * table(b) + w * table(b + 1));
+    });
+  }
+
+  void build_table(const Config &config) {
+    table = DeviceType::view_1d<Real>("table", config.num_bins);
+    auto h_table = Kokkos::create_mirror_view(table);
+    for (int b = 0; b < config.num_bins; ++b) {
+      const Real x = Real(b) / (config.num_bins - 1);
+      h_table(b) = config.scale * x * x;
+    }
+    Kokkos::deep_copy(table, h_table);
+    ++num_table_builds;
+  }
+
+  DeviceType::view_1d<Real> table;
+  Real factor;
+
+  /// the number of tables built by all TabulatedProcesses
+  static inline int num_table_builds = 0;
+};
+
+/// @struct TestColumnTile
+/// A ColumnState (see ProcessGroup) for a range of levels of every column in
+/// a TestColumnState.
+struct TestColumnTile {
+  TracersView tracers;
+  Atmosphere atm;
+  Surface sfc;
+  int first_level, num_levels;
+
+  KOKKOS_INLINE_FUNCTION
+  Atmosphere atmosphere(const int col) const { return atm; }
+
+  KOKKOS_INLINE_FUNCTION
+  Surface surface(const int col) const { return sfc; }
+
+  KOKKOS_INLINE_FUNCTION
+  ColumnTracers prognostics(const int col) const {
+    return ColumnTracers(tracers, col, first_level, num_levels);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  NoDiagnostics diagnostics(const int col) const { return NoDiagnostics(); }
+
+  KOKKOS_INLINE_FUNCTION
+  ColumnTracers tendencies(const TracersView &buffer, const int col) const {
+    return ColumnTracers(buffer, col, first_level, num_levels);
+  }
+};
+
+/// @struct TestColumnState
+/// A ColumnState (see ProcessGroup) in which every column shares the same
+/// atmospheric state.
+struct TestColumnState {
+  TracersView tracers;
+  Atmosphere atm;
+  Surface sfc;
+
+  KOKKOS_INLINE_FUNCTION
+  Atmosphere atmosphere(const int col) const { return atm; }
+
+  KOKKOS_INLINE_FUNCTION
+  Surface surface(const int col) const { return sfc; }
+
+  KOKKOS_INLINE_FUNCTION
+  ColumnTracers prognostics(const int col) const {
+    return ColumnTracers(tracers, col);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  NoDiagnostics diagnostics(const int col) const { return NoDiagnostics(); }
+
+  KOKKOS_INLINE_FUNCTION
+  ColumnTracers tendencies(const TracersView &buffer, const int col) const {
+    return ColumnTracers(buffer, col);
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  TestColumnTile level_tile(const int first_level, const int num_levels) const {
+    return TestColumnTile{tracers, atm.level_range(first_level, num_levels),
+                          sfc, first_level, num_levels};
+  }
+};
+
+/// Creates a TestColumnState with the given dimensions, with a uniform
+/// temperature of 300 K and tracer values that vary by tracer, column and
+/// level.
+inline TestColumnState create_column_state(const int num_tracers,
+                                           const int num_columns,
+                                           const int num_levels) {
+  TestColumnState state;
+  state.tracers = TracersView("tracers", num_tracers, num_columns, num_levels);
+  state.atm = create_atmosphere(num_levels, 100.0);
+  state.sfc = create_surface();
+
+  auto h_tracers = Kokkos::create_mirror_view(state.tracers);
+  for (int q = 0; q < num_tracers; ++q) {
+    for (int col = 0; col < num_columns; ++col) {
+      for (int k = 0; k < num_levels; ++k) {
+        h_tracers(q, col, k) = 1 + q + 0.1 * col + 0.01 * k;
+      }
+    }
+  }
+  Kokkos::deep_copy(state.tracers, h_tracers);
+  // the testing column pool owns the (mutable) atmospheric data
+  ColumnView temperature(const_cast<Real *>(state.atm.temperature.data()),
+                         num_levels);
+  Kokkos::deep_copy(temperature, 300.0);
+  return state;
+}
+
+} // namespace testing
+} // namespace haero
+
+#endif
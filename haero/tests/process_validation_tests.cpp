@@ -0,0 +1,133 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/process_validation.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "process_tests.hpp"
+
+#include <limits>
+
+using namespace haero;
+using namespace haero::testing;
+
+namespace {
+
+// Sets the given tracer value in the given state.
+void set_tracer(const TestColumnState &state, int q, int col, int k,
+                Real value) {
+  auto h_tracers = Kokkos::create_mirror_view(state.tracers);
+  Kokkos::deep_copy(h_tracers, state.tracers);
+  h_tracers(q, col, k) = value;
+  Kokkos::deep_copy(state.tracers, h_tracers);
+}
+
+} // namespace
+
+TEST_CASE("process_validation", "") {
+  const int num_tracers = 2, num_cols = 10, num_levels = 8;
+  auto state = create_column_state(num_tracers, num_cols, num_levels);
+  TestAeroConfig aero_config{num_tracers};
+  AeroProcess<TestAeroConfig, DecayProcess> decay(aero_config);
+  AeroProcess<TestAeroConfig, SourceProcess> source(aero_config);
+  static_assert(HasValidationLocation<TestAeroConfig, DecayProcess>::value,
+                "DecayProcess reports where its data is invalid!");
+  static_assert(!HasValidationLocation<TestAeroConfig, SourceProcess>::value,
+                "SourceProcess doesn't report where its data is invalid!");
+
+  // validate every other step, and every third column of a validated step
+  ValidationSampling sampling;
+  sampling.step_interval = 2;
+  sampling.column_stride = 3;
+  ProcessValidator<TestAeroConfig, DecayProcess, SourceProcess> validator(
+      num_cols, sampling, decay, source);
+  REQUIRE(validator.is_sampled(0));
+  REQUIRE(!validator.is_sampled(1));
+  REQUIRE(validator.is_sampled(4));
+
+  SECTION("valid") {
+    for (int step = 0; step < 12; ++step) {
+      REQUIRE(validator.validate(step, state) == (step % 2 == 0));
+    }
+    REQUIRE(validator.num_failures() == 0);
+    REQUIRE(validator.failures().empty());
+  }
+
+  SECTION("invalid") {
+    // the decay process rejects column 4, and column 7 has a NaN; both are
+    // checked when the column offset is 1 (steps 2 and 8)
+    set_tracer(state, 1, 4, 3, -1);
+    set_tracer(state, 0, 7, 5, std::numeric_limits<Real>::quiet_NaN());
+    for (int step = 0; step < 12; ++step) {
+      validator.validate(step, state);
+    }
+    REQUIRE(validator.num_failures() == 4);
+    auto failures = validator.failures();
+    REQUIRE(failures.size() == 4);
+    int num_rejected = 0, num_nonfinite = 0;
+    for (const auto &failure : failures) {
+      REQUIRE(((failure.step == 2) || (failure.step == 8)));
+      if (failure.process >= 0) {
+        REQUIRE(failure.process == 0);
+        REQUIRE(failure.column == 4);
+        REQUIRE(failure.tracer == 1);
+        REQUIRE(failure.level == 3);
+        REQUIRE(validator.describe(failure) ==
+                "step " + std::to_string(failure.step) +
+                    ", column 4: rejected by process decay at tracer 1, "
+                    "level 3");
+        ++num_rejected;
+      } else {
+        REQUIRE(failure.column == 7);
+        REQUIRE(failure.tracer == 0);
+        REQUIRE(failure.level == 5);
+        ++num_nonfinite;
+      }
+    }
+    REQUIRE(num_rejected == 2);
+    REQUIRE(num_nonfinite == 2);
+
+    validator.clear_failures();
+    REQUIRE(validator.num_failures() == 0);
+  }
+
+  SECTION("limited_records") {
+    // only the first failures are recorded in detail
+    ValidationSampling every_column;
+    every_column.max_failures = 3;
+    ProcessValidator<TestAeroConfig, DecayProcess> limited(
+        num_cols, every_column, decay);
+    auto bad_state = create_column_state(num_tracers, num_cols, num_levels);
+    set_tracer(bad_state, 0, 2, 0, -1);
+    for (int step = 0; step < 5; ++step) {
+      limited.validate(step, bad_state);
+    }
+    REQUIRE(limited.num_failures() == 5);
+    REQUIRE(limited.failures().size() == 3);
+  }
+
+  SECTION("concurrent") {
+    // checks run on their own execution space instance
+    auto instances =
+        Kokkos::Experimental::partition_space(ExecutionSpace(), 1, 1);
+    ProcessValidator<TestAeroConfig, DecayProcess> concurrent(num_cols,
+                                                              sampling, decay);
+    concurrent.set_execution_space(instances[1], instances[0]);
+    auto bad_state = create_column_state(num_tracers, num_cols, num_levels);
+    set_tracer(bad_state, 1, 9, 0, -1);
+    for (int step = 0; step < 12; ++step) {
+      concurrent.validate(step, bad_state);
+    }
+    // column 9 is checked when the column offset is 0 (steps 0 and 6)
+    REQUIRE(concurrent.num_failures() == 2);
+  }
+
+  SECTION("bad_sampling") {
+    ValidationSampling bad_sampling;
+    bad_sampling.column_stride = 0;
+    using Validator = ProcessValidator<TestAeroConfig, DecayProcess>;
+    REQUIRE_THROWS(Validator(num_cols, bad_sampling, decay));
+  }
+}
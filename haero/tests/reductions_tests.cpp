@@ -0,0 +1,94 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/math.hpp>
+#include <haero/reductions.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstring>
+
+using namespace haero;
+
+namespace {
+
+// Ill-conditioned terms whose naive sum depends on the summation order.
+KOKKOS_INLINE_FUNCTION
+Real term(const int k) {
+  const Real sign = (k % 2) ? -1 : 1;
+  return sign * (1 + k % 7) * pow(Real(10), Real(k % 5)) + Real(0.1) * k;
+}
+
+// Computes (on host) the reproducible sum of n terms in each of ncols columns
+// using the given team policy.
+HostType::view_1d<Real> column_sums(const ThreadTeamPolicy &policy,
+                                    const int n) {
+  DeviceType::view_1d<Real> sums("sums", policy.league_size());
+  Kokkos::parallel_for(
+      policy, KOKKOS_LAMBDA(const ThreadTeam &team) {
+        const int col = team.league_rank();
+        const Real sum =
+            reproducible_sum(team, n, [&](const int k) { return term(k); });
+        Kokkos::single(Kokkos::PerTeam(team), [&]() { sums(col) = sum; });
+      });
+  auto h_sums = Kokkos::create_mirror_view(sums);
+  Kokkos::deep_copy(h_sums, sums);
+  return h_sums;
+}
+
+} // namespace
+
+TEST_CASE("reproducible_sum", "") {
+  const int ncols = 4;
+  for (int n : {1, 7, 32, 33, 72, 128, 1000}) {
+    auto sums1 = column_sums(ThreadTeamPolicy(ncols, 1), n);
+    auto sums2 = column_sums(ThreadTeamPolicy(ncols, Kokkos::AUTO), n);
+
+    // compare with a reference sum accumulated in extended precision
+    long double ref = 0;
+    for (int k = 0; k < n; ++k) {
+      ref += term(k);
+    }
+
+    for (int col = 0; col < ncols; ++col) {
+      // results are bitwise identical for all team sizes
+      REQUIRE(std::memcmp(&sums1(col), &sums2(col), sizeof(Real)) == 0);
+      REQUIRE(sums1(col) == Approx(static_cast<double>(ref)));
+    }
+  }
+}
+
+TEST_CASE("reproducible_host_sum", "") {
+  const int n = 10000;
+  const Real sum1 =
+      ReproducibleSum<>::sum(n, KOKKOS_LAMBDA(const int k) { return term(k); });
+  const Real sum2 = ReproducibleSum<8>::sum(
+      n, KOKKOS_LAMBDA(const int k) { return term(k); });
+  long double ref = 0;
+  for (int k = 0; k < n; ++k) {
+    ref += term(k);
+  }
+  REQUIRE(sum1 == Approx(static_cast<double>(ref)));
+  REQUIRE(sum2 == Approx(static_cast<double>(ref)));
+}
+
+TEST_CASE("reproducible_integral", "") {
+  const int nlev = 72;
+  DeviceType::view_1d<Real> q("q", nlev), dp("dp", nlev);
+  Kokkos::parallel_for(
+      nlev, KOKKOS_LAMBDA(const int k) {
+        q(k) = 1e-9 * (k + 1);
+        dp(k) = 1000;
+      });
+  DeviceType::view_1d<Real> integral("integral", 1);
+  Kokkos::parallel_for(
+      ThreadTeamPolicy(1, Kokkos::AUTO), KOKKOS_LAMBDA(const ThreadTeam &team) {
+        const Real value = reproducible_integral(team, nlev, q, dp);
+        Kokkos::single(Kokkos::PerTeam(team), [&]() { integral(0) = value; });
+      });
+  auto h_integral = Kokkos::create_mirror_view(integral);
+  Kokkos::deep_copy(h_integral, integral);
+  REQUIRE(h_integral(0) == Approx(1e-6 * nlev * (nlev + 1) / 2));
+}
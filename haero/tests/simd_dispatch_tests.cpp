@@ -0,0 +1,90 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/simd_dispatch.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace haero;
+
+namespace {
+const SimdIsa all_isas[] = {SimdIsa::generic, SimdIsa::avx2, SimdIsa::avx512};
+}
+
+TEST_CASE("simd_isa_selection", "") {
+  for (SimdIsa isa : all_isas) {
+    REQUIRE(simd_isa_from_name(simd_isa_name(isa)) == isa);
+  }
+  REQUIRE_THROWS(simd_isa_from_name("sse9"));
+
+  // the generic kernels are always available, and the widest instruction set
+  // is chosen by default
+  REQUIRE(simd_isa_supported(SimdIsa::generic));
+  const SimdIsa widest = widest_simd_isa();
+  REQUIRE(simd_isa_supported(widest));
+  REQUIRE(select_simd_isa(nullptr) == widest);
+  REQUIRE(select_simd_isa("") == widest);
+  REQUIRE(select_simd_isa("auto") == widest);
+  REQUIRE(select_simd_isa("generic") == SimdIsa::generic);
+  REQUIRE_THROWS(select_simd_isa("sse9"));
+  for (SimdIsa isa : all_isas) {
+    if (simd_isa_supported(isa)) {
+      REQUIRE(select_simd_isa(simd_isa_name(isa)) == isa);
+    } else {
+      REQUIRE_THROWS(select_simd_isa(simd_isa_name(isa)));
+      REQUIRE_THROWS(simd_kernels(isa));
+    }
+  }
+
+  // the selection honors HAERO_SIMD_ISA
+  REQUIRE(selected_simd_isa() ==
+          select_simd_isa(std::getenv("HAERO_SIMD_ISA")));
+  REQUIRE(simd_kernels().isa == selected_simd_isa());
+  std::cout << "Widest supported SIMD instruction set: "
+            << simd_isa_name(widest) << "\n"
+            << "Selected SIMD instruction set: "
+            << simd_isa_name(selected_simd_isa()) << "\n";
+}
+
+TEST_CASE("simd_kernels_integrate", "") {
+  // the tracers are stored with padding between them, and the numbers of
+  // levels include partial vectors for every instruction set
+  const int ntracers = 5;
+  for (int nlev : {1, 7, 16, 72, 133}) {
+    const int stride = nlev + 3;
+    std::vector<Real> q(ntracers * stride), w(nlev);
+    for (int k = 0; k < nlev; ++k) {
+      w[k] = 500 + 10 * k;
+      for (int i = 0; i < ntracers; ++i) {
+        q[i * stride + k] = 1e-9 * (i + 1) * (k + 1);
+      }
+    }
+    const Real scale = 0.25;
+    for (SimdIsa isa : all_isas) {
+      if (!simd_isa_supported(isa)) {
+        continue;
+      }
+      const SimdKernels &kernels = simd_kernels(isa);
+      REQUIRE(kernels.isa == isa);
+      REQUIRE(kernels.pack_size >= 1);
+      std::vector<Real> integrals(ntracers);
+      kernels.integrate(ntracers, nlev, q.data(), stride, w.data(), scale,
+                        integrals.data());
+      for (int i = 0; i < ntracers; ++i) {
+        double ref = 0;
+        for (int k = 0; k < nlev; ++k) {
+          ref += double(q[i * stride + k]) * w[k];
+        }
+        ref *= scale;
+        const double tol = std::is_same<Real, float>::value ? 1e-5 : 1e-12;
+        REQUIRE(std::abs(integrals[i] - ref) <= tol * std::abs(ref));
+      }
+    }
+  }
+}
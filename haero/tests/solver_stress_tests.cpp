@@ -0,0 +1,322 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/haero.hpp>
+#include <haero/utils.hpp>
+
+#include <Kokkos_Random.hpp>
+#include <catch2/catch.hpp>
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include "math_tests.hpp"
+
+using namespace haero;
+
+// These tests solve large numbers of randomly generated root-finding problems
+// in parallel, checking the solution, failure flag and iteration count of every
+// solve and reporting the throughput of each solver. The number of solves per
+// test defaults to a value suitable for routine testing; set the
+// HAERO_STRESS_SOLVES environment variable to run millions of them before a
+// deployment.
+
+namespace {
+
+using RandomPool = Kokkos::Random_XorShift64_Pool<ExecutionSpace>;
+
+// Tallies accumulated over all solves in a stress test.
+struct SolveStats {
+  int num_solves;    // number of solves performed
+  int num_failures;  // number of solves whose fail flag was set
+  int num_incorrect; // number of solves with an incorrect solution
+  long total_iters;  // total number of iterations over all solves
+  int max_iters;     // largest number of iterations for a single solve
+};
+
+// A Kokkos reducer that combines the tallies of individual solves.
+struct SolveStatsReducer {
+  using reducer = SolveStatsReducer;
+  using value_type = SolveStats;
+  using result_view_type =
+      Kokkos::View<value_type, Kokkos::HostSpace, Kokkos::MemoryUnmanaged>;
+
+  KOKKOS_INLINE_FUNCTION
+  explicit SolveStatsReducer(value_type &value) : value_(value) {}
+
+  KOKKOS_INLINE_FUNCTION
+  void join(value_type &dest, const value_type &src) const {
+    dest.num_solves += src.num_solves;
+    dest.num_failures += src.num_failures;
+    dest.num_incorrect += src.num_incorrect;
+    dest.total_iters += src.total_iters;
+    dest.max_iters = (src.max_iters > dest.max_iters) ? src.max_iters
+                                                      : dest.max_iters;
+  }
+
+  KOKKOS_INLINE_FUNCTION
+  void init(value_type &value) const { value = SolveStats{0, 0, 0, 0, 0}; }
+
+  KOKKOS_INLINE_FUNCTION
+  value_type &reference() const { return value_; }
+
+  KOKKOS_INLINE_FUNCTION
+  result_view_type view() const { return result_view_type(&value_); }
+
+  KOKKOS_INLINE_FUNCTION
+  bool references_scalar() const { return true; }
+
+private:
+  value_type &value_;
+};
+
+// Records the outcome of a single solve.
+KOKKOS_INLINE_FUNCTION
+void record(SolveStats &stats, const bool fail, const bool correct,
+            const int iters) {
+  stats.num_solves += 1;
+  stats.num_failures += fail ? 1 : 0;
+  stats.num_incorrect += correct ? 0 : 1;
+  stats.total_iters += iters;
+  stats.max_iters = (iters > stats.max_iters) ? iters : stats.max_iters;
+}
+
+// Returns the number of solves to perform in each stress test.
+int num_stress_solves() {
+  const char *env = std::getenv("HAERO_STRESS_SOLVES");
+  const int n = env ? std::atoi(env) : (1 << 16);
+  EKAT_REQUIRE_MSG(n > 0, "HAERO_STRESS_SOLVES must be a positive integer!");
+  return n;
+}
+
+// Performs n solves with the given kernel, which is called as
+// kernel(i, stats) for the ith solve, and reports their throughput.
+template <typename Kernel>
+SolveStats run_stress_test(const std::string &name, const int n,
+                           const Kernel &kernel) {
+  SolveStats stats;
+  Kokkos::Timer timer;
+  Kokkos::parallel_reduce("haero::solver_stress_test",
+                          Kokkos::RangePolicy<ExecutionSpace>(0, n), kernel,
+                          SolveStatsReducer(stats));
+  Kokkos::fence();
+  const double elapsed = timer.seconds();
+  std::cout << std::left << std::setw(40) << name << std::right
+            << std::setw(10) << stats.num_solves << " solves, "
+            << std::setw(12) << std::setprecision(4)
+            << stats.num_solves / elapsed << " solves/s, "
+            << std::setprecision(3)
+            << double(stats.total_iters) / stats.num_solves
+            << " iters/solve (max " << stats.max_iters << "), "
+            << stats.num_failures << " failures, " << stats.num_incorrect
+            << " incorrect\n";
+  return stats;
+}
+
+// Convergence tolerance for unit-scale problems.
+constexpr Real conv_tol = 100 * FloatingPoint<Real>::zero_tol;
+
+// Tolerance for the accuracy of a solution to a unit-scale problem.
+constexpr Real check_tol = 1000 * FloatingPoint<Real>::zero_tol;
+
+// Solves random cubics with three well-separated roots, bracketing the middle
+// root. Newton's method starts within the basin of attraction of the middle
+// root, and the bracketed solvers start at the midpoint of the bracket.
+template <template <typename> class Solver>
+SolveStats stress_random_cubics(const std::string &name, const int n,
+                                const RandomPool &pool) {
+  using Cubic = math::CubicWithRoots<Real>;
+  return run_stress_test(
+      name, n, KOKKOS_LAMBDA(const int i, SolveStats &stats) {
+        auto gen = pool.get_state();
+        const Real r2 = gen.drand(-0.5, 0.5);
+        const Real gap1 = gen.drand(0.1, 1.0), gap2 = gen.drand(0.1, 1.0);
+        const Real a = r2 - gen.drand(0.05, 0.95) * gap1;
+        const Real b = r2 + gen.drand(0.05, 0.95) * gap2;
+        const Real min_gap = (gap1 < gap2) ? gap1 : gap2;
+        const Real x0 = r2 + gen.drand(-0.25, 0.25) * min_gap;
+        pool.free_state(gen);
+
+        const Cubic cubic(r2 - gap1, r2, r2 + gap2);
+        const bool bracketed =
+            !std::is_same<Solver<Cubic>, math::NewtonSolver<Cubic>>::value;
+        Solver<Cubic> solver(bracketed ? 0.5 * (a + b) : x0, a, b, conv_tol,
+                             cubic);
+        const Real x = solver.solve();
+        // the solution must also lie within the bracket
+        const bool correct = (x >= a) && (x <= b) &&
+                             FloatingPoint<Real>::equiv(x, r2, check_tol);
+        record(stats, solver.fail, correct, solver.counter);
+      });
+}
+
+// Solves the Kohler equation for the wet radius of particles over physical
+// ranges of relative humidity, hygroscopicity and dry radius, checking that
+// each solution lies within its bracket and that the residual there is
+// consistent with the convergence tolerance.
+template <template <typename> class Solver>
+SolveStats stress_kohler(const std::string &name, const int n,
+                         const RandomPool &pool) {
+  using Kohler = math::KohlerTestPolynomial<Real>;
+  return run_stress_test(
+      name, n, KOKKOS_LAMBDA(const int i, SolveStats &stats) {
+        auto gen = pool.get_state();
+        const Real rel_humidity = gen.drand(0.05, 0.99);
+        const Real hygroscopicity = gen.drand(1e-6, 1.3);
+        // dry radii are distributed logarithmically over [1 nm, 10 microns]
+        const Real dry_radius = pow(Real(10), Real(gen.drand(-3, 1)));
+        pool.free_state(gen);
+
+        // For relative humidity below 1, the wet radius satisfies
+        // r^3 <= rd^3 (1 + B/|log s|) (the Kelvin effect only shrinks it), so
+        // the root is bracketed by [rd, 25 rd] over these ranges.
+        const Kohler kohler(rel_humidity, hygroscopicity, dry_radius);
+        const Real a = dry_radius, b = 25 * dry_radius;
+        const Real tol = conv_tol * b;
+        Solver<Kohler> solver(0.5 * (a + b), a, b, tol, kohler);
+        const Real r = solver.solve();
+
+        // the residual must be explained by the tolerance and roundoff
+        const Real magnitude =
+            abs(kohler.log_rh) * pow(r, 4) + kohler.kelvin_a * cube(r) +
+            (kohler.hygroscopicity - kohler.log_rh) *
+                kohler.dry_radius_cubed * r +
+            kohler.kelvin_a * kohler.dry_radius_cubed;
+        const Real bound =
+            10 * (abs(kohler.derivative(r)) * tol +
+                  100 * FloatingPoint<Real>::zero_tol * magnitude);
+        const bool correct = (r >= a) && (r <= b) && (abs(kohler(r)) <= bound);
+        record(stats, solver.fail, correct, solver.counter);
+      });
+}
+
+// Solves random cubics whose brackets are nearly degenerate: the middle root
+// lies just inside one endpoint of the bracket, and the bracket itself may be
+// only a few tolerances wide, so Newton steps that converge may land outside
+// it.
+template <template <typename> class Solver>
+SolveStats stress_degenerate_brackets(const std::string &name, const int n,
+                                      const RandomPool &pool) {
+  using Cubic = math::CubicWithRoots<Real>;
+  return run_stress_test(
+      name, n, KOKKOS_LAMBDA(const int i, SolveStats &stats) {
+        auto gen = pool.get_state();
+        const Real r2 = gen.drand(-0.5, 0.5);
+        const Real gap1 = gen.drand(0.1, 1.0), gap2 = gen.drand(0.1, 1.0);
+        const Real min_gap = (gap1 < gap2) ? gap1 : gap2;
+        const bool tiny = (gen.rand(2) == 0);
+        const Real width = tiny ? gen.drand(2, 10) * conv_tol
+                                : gen.drand(0.05, 0.95) * min_gap;
+        const bool root_at_left = (gen.rand(2) == 0);
+        pool.free_state(gen);
+
+        const Real delta = 2 * conv_tol;
+        const Real a = root_at_left ? r2 - delta : r2 - width;
+        const Real b = root_at_left ? r2 + width : r2 + delta;
+        const Cubic cubic(r2 - gap1, r2, r2 + gap2);
+        Solver<Cubic> solver(0.5 * (a + b), a, b, conv_tol, cubic);
+        const Real x = solver.solve();
+        // the solution must also lie within the bracket
+        const bool correct = (x >= a) && (x <= b) &&
+                             FloatingPoint<Real>::equiv(x, r2, check_tol);
+        record(stats, solver.fail, correct, solver.counter);
+      });
+}
+
+// Applies Newton's method to random parabolas with no real roots, starting at
+// the vertex, where the derivative vanishes. Every solve must fail and return
+// NaN.
+SolveStats stress_no_roots(const std::string &name, const int n,
+                           const RandomPool &pool) {
+  using Parabola = math::MonicParabola<Real>;
+  return run_stress_test(
+      name, n, KOKKOS_LAMBDA(const int i, SolveStats &stats) {
+        auto gen = pool.get_state();
+        Parabola parabola;
+        parabola.a = gen.drand(-2, 2);
+        parabola.b = square(parabola.a) / 4 + gen.drand(0.01, 10);
+        pool.free_state(gen);
+
+        const Real vertex = -parabola.a / 2;
+        math::NewtonSolver<Parabola> solver(vertex, vertex - 1, vertex + 1,
+                                            conv_tol, parabola);
+        const Real x = solver.solve();
+        // here, a "correct" solve is one that reports its failure
+        record(stats, false, solver.fail && isnan(x), solver.counter);
+      });
+}
+
+} // namespace
+
+TEST_CASE("solver_stress_random_cubics", "") {
+  using Cubic = math::CubicWithRoots<Real>;
+  const int n = num_stress_solves();
+  RandomPool pool(80801);
+
+  auto newton =
+      stress_random_cubics<math::NewtonSolver>("cubics (newton)", n, pool);
+  auto bisection = stress_random_cubics<math::BisectionSolver>(
+      "cubics (bisection)", n, pool);
+  auto bracketed = stress_random_cubics<math::BracketedNewtonSolver>(
+      "cubics (bracketed newton)", n, pool);
+
+  for (const auto &stats : {newton, bisection, bracketed}) {
+    REQUIRE(stats.num_solves == n);
+    REQUIRE(stats.num_failures == 0);
+    REQUIRE(stats.num_incorrect == 0);
+    REQUIRE(stats.max_iters < math::NewtonSolver<Cubic>::max_iter);
+  }
+
+  // Newton's method converges quadratically from within the basin of
+  // attraction, and bisection needs about log2(width/tol) iterations.
+  REQUIRE(newton.max_iters <= 20);
+  REQUIRE(bisection.max_iters <= std::ceil(std::log2(2.0 / conv_tol)) + 1);
+}
+
+TEST_CASE("solver_stress_kohler", "") {
+  using Kohler = math::KohlerTestPolynomial<Real>;
+  const int n = num_stress_solves();
+  RandomPool pool(80802);
+
+  auto bisection =
+      stress_kohler<math::BisectionSolver>("kohler (bisection)", n, pool);
+  auto bracketed = stress_kohler<math::BracketedNewtonSolver>(
+      "kohler (bracketed newton)", n, pool);
+
+  for (const auto &stats : {bisection, bracketed}) {
+    REQUIRE(stats.num_solves == n);
+    REQUIRE(stats.num_failures == 0);
+    REQUIRE(stats.num_incorrect == 0);
+    REQUIRE(stats.max_iters < math::BisectionSolver<Kohler>::max_iter);
+  }
+}
+
+TEST_CASE("solver_stress_degenerate_brackets", "") {
+  const int n = num_stress_solves();
+  RandomPool pool(80803);
+
+  auto bisection = stress_degenerate_brackets<math::BisectionSolver>(
+      "degenerate brackets (bisection)", n, pool);
+  auto bracketed = stress_degenerate_brackets<math::BracketedNewtonSolver>(
+      "degenerate brackets (bracketed newton)", n, pool);
+
+  for (const auto &stats : {bisection, bracketed}) {
+    REQUIRE(stats.num_solves == n);
+    REQUIRE(stats.num_failures == 0);
+    REQUIRE(stats.num_incorrect == 0);
+  }
+}
+
+TEST_CASE("solver_stress_no_roots", "") {
+  const int n = num_stress_solves();
+  RandomPool pool(80804);
+
+  auto newton = stress_no_roots("no roots (newton)", n, pool);
+  REQUIRE(newton.num_solves == n);
+  REQUIRE(newton.num_incorrect == 0);
+  REQUIRE(newton.max_iters <
+          math::NewtonSolver<math::MonicParabola<Real>>::max_iter);
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/staging_pipeline.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+using namespace haero;
+
+namespace {
+
+// The value of the given tracer in the given column and level.
+Real tracer_value(int q, int col, int k) {
+  return 1 + q + 0.1 * col + 1e-3 * k;
+}
+
+// Creates host tracer data with the above values.
+StagingPipeline::HostTracersView create_host_tracers(int num_tracers,
+                                                     int num_cols,
+                                                     int num_levels) {
+  StagingPipeline::HostTracersView tracers("tracers", num_tracers, num_cols,
+                                           num_levels);
+  for (int q = 0; q < num_tracers; ++q) {
+    for (int col = 0; col < num_cols; ++col) {
+      for (int k = 0; k < num_levels; ++k) {
+        tracers(q, col, k) = tracer_value(q, col, k);
+      }
+    }
+  }
+  return tracers;
+}
+
+} // namespace
+
+TEST_CASE("staging_pipeline", "") {
+  const int num_tracers = 3, num_cols = 29, num_levels = 17;
+
+  // the output is 2*q + global column index, which tests that each chunk is
+  // given the right first column
+  auto compute = [](const ExecutionSpace &instance, const TracersView &input,
+                    const TracersView &output, int first_column) {
+    const int num_columns = input.extent(1), num_levels = input.extent(2);
+    Kokkos::parallel_for(
+        "staging_pipeline_test",
+        Kokkos::RangePolicy<ExecutionSpace>(
+            instance, 0, input.extent(0) * num_columns * num_levels),
+        KOKKOS_LAMBDA(const int i) {
+          const int q = i / (num_columns * num_levels);
+          const int col = (i / num_levels) % num_columns, k = i % num_levels;
+          output(q, col, k) = 2 * input(q, col, k) + first_column + col;
+        });
+  };
+
+  auto check = [&](const StagingPipeline::HostTracersView &output) {
+    for (int q = 0; q < num_tracers; ++q) {
+      for (int col = 0; col < num_cols; ++col) {
+        for (int k = 0; k < num_levels; ++k) {
+          REQUIRE(output(q, col, k) ==
+                  Approx(2 * tracer_value(q, col, k) + col));
+        }
+      }
+    }
+  };
+
+  // chunk sizes that divide the columns unevenly, evenly, and not at all
+  const std::vector<int> chunk_sizes = {1, 4, 7, num_cols, 2 * num_cols};
+  for (int chunk_size : chunk_sizes) {
+    StagingPipeline pipeline(num_tracers, num_levels, chunk_size);
+    REQUIRE(pipeline.chunk_size() == chunk_size);
+    REQUIRE(pipeline.num_chunks(num_cols) ==
+            (num_cols + chunk_size - 1) / chunk_size);
+
+    // separate input and output, run twice to reuse the buffers
+    auto input = create_host_tracers(num_tracers, num_cols, num_levels);
+    StagingPipeline::HostTracersView output("output", num_tracers, num_cols,
+                                            num_levels);
+    for (int pass = 0; pass < 2; ++pass) {
+      pipeline.run(input, output, compute);
+      check(output);
+    }
+
+    // in-place update
+    pipeline.run(input, input, compute);
+    check(input);
+  }
+
+  SECTION("bad_dimensions") {
+    StagingPipeline pipeline(num_tracers, num_levels, 4);
+    auto input = create_host_tracers(num_tracers, num_cols, num_levels);
+    StagingPipeline::HostTracersView output("output", num_tracers,
+                                            num_cols + 1, num_levels);
+    REQUIRE_THROWS(pipeline.run(input, output, compute));
+    REQUIRE_THROWS(StagingPipeline(num_tracers, num_levels, 0));
+  }
+}
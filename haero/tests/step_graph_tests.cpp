@@ -0,0 +1,158 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/process_group.hpp>
+
+#include <catch2/catch.hpp>
+
+#include "process_tests.hpp"
+
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace haero;
+using namespace haero::testing;
+
+// These tests check that a ProcessGroup step recorded as a graph and replayed
+// matches the same step launched kernel by kernel, and compare the throughput
+// of the two at low column counts, where launch overhead matters most. Set
+// the HAERO_BENCHMARK_STEPS environment variable to change the number of
+// steps timed.
+
+namespace {
+
+using Group = ProcessGroup<TestAeroConfig, DecayProcess, ExchangeProcess>;
+
+// Returns the number of steps to time in each benchmark.
+int num_benchmark_steps() {
+  const char *env = std::getenv("HAERO_BENCHMARK_STEPS");
+  const int n = env ? std::atoi(env) : 200;
+  EKAT_REQUIRE_MSG(n > 0, "HAERO_BENCHMARK_STEPS must be a positive integer!");
+  return n;
+}
+
+// Creates a group of processes with the given dimensions.
+Group create_group(int num_tracers, int num_cols, int num_levels) {
+  TestAeroConfig aero_config{num_tracers};
+  return Group(num_tracers, num_cols, num_levels,
+               AeroProcess<TestAeroConfig, DecayProcess>(aero_config),
+               AeroProcess<TestAeroConfig, ExchangeProcess>(aero_config));
+}
+
+// Returns a copy of the tracers of the given state on host.
+TracersView::HostMirror host_tracers(const TestColumnState &state) {
+  auto h_tracers = Kokkos::create_mirror(state.tracers);
+  Kokkos::deep_copy(h_tracers, state.tracers);
+  return h_tracers;
+}
+
+} // namespace
+
+TEST_CASE("step_graph", "") {
+  const int num_tracers = 3, num_cols = 5, num_levels = 9;
+  auto group = create_group(num_tracers, num_cols, num_levels);
+  REQUIRE(!group.has_recorded_step());
+  REQUIRE_THROWS(group.replay_step(0.0, 1.0));
+
+  // takes the same steps eagerly and by replaying a recorded step, with
+  // different step sizes, and compares the results
+  auto check_replay = [&]() {
+    auto eager_state = create_column_state(num_tracers, num_cols, num_levels);
+    auto graph_state = create_column_state(num_tracers, num_cols, num_levels);
+    group.record_step(graph_state);
+    REQUIRE(group.has_recorded_step());
+    const Real dts[] = {10.0, 30.0, 20.0};
+    Real t = 0;
+    for (Real dt : dts) {
+      group.advance(t, dt, eager_state);
+      group.replay_step(t, dt);
+      t += dt;
+    }
+    Kokkos::fence();
+    auto q_eager = host_tracers(eager_state);
+    auto q_graph = host_tracers(graph_state);
+    auto q_init = host_tracers(
+        create_column_state(num_tracers, num_cols, num_levels));
+    for (int q = 0; q < num_tracers; ++q) {
+      for (int col = 0; col < num_cols; ++col) {
+        for (int k = 0; k < num_levels; ++k) {
+          REQUIRE(q_graph(q, col, k) == Approx(q_eager(q, col, k)));
+          REQUIRE(q_graph(q, col, k) != q_init(q, col, k));
+        }
+      }
+    }
+  };
+
+  SECTION("forward_euler") {
+    check_replay();
+#ifdef HAERO_ENABLE_GPU
+    group.set_concurrent_dispatch();
+    REQUIRE(!group.has_recorded_step());
+    check_replay();
+    group.set_sequential_dispatch();
+#endif
+    group.set_tendency_mode(TendencyMode::accumulate);
+    REQUIRE(!group.has_recorded_step());
+    check_replay();
+  }
+
+  SECTION("split") {
+    group.set_integrator(ProcessIntegrator::split);
+    check_replay();
+  }
+
+  SECTION("implicit") {
+    group.set_integrator(ProcessIntegrator::backward_euler);
+    check_replay();
+    group.set_integrator(ProcessIntegrator::rosenbrock);
+    REQUIRE(!group.has_recorded_step());
+    check_replay();
+  }
+}
+
+TEST_CASE("step_graph_benchmark", "") {
+  const int num_tracers = 4, num_levels = 72;
+  const int num_steps = num_benchmark_steps();
+  const Real dt = 1;
+
+  // reports the throughput of the given stepper for a few column counts
+  auto benchmark = [&](const std::string &name, auto &&configure) {
+    for (int num_cols : {1, 8, 64}) {
+      auto group = create_group(num_tracers, num_cols, num_levels);
+      configure(group);
+      auto state = create_column_state(num_tracers, num_cols, num_levels);
+      group.record_step(state);
+      double elapsed[2];
+      for (int replay = 0; replay < 2; ++replay) {
+        Kokkos::fence();
+        Kokkos::Timer timer;
+        for (int step = 0; step < num_steps; ++step) {
+          if (replay) {
+            group.replay_step(step * dt, dt);
+          } else {
+            group.advance(step * dt, dt, state);
+          }
+        }
+        Kokkos::fence();
+        elapsed[replay] = timer.seconds();
+      }
+      std::cout << std::left << std::setw(40)
+                << (name + " (" + std::to_string(num_cols) + " columns)")
+                << std::right << std::setprecision(4) << std::setw(12)
+                << num_steps / elapsed[0] << " eager steps/s, "
+                << std::setw(12) << num_steps / elapsed[1]
+                << " replayed steps/s\n";
+    }
+  };
+
+  benchmark("forward euler", [](Group &group) {});
+  benchmark("forward euler (accumulate)", [](Group &group) {
+    group.set_tendency_mode(TendencyMode::accumulate);
+  });
+  benchmark("split", [](Group &group) {
+    group.set_integrator(ProcessIntegrator::split);
+  });
+}
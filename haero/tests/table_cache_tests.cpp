@@ -0,0 +1,201 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/table_cache.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+
+#include <dirent.h>
+#include <unistd.h>
+
+using namespace haero;
+
+namespace {
+
+// A generator for a table of num_bins values of scale * x^2 on [0, 1],
+// which counts the tables it generates.
+struct SquareTable {
+  int num_bins;
+  Real scale;
+  int num_builds = 0;
+
+  TableKey key() const {
+    return TableKey("squares").add(num_bins).add(scale);
+  }
+
+  std::function<void(Real *)> generator() {
+    return [this](Real *values) {
+      for (int b = 0; b < num_bins; ++b) {
+        const Real x = Real(b) / (num_bins - 1);
+        values[b] = scale * x * x;
+      }
+      ++num_builds;
+    };
+  }
+};
+
+// Returns a new empty temporary directory.
+std::string temp_directory() {
+  char pattern[] = "/tmp/haero_table_cache_XXXXXX";
+  REQUIRE(mkdtemp(pattern));
+  return pattern;
+}
+
+// Returns true if the given table holds the values of the given generator.
+bool same_values(const CachedTable &table, const SquareTable &squares) {
+  for (int b = 0; b < squares.num_bins; ++b) {
+    const Real x = Real(b) / (squares.num_bins - 1);
+    if (table.data()[b] != squares.scale * x * x) {
+      return false;
+    }
+  }
+  return table.size() == std::size_t(squares.num_bins);
+}
+
+} // namespace
+
+TEST_CASE("table_key", "") {
+  const auto hash = TableKey("squares").add(16).add(Real(2)).hash(16);
+  REQUIRE(TableKey("squares").add(16).add(Real(2)).hash(16) == hash);
+  REQUIRE(TableKey("cubes").add(16).add(Real(2)).hash(16) != hash);
+  REQUIRE(TableKey("squares").add(17).add(Real(2)).hash(16) != hash);
+  REQUIRE(TableKey("squares").add(Real(2)).add(16).hash(16) != hash);
+  REQUIRE(TableKey("squares").add(16).add(Real(2)).hash(17) != hash);
+  REQUIRE(TableKey("squares").add(16).add(Real(2)).add("ab").hash(16) !=
+          TableKey("squares").add(16).add(Real(2)).add("a").add("b").hash(16));
+  REQUIRE_THROWS(TableKey(""));
+  REQUIRE_THROWS(TableKey("../squares"));
+
+  // the file name includes the table's name
+  const TableCache cache("/some/dir");
+  const std::string path = cache.path(TableKey("squares").add(16), 16);
+  REQUIRE(path.find("/some/dir/squares-") == 0);
+  REQUIRE(path.substr(path.size() - 4) == ".tbl");
+}
+
+TEST_CASE("table_cache_round_trip", "") {
+  const std::string directory = temp_directory();
+  // the cache creates missing directories
+  TableCache cache(directory + "/tables");
+  REQUIRE(cache.enabled());
+  SquareTable squares{64, 2};
+
+  // the first request generates the table and stores it, and later requests
+  // (here and in other caches) map it from its file
+  auto table = cache.table(squares.key(), 64, squares.generator());
+  REQUIRE(squares.num_builds == 1);
+  REQUIRE(!table->from_cache());
+  REQUIRE(same_values(*table, squares));
+  auto cached = cache.table(squares.key(), 64, squares.generator());
+  REQUIRE(squares.num_builds == 1);
+  REQUIRE(cached->from_cache());
+  REQUIRE(same_values(*cached, squares));
+  TableCache other_cache(directory + "/tables");
+  memory::ViewTracker tracker;
+  auto d_table =
+      other_cache.device_table(squares.key(), 64, squares.generator(),
+                               tracker, "table_cache_tests");
+  REQUIRE(squares.num_builds == 1);
+  REQUIRE(other_cache.num_hits() == 1);
+  REQUIRE(memory::is_tracked(d_table.data()));
+  auto h_table = Kokkos::create_mirror_view(d_table);
+  Kokkos::deep_copy(h_table, d_table);
+  for (int b = 0; b < 64; ++b) {
+    REQUIRE(h_table(b) == table->data()[b]);
+  }
+
+  // different parameters give a different table
+  SquareTable scaled{64, 3};
+  auto scaled_table = cache.table(scaled.key(), 64, scaled.generator());
+  REQUIRE(scaled.num_builds == 1);
+  REQUIRE(same_values(*scaled_table, scaled));
+  REQUIRE(cache.path(scaled.key(), 64) != cache.path(squares.key(), 64));
+  REQUIRE(cache.num_hits() == 1);
+  REQUIRE(cache.num_misses() == 2);
+  REQUIRE(cache.num_rejected() == 0);
+
+  std::remove(cache.path(squares.key(), 64).c_str());
+  std::remove(cache.path(scaled.key(), 64).c_str());
+  rmdir(cache.directory().c_str());
+  rmdir(directory.c_str());
+}
+
+TEST_CASE("table_cache_integrity", "") {
+  const std::string directory = temp_directory();
+  TableCache cache(directory);
+  SquareTable squares{32, 1};
+  const std::string path = cache.path(squares.key(), 32);
+  cache.table(squares.key(), 32, squares.generator());
+
+  // a corrupted value is detected, and the table is regenerated and stored
+  // again
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    file.seekp(64 + 5 * sizeof(Real) + 1);
+    file.put(0x5a);
+  }
+  auto table = cache.table(squares.key(), 32, squares.generator());
+  REQUIRE(squares.num_builds == 2);
+  REQUIRE(cache.num_rejected() == 1);
+  REQUIRE(same_values(*table, squares));
+  REQUIRE(cache.table(squares.key(), 32, squares.generator())->from_cache());
+
+  // so are a truncated file, an empty file, and a file with the wrong size
+  REQUIRE(truncate(path.c_str(), 64 + 10 * sizeof(Real)) == 0);
+  cache.table(squares.key(), 32, squares.generator());
+  REQUIRE(truncate(path.c_str(), 0) == 0);
+  cache.table(squares.key(), 32, squares.generator());
+  REQUIRE(squares.num_builds == 4);
+  REQUIRE(cache.num_rejected() == 3);
+
+  // a table with the same key but a different size has its own file, so
+  // tables of both sizes stay cached
+  SquareTable larger{48, 1};
+  REQUIRE(cache.path(squares.key(), 48) != path);
+  const int num_misses = cache.num_misses();
+  cache.table(squares.key(), 48, larger.generator());
+  REQUIRE(cache.num_misses() == num_misses + 1);
+  REQUIRE(cache.table(squares.key(), 48, larger.generator())->from_cache());
+  REQUIRE(cache.table(squares.key(), 32, squares.generator())->from_cache());
+  REQUIRE(larger.num_builds == 1);
+  REQUIRE(squares.num_builds == 4);
+  REQUIRE(cache.num_rejected() == 3);
+
+  // no temporary files are left behind
+  int num_files = 0;
+  if (DIR *dir = opendir(directory.c_str())) {
+    while (struct dirent *entry = readdir(dir)) {
+      num_files += (entry->d_name[0] != '.');
+    }
+    closedir(dir);
+  }
+  REQUIRE(num_files == 2);
+
+  std::remove(cache.path(squares.key(), 48).c_str());
+  std::remove(path.c_str());
+  rmdir(directory.c_str());
+}
+
+TEST_CASE("table_cache_disabled", "") {
+  TableCache cache;
+  REQUIRE(!cache.enabled());
+  SquareTable squares{16, 1};
+  for (int i = 0; i < 2; ++i) {
+    auto table = cache.table(squares.key(), 16, squares.generator());
+    REQUIRE(!table->from_cache());
+    REQUIRE(same_values(*table, squares));
+  }
+  REQUIRE(squares.num_builds == 2);
+  REQUIRE(cache.num_misses() == 2);
+
+  // the cache's directory can come from the environment
+  setenv("HAERO_TABLE_CACHE", "/some/dir", 1);
+  REQUIRE(TableCache::from_environment().directory() == "/some/dir");
+  unsetenv("HAERO_TABLE_CACHE");
+  REQUIRE(!TableCache::from_environment().enabled());
+}
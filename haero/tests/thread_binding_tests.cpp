@@ -0,0 +1,49 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/thread_binding.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+
+using namespace haero;
+
+TEST_CASE("thread_bindings_report", "") {
+  auto bindings = thread_bindings();
+  REQUIRE(bindings.size() >= 1);
+  for (size_t i = 0; i < bindings.size(); ++i) {
+    REQUIRE(bindings[i].thread == static_cast<int>(i));
+  }
+
+  std::ostringstream ss;
+  report_thread_bindings(bindings, ss);
+  REQUIRE(ss.str().find("thread 0: cpu") != std::string::npos);
+  std::cout << ss.str();
+}
+
+TEST_CASE("thread_bindings_validate", "") {
+  // two threads pinned to distinct CPUs on one NUMA node
+  std::vector<ThreadBinding> pinned = {{0, 0, 0, {0}, {0}},
+                                       {1, 1, 0, {1}, {0}}};
+  REQUIRE(validate_thread_bindings(pinned).empty());
+
+  // threads allowed to run on a single NUMA node are fine, too
+  std::vector<ThreadBinding> per_node = {{0, 0, 0, {0, 1}, {0}},
+                                         {1, 3, 1, {2, 3}, {1}}};
+  REQUIRE(validate_thread_bindings(per_node).empty());
+
+  // unpinned threads may migrate across sockets
+  std::vector<ThreadBinding> unpinned = {{0, 0, 0, {0, 1, 2, 3}, {0, 1}},
+                                         {1, 2, 1, {0, 1, 2, 3}, {0, 1}}};
+  REQUIRE(validate_thread_bindings(unpinned).size() == 2);
+
+  // oversubscribed CPUs
+  std::vector<ThreadBinding> oversubscribed = {{0, 0, 0, {0}, {0}},
+                                               {1, 0, 0, {0}, {0}},
+                                               {2, 1, 0, {1}, {0}}};
+  auto problems = validate_thread_bindings(oversubscribed);
+  REQUIRE(problems.size() == 1);
+  REQUIRE(problems[0].find("threads 0-1") != std::string::npos);
+}
@@ -0,0 +1,58 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/utils.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace haero;
+
+TEST_CASE("vector_is_monotone", "") {
+  REQUIRE(vector_is_monotone({1.0, 2.0, 3.0}));
+  REQUIRE(vector_is_monotone({3.0, 2.0, 1.0}));
+  REQUIRE(!vector_is_monotone({1.0, 3.0, 2.0}));
+  REQUIRE(!vector_is_monotone({1.0, 1.0, 2.0}));
+}
+
+TEST_CASE("progress_bar", "") {
+  const int num_threads = 4;
+  const int steps_per_thread = 2500;
+  const int num_steps = num_threads * steps_per_thread;
+
+  std::ostringstream text, json;
+  {
+    ProgressBar progress("progress_bar_test", num_steps, 25.0, text);
+    progress.set_json_output(json);
+    progress.set_report_interval(0.01);
+
+    // update the progress bar concurrently from several threads
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.emplace_back([&progress]() {
+        for (int s = 0; s < steps_per_thread; ++s) {
+          progress.update(72);
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    REQUIRE(progress.iterations_completed() == num_steps);
+  } // final report is written here
+
+  const std::string out = text.str();
+  REQUIRE(out.find("progress_bar_test: 100%") != std::string::npos);
+  REQUIRE(out.find("steps/s") != std::string::npos);
+  REQUIRE(out.find("columns/s") != std::string::npos);
+  REQUIRE(out.find("ETA") != std::string::npos);
+
+  const std::string js = json.str();
+  REQUIRE(js.find("\"step\": 10000") != std::string::npos);
+  REQUIRE(js.find("\"eta_s\"") != std::string::npos);
+  REQUIRE(js.back() == '\n');
+}
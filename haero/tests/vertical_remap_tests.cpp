@@ -0,0 +1,169 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include <haero/math.hpp>
+#include <haero/memory.hpp>
+#include <haero/vertical_remap.hpp>
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+using namespace haero;
+
+namespace {
+
+// Returns host views of source and target level thicknesses for the given
+// numbers of columns and levels. Source levels are perturbed randomly from
+// the uniform target levels, like Lagrangian levels after some steps, and
+// both grids have the same total thickness in each column.
+void create_grids(int ncols, int nlev, HostType::view_2d<Real> &source_dp,
+                  HostType::view_2d<Real> &target_dp) {
+  std::mt19937 gen(ncols * nlev);
+  std::uniform_real_distribution<Real> perturbation(0.4, 1.6);
+  source_dp = HostType::view_2d<Real>("source_dp", ncols, nlev);
+  target_dp = HostType::view_2d<Real>("target_dp", ncols, nlev);
+  for (int col = 0; col < ncols; ++col) {
+    Real total = 0;
+    for (int k = 0; k < nlev; ++k) {
+      source_dp(col, k) = perturbation(gen);
+      total += source_dp(col, k);
+    }
+    for (int k = 0; k < nlev; ++k) {
+      target_dp(col, k) = total / nlev;
+    }
+  }
+}
+
+// Remaps the given host tracers in place.
+void remap(const VerticalRemap &remap, const HostType::view_3d<Real> &h_q,
+           const HostType::view_2d<Real> &h_source_dp,
+           const HostType::view_2d<Real> &h_target_dp) {
+  const int ntracers = h_q.extent(0), ncols = h_q.extent(1),
+            nlev = h_q.extent(2);
+  TracersView q("q", ntracers, ncols, nlev);
+  DeviceType::view_2d<Real> source_dp("source_dp", ncols, nlev);
+  DeviceType::view_2d<Real> target_dp("target_dp", ncols, nlev);
+  Kokkos::deep_copy(q, h_q);
+  Kokkos::deep_copy(source_dp, h_source_dp);
+  Kokkos::deep_copy(target_dp, h_target_dp);
+  remap.remap(q, source_dp, target_dp);
+  Kokkos::deep_copy(h_q, q);
+}
+
+} // namespace
+
+TEST_CASE("vertical_remap_conservation", "") {
+  // tracers with rough profiles are remapped between irregular grids, with a
+  // number of tracers that isn't a multiple of the Pack size
+  const int ncols = 5, ntracers = 7, nlev = 72;
+  HostType::view_2d<Real> source_dp, target_dp;
+  create_grids(ncols, nlev, source_dp, target_dp);
+  HostType::view_3d<Real> q("q", ntracers, ncols, nlev);
+  std::mt19937 gen(7);
+  std::uniform_real_distribution<Real> uniform(0, 1);
+  for (int i = 0; i < ntracers; ++i) {
+    for (int col = 0; col < ncols; ++col) {
+      for (int k = 0; k < nlev; ++k) {
+        q(i, col, k) = (i == 0)   ? 1e-9 * (1 + uniform(gen))
+                       : (i == 1) ? ((k / 9) % 2 ? 1e3 : 0)
+                                  : std::exp(-0.1 * k * i) + 0.01 * col;
+      }
+    }
+  }
+  HostType::view_3d<Real> q0("q0", ntracers, ncols, nlev);
+  Kokkos::deep_copy(q0, q);
+
+  VerticalRemap vertical_remap(ncols, ntracers, nlev);
+  REQUIRE(vertical_remap.num_levels() == nlev);
+  remap(vertical_remap, q, source_dp, target_dp);
+  for (int i = 0; i < ntracers; ++i) {
+    for (int col = 0; col < ncols; ++col) {
+      // mass is conserved to round-off, and no new extrema are created
+      double mass0 = 0, mass = 0, sum_abs = 0;
+      Real q_min = q0(i, col, 0), q_max = q0(i, col, 0);
+      for (int k = 0; k < nlev; ++k) {
+        mass0 += q0(i, col, k) * source_dp(col, k);
+        mass += q(i, col, k) * target_dp(col, k);
+        sum_abs += std::abs(q0(i, col, k) * source_dp(col, k));
+        q_min = std::min(q_min, q0(i, col, k));
+        q_max = std::max(q_max, q0(i, col, k));
+      }
+      REQUIRE(std::abs(mass - mass0) <= 4 * nlev * epsilon() * sum_abs);
+      const Real tol =
+          2 * nlev * epsilon() * std::max(std::abs(q_min), std::abs(q_max));
+      for (int k = 0; k < nlev; ++k) {
+        REQUIRE(q(i, col, k) >= q_min - tol);
+        REQUIRE(q(i, col, k) <= q_max + tol);
+      }
+    }
+  }
+}
+
+TEST_CASE("vertical_remap_accuracy", "") {
+  const int ncols = 3, ntracers = 2, nlev = 40;
+  HostType::view_2d<Real> source_dp, target_dp;
+  create_grids(ncols, nlev, source_dp, target_dp);
+
+  // tracers linear in the vertical coordinate are remapped exactly on target
+  // levels that don't overlap the top and bottom source levels, which have
+  // constant reconstructions, and constants are preserved everywhere
+  HostType::view_3d<Real> q("q", ntracers, ncols, nlev);
+  for (int col = 0; col < ncols; ++col) {
+    Real z = 0;
+    for (int k = 0; k < nlev; ++k) {
+      q(0, col, k) = 2 + 0.5 * (z + 0.5 * source_dp(col, k));
+      q(1, col, k) = 3;
+      z += source_dp(col, k);
+    }
+  }
+  VerticalRemap vertical_remap(ncols, ntracers, nlev);
+  remap(vertical_remap, q, source_dp, target_dp);
+  const Real tol = std::is_same<Real, float>::value ? 1e-5 : 1e-12;
+  for (int col = 0; col < ncols; ++col) {
+    const Real z_top = source_dp(col, 0);
+    Real z_bot = 0, z = 0;
+    for (int k = 0; k < nlev - 1; ++k) {
+      z_bot += source_dp(col, k);
+    }
+    for (int k = 0; k < nlev; ++k) {
+      if ((z >= z_top) && (z + target_dp(col, k) <= z_bot)) {
+        const Real exact = 2 + 0.5 * (z + 0.5 * target_dp(col, k));
+        REQUIRE(std::abs(q(0, col, k) - exact) <= tol * exact);
+      }
+      REQUIRE(std::abs(q(1, col, k) - 3) <= tol * 3);
+      z += target_dp(col, k);
+    }
+  }
+
+  // remapping onto the same grid changes nothing
+  HostType::view_3d<Real> q1("q1", ntracers, ncols, nlev);
+  Kokkos::deep_copy(q1, q);
+  remap(vertical_remap, q1, target_dp, target_dp);
+  for (int i = 0; i < ntracers; ++i) {
+    for (int col = 0; col < ncols; ++col) {
+      for (int k = 0; k < nlev; ++k) {
+        REQUIRE(std::abs(q1(i, col, k) - q(i, col, k)) <=
+                tol * std::abs(q(i, col, k)));
+      }
+    }
+  }
+  REQUIRE_THROWS(VerticalRemap(ncols, 0, nlev));
+
+  // a remap's workspace is recorded with Haero's memory registry until the
+  // remap is destroyed
+  const std::string space = TracersView::memory_space::name();
+  auto workspace = [&]() {
+    return memory::usage_by_category(space)["workspace"]["haero::VerticalRemap"]
+        .current_bytes;
+  };
+  const std::size_t before = workspace();
+  {
+    VerticalRemap other(ncols, ntracers, nlev);
+    REQUIRE(workspace() > before);
+  }
+  REQUIRE(workspace() == before);
+}
@@ -0,0 +1,194 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#include "thread_binding.hpp"
+#include "utils.hpp"
+
+#include <ekat/ekat_assert.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <sched.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace haero {
+
+namespace {
+
+// Returns the NUMA node of the given CPU, or -1 if it can't be determined.
+int numa_node_of(int cpu) {
+#ifdef __linux__
+  if (cpu >= 0) {
+    // the CPU's sysfs directory contains a "nodeN" link to its NUMA node
+    const std::string path =
+        "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR *dir = opendir(path.c_str());
+    if (dir) {
+      int node = -1;
+      while (struct dirent *entry = readdir(dir)) {
+        const std::string name = entry->d_name;
+        if ((name.size() > 4) && (name.compare(0, 4, "node") == 0) &&
+            std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+          node = std::atoi(name.c_str() + 4);
+          break;
+        }
+      }
+      closedir(dir);
+      return node;
+    }
+  }
+#endif
+  return -1;
+}
+
+// Returns the binding of the calling thread, which has the given index.
+ThreadBinding this_thread_binding(int thread) {
+  ThreadBinding binding{thread, -1, -1, {}, {}};
+#ifdef __linux__
+  binding.cpu = sched_getcpu();
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &mask)) {
+        binding.allowed_cpus.push_back(cpu);
+      }
+    }
+  }
+#endif
+  return binding;
+}
+
+// Writes a list of integers compactly, e.g. "0-3,8,10-11".
+std::string range_string(const std::vector<int> &values) {
+  if (values.empty()) {
+    return "?";
+  }
+  std::ostringstream ss;
+  for (size_t i = 0; i < values.size();) {
+    size_t j = i;
+    while ((j + 1 < values.size()) && (values[j + 1] == values[j] + 1)) {
+      ++j;
+    }
+    ss << ((i > 0) ? "," : "") << values[i];
+    if (j > i) {
+      ss << "-" << values[j];
+    }
+    i = j + 1;
+  }
+  return ss.str();
+}
+
+} // namespace
+
+std::vector<ThreadBinding> thread_bindings() {
+  std::vector<ThreadBinding> bindings;
+#ifdef _OPENMP
+  bindings.resize(omp_get_max_threads());
+#pragma omp parallel
+  {
+    const int thread = omp_get_thread_num();
+    bindings[thread] = this_thread_binding(thread);
+  }
+#else
+  bindings.push_back(this_thread_binding(0));
+#endif
+  // look up NUMA nodes outside of the parallel region
+  std::map<int, int> nodes;
+  auto node_of = [&](int cpu) {
+    auto iter = nodes.find(cpu);
+    if (iter == nodes.end()) {
+      iter = nodes.emplace(cpu, numa_node_of(cpu)).first;
+    }
+    return iter->second;
+  };
+  for (auto &binding : bindings) {
+    binding.numa_node = node_of(binding.cpu);
+    auto &allowed_nodes = binding.allowed_numa_nodes;
+    for (int cpu : binding.allowed_cpus) {
+      const int node = node_of(cpu);
+      if ((node >= 0) && (std::find(allowed_nodes.begin(), allowed_nodes.end(),
+                                    node) == allowed_nodes.end())) {
+        allowed_nodes.push_back(node);
+      }
+    }
+    std::sort(allowed_nodes.begin(), allowed_nodes.end());
+  }
+  return bindings;
+}
+
+void report_thread_bindings(const std::vector<ThreadBinding> &bindings,
+                            std::ostream &os) {
+  os << line_delim();
+  os << "Haero host thread bindings (" << bindings.size() << " threads):\n";
+  auto id_string = [](int id) {
+    return (id >= 0) ? std::to_string(id) : std::string("?");
+  };
+  for (const auto &binding : bindings) {
+    os << indent_string(1) << "thread " << binding.thread << ": cpu "
+       << id_string(binding.cpu) << " (NUMA node "
+       << id_string(binding.numa_node) << "), allowed cpus "
+       << range_string(binding.allowed_cpus) << " (NUMA nodes "
+       << range_string(binding.allowed_numa_nodes) << ")\n";
+  }
+  os << line_delim();
+}
+
+std::vector<std::string>
+validate_thread_bindings(const std::vector<ThreadBinding> &bindings) {
+  std::vector<std::string> problems;
+  std::map<int, std::vector<int>> threads_on_cpu; // for single-CPU bindings
+  for (const auto &binding : bindings) {
+    if (binding.allowed_numa_nodes.size() > 1) {
+      problems.push_back(
+          "thread " + std::to_string(binding.thread) +
+          " may migrate between NUMA nodes " +
+          range_string(binding.allowed_numa_nodes) +
+          " (set OMP_PROC_BIND and OMP_PLACES to pin threads)");
+    }
+    if (binding.allowed_cpus.size() == 1) {
+      threads_on_cpu[binding.allowed_cpus[0]].push_back(binding.thread);
+    }
+  }
+  for (const auto &cpu : threads_on_cpu) {
+    if (cpu.second.size() > 1) {
+      problems.push_back("threads " + range_string(cpu.second) +
+                         " are all bound to cpu " + std::to_string(cpu.first));
+    }
+  }
+  return problems;
+}
+
+void check_thread_bindings(std::ostream &os) {
+  const char *env = std::getenv("HAERO_THREAD_BINDING");
+  if (!env) {
+    return;
+  }
+  const std::string mode = env;
+  EKAT_REQUIRE_MSG((mode == "report") || (mode == "validate"),
+                   "Invalid HAERO_THREAD_BINDING: " << mode
+                                                    << " (expected 'report' "
+                                                       "or 'validate')");
+  const auto bindings = thread_bindings();
+  report_thread_bindings(bindings, os);
+  const auto problems = validate_thread_bindings(bindings);
+  for (const auto &problem : problems) {
+    os << "WARNING: " << problem << "\n";
+  }
+  EKAT_REQUIRE_MSG((mode == "report") || problems.empty(),
+                   "Host thread bindings failed validation ("
+                       << problems.size() << " problem(s) found)");
+}
+
+} // namespace haero
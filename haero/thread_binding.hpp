@@ -0,0 +1,62 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_THREAD_BINDING_HPP
+#define HAERO_THREAD_BINDING_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace haero {
+
+/// @struct ThreadBinding
+/// This type describes where a host thread runs: the CPU it was running on
+/// when queried, the CPUs it is allowed to run on, and the NUMA nodes of those
+/// CPUs. First-touch page placement (see FirstTouch) is only effective if
+/// threads stay on the NUMA node where they touched their pages.
+struct ThreadBinding {
+  /// thread index within the host thread pool
+  int thread;
+  /// CPU on which the thread was running when queried (-1 if unknown)
+  int cpu;
+  /// NUMA node of that CPU (-1 if unknown)
+  int numa_node;
+  /// CPUs on which the thread is allowed to run
+  std::vector<int> allowed_cpus;
+  /// NUMA nodes of the allowed CPUs (empty if unknown)
+  std::vector<int> allowed_numa_nodes;
+};
+
+/// On host: returns the binding of each thread in the host thread pool
+/// (OpenMP threads if Haero is built with OpenMP, otherwise the calling
+/// thread). Binding information is available only on Linux; elsewhere, CPUs
+/// and NUMA nodes are reported as unknown.
+std::vector<ThreadBinding> thread_bindings();
+
+/// On host: writes a table of the given thread bindings to the given stream.
+void report_thread_bindings(const std::vector<ThreadBinding> &bindings,
+                            std::ostream &os = std::cout);
+
+/// On host: checks the given thread bindings for configurations that defeat
+/// first-touch placement or oversubscribe cores, returning a description of
+/// each problem found (an empty vector means the bindings are fine):
+/// * a thread that may migrate between NUMA nodes (set OMP_PROC_BIND and
+///   OMP_PLACES to pin threads)
+/// * several threads bound to the same single CPU
+std::vector<std::string>
+validate_thread_bindings(const std::vector<ThreadBinding> &bindings);
+
+/// On host: reports and/or validates the bindings of the host threads as
+/// requested by the HAERO_THREAD_BINDING environment variable:
+/// * "report": writes the bindings (and any problems) to the given stream
+/// * "validate": writes the bindings to the given stream and throws an
+///   exception if any problems are found
+/// Nothing is done if the variable is unset. Call this at startup, after
+/// Kokkos has been initialized.
+void check_thread_bindings(std::ostream &os = std::cout);
+
+} // namespace haero
+
+#endif
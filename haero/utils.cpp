@@ -6,7 +6,11 @@
 
 #include <ekat/ekat_assert.hpp>
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
+#include <iomanip>
+#include <limits>
 #include <sstream>
 
 namespace haero {
@@ -81,4 +85,100 @@ bool vector_is_monotone(const std::vector<Real> &vals) {
   return result;
 }
 
+ProgressBar::ProgressBar(const std::string &name, const int niterations,
+                         const Real write_freq, std::ostream &os)
+    : name_(name), niter_(niterations), freq_(write_freq), next_(write_freq),
+      os_(os), json_os_(nullptr), it_(0), cols_(0),
+      start_(std::chrono::steady_clock::now()), interval_(0.5), done_(false) {
+  EKAT_REQUIRE_MSG(niterations > 0,
+                   "ProgressBar: number of iterations must be positive!");
+  EKAT_REQUIRE_MSG((write_freq > 0) && (write_freq <= 100),
+                   "ProgressBar: write frequency must be in (0, 100]!");
+  reporter_ = std::thread(&ProgressBar::report_loop, this);
+}
+
+ProgressBar::~ProgressBar() { finish(); }
+
+void ProgressBar::set_json_output(std::ostream &json_os) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  json_os_ = &json_os;
+}
+
+void ProgressBar::set_report_interval(const Real seconds) {
+  EKAT_REQUIRE_MSG(seconds > 0,
+                   "ProgressBar: report interval must be positive!");
+  std::lock_guard<std::mutex> lock(mutex_);
+  interval_ = seconds;
+}
+
+void ProgressBar::finish() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (done_) {
+      return;
+    }
+    done_ = true;
+  }
+  cv_.notify_all();
+  if (reporter_.joinable()) {
+    reporter_.join();
+  }
+  const long it = it_.load(std::memory_order_relaxed);
+  if (100.0 * it / niter_ >= next_) {
+    report(it, cols_.load(std::memory_order_relaxed));
+  }
+}
+
+void ProgressBar::report_loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (!done_) {
+    cv_.wait_for(lock, std::chrono::duration<double>(interval_),
+                 [this] { return done_; });
+    if (done_) {
+      break;
+    }
+    const long it = it_.load(std::memory_order_relaxed);
+    if (100.0 * it / niter_ >= next_) {
+      report(it, cols_.load(std::memory_order_relaxed));
+    }
+  }
+}
+
+void ProgressBar::report(long it, long cols) {
+  const double elapsed =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start_)
+          .count();
+  const double percent = 100.0 * it / niter_;
+  const double steps_per_sec = (elapsed > 0) ? it / elapsed : 0.0;
+  const double cols_per_sec = (elapsed > 0) ? cols / elapsed : 0.0;
+  const double eta = (steps_per_sec > 0)
+                         ? std::max(niter_ - it, 0L) / steps_per_sec
+                         : std::numeric_limits<double>::infinity();
+  while (percent >= next_) {
+    next_ += freq_;
+  }
+
+  std::ostringstream ss;
+  ss << name_ << ": " << static_cast<int>(percent) << "% (" << it << "/"
+     << niter_ << " steps) | " << std::fixed << std::setprecision(1)
+     << steps_per_sec << " steps/s";
+  if (cols > 0) {
+    ss << " | " << std::scientific << std::setprecision(1) << cols_per_sec
+       << " columns/s" << std::fixed;
+  }
+  ss << " | ETA " << eta << " s\n";
+  os_ << ss.str() << std::flush;
+
+  if (json_os_) {
+    std::ostringstream js;
+    js << std::setprecision(6) << "{\"name\": \"" << name_
+       << "\", \"step\": " << it << ", \"num_steps\": " << niter_
+       << ", \"percent\": " << percent << ", \"elapsed_s\": " << elapsed
+       << ", \"steps_per_s\": " << steps_per_sec
+       << ", \"columns_per_s\": " << cols_per_sec
+       << ", \"eta_s\": " << (std::isinf(eta) ? -1.0 : eta) << "}\n";
+    *json_os_ << js.str() << std::flush;
+  }
+}
+
 } // namespace haero
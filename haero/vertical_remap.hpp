@@ -0,0 +1,364 @@
+// Copyright (c) 2021, National Technology & Engineering Solutions of Sandia,
+// LLC (NTESS). Copyright (c) 2022, Battelle Memorial Institute
+// SPDX-License-Identifier: BSD-3-Clause
+
+#ifndef HAERO_VERTICAL_REMAP_HPP
+#define HAERO_VERTICAL_REMAP_HPP
+
+#include <haero/memory.hpp>
+#include <haero/reductions.hpp>
+
+#include <ekat/ekat_assert.hpp>
+
+namespace haero {
+
+/// @class VerticalRemap
+/// This type conservatively remaps the tracers of many columns from one set
+/// of vertical levels (e.g. Lagrangian levels that have moved with the flow)
+/// to another (e.g. a reference grid), given the thicknesses of the levels in
+/// a mass coordinate such as hydrostatic pressure. Tracer mixing ratios are
+/// reconstructed within each source level with the monotone
+/// piecewise-parabolic method (PPM) of Colella and Woodward (1984, J. Comput.
+/// Phys. 54), using its formulas for nonuniform grids, and the
+/// reconstructions are integrated over each target level. The top and bottom
+/// source levels use constant reconstructions.
+///
+/// The remap conserves the mass of each tracer in each column to round-off,
+/// and the limiter keeps it from creating new extrema. The source and target
+/// levels of a column must have the same total thickness; the target levels
+/// are scaled to the source column, so the remap conserves mass even if the
+/// totals differ by round-off.
+///
+/// The reconstruction coefficients and the overlaps between source and
+/// target levels depend only on the grids, so they are computed once per
+/// column and shared by all tracers. The tracers of a column are grouped into
+/// Packs, and each thread of a column's team works on one Pack of tracers at
+/// one level at a time.
+class VerticalRemap final {
+public:
+  /// On host: creates a remap for the given numbers of columns, tracers, and
+  /// levels.
+  VerticalRemap(int num_columns, int num_tracers, int num_levels)
+      : num_tracers_(num_tracers),
+        slope_coeffs_("haero::VerticalRemap::slope_coeffs", num_columns,
+                      num_levels, 2),
+        edge_coeffs_("haero::VerticalRemap::edge_coeffs", num_columns,
+                     num_levels + 1, 3),
+        index_("haero::VerticalRemap::index", num_columns, num_levels + 1),
+        xi_("haero::VerticalRemap::xi", num_columns, num_levels + 1),
+        means_(Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                                  "haero::VerticalRemap::means"),
+               num_columns, PackInfo::num_packs(num_tracers), num_levels),
+        left_(Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                                 "haero::VerticalRemap::left"),
+              num_columns, PackInfo::num_packs(num_tracers), num_levels),
+        right_(Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                                  "haero::VerticalRemap::right"),
+               num_columns, PackInfo::num_packs(num_tracers), num_levels),
+        edges_(Kokkos::view_alloc(Kokkos::WithoutInitializing,
+                                  "haero::VerticalRemap::edges"),
+               num_columns, PackInfo::num_packs(num_tracers),
+               num_levels + 1) {
+    EKAT_REQUIRE_MSG(
+        (num_columns > 0) && (num_tracers > 0) && (num_levels > 0),
+        "VerticalRemap: numbers of columns, tracers, and levels must be "
+        "positive!");
+    for (const auto &coeffs : {slope_coeffs_, edge_coeffs_}) {
+      tracker_.track(coeffs, "workspace", "haero::VerticalRemap");
+    }
+    tracker_.track(index_, "workspace", "haero::VerticalRemap");
+    tracker_.track(xi_, "workspace", "haero::VerticalRemap");
+    for (const auto &work : {means_, left_, right_, edges_}) {
+      tracker_.track(work, "workspace", "haero::VerticalRemap");
+    }
+  }
+
+  /// On host: returns the number of columns.
+  int num_columns() const { return index_.extent(0); }
+
+  /// On host: returns the number of tracers.
+  int num_tracers() const { return num_tracers_; }
+
+  /// On host: returns the number of levels.
+  int num_levels() const { return slope_coeffs_.extent(1); }
+
+  /// On host: remaps the given tracers in place from levels with the given
+  /// source thicknesses to levels with the given target thicknesses.
+  /// @param [inout] tracers A view of tracer mixing ratios, indexed by tracer,
+  ///                        column, and level
+  /// @param [in] source_dp The (positive) thicknesses of the source levels,
+  ///                       indexed by column and level
+  /// @param [in] target_dp The (positive) thicknesses of the target levels,
+  ///                       indexed by column and level
+  void remap(const TracersView &tracers,
+             const DeviceType::view_2d<const Real> &source_dp,
+             const DeviceType::view_2d<const Real> &target_dp) const {
+    const int ncols = num_columns(), nlev = num_levels();
+    EKAT_REQUIRE_MSG((tracers.extent(0) == num_tracers_) &&
+                         (tracers.extent(1) == ncols) &&
+                         (tracers.extent(2) == nlev),
+                     "VerticalRemap: tracers must be sized "
+                     "(num_tracers, num_columns, num_levels)!");
+    EKAT_REQUIRE_MSG((source_dp.extent(0) == ncols) &&
+                         (source_dp.extent(1) == nlev) &&
+                         (target_dp.extent(0) == ncols) &&
+                         (target_dp.extent(1) == nlev),
+                     "VerticalRemap: source_dp and target_dp must be sized "
+                     "(num_columns, num_levels)!");
+    compute_grid(source_dp, target_dp);
+    remap_tracers(tracers, source_dp, target_dp);
+  }
+
+private:
+  // On host: computes the reconstruction coefficients of the source levels
+  // and the positions of the target interfaces within them.
+  void compute_grid(const DeviceType::view_2d<const Real> &source_dp,
+                    const DeviceType::view_2d<const Real> &target_dp) const {
+    const int ncols = num_columns(), nlev = num_levels();
+    const auto slope_coeffs = slope_coeffs_;
+    const auto edge_coeffs = edge_coeffs_;
+    const auto index = index_;
+    const auto xi = xi_;
+    Kokkos::parallel_for(
+        "haero::VerticalRemap::compute_grid",
+        ThreadTeamPolicy(ncols, Kokkos::AUTO),
+        KOKKOS_LAMBDA(const ThreadTeam &team) {
+          const int col = team.league_rank();
+          const auto dp = [&](const int j) { return source_dp(col, j); };
+          // slope coefficients D1 and D2 (CW84 eq. 1.7): the slope of level
+          // j is D1 (a(j+1) - a(j)) + D2 (a(j) - a(j-1)), and the top and
+          // bottom levels have no slope
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team, nlev), [&](const int j) {
+                Real d1 = 0, d2 = 0;
+                if ((j > 0) && (j < nlev - 1)) {
+                  const Real s = dp(j) / (dp(j - 1) + dp(j) + dp(j + 1));
+                  d1 = s * (2 * dp(j - 1) + dp(j)) / (dp(j + 1) + dp(j));
+                  d2 = s * (dp(j) + 2 * dp(j + 1)) / (dp(j - 1) + dp(j));
+                }
+                slope_coeffs(col, j, 0) = d1;
+                slope_coeffs(col, j, 1) = d2;
+              });
+          // edge coefficients E0, E1, and E2 (CW84 eq. 1.6): the value at the
+          // interface i between levels j = i - 1 and j + 1 is
+          // a(j) + E0 (a(j+1) - a(j)) - E1 slope(j+1) + E2 slope(j), which is
+          // linear interpolation next to the top and bottom levels
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team, 1, nlev), [&](const int i) {
+                const int j = i - 1;
+                Real e0 = dp(j) / (dp(j) + dp(j + 1)), e1 = 0, e2 = 0;
+                if ((j > 0) && (j + 2 < nlev)) {
+                  const Real dm = dp(j - 1), d0 = dp(j), d1 = dp(j + 1),
+                             d2 = dp(j + 2);
+                  const Real s = 1 / (dm + d0 + d1 + d2);
+                  e0 += s * (2 * d1 * d0 / (d0 + d1)) *
+                        ((dm + d0) / (2 * d0 + d1) - (d2 + d1) / (2 * d1 + d0));
+                  e1 = s * d0 * (dm + d0) / (2 * d0 + d1);
+                  e2 = s * d1 * (d1 + d2) / (d0 + 2 * d1);
+                }
+                edge_coeffs(col, i, 0) = e0;
+                edge_coeffs(col, i, 1) = e1;
+                edge_coeffs(col, i, 2) = e2;
+              });
+          // locate each target interface at a fraction xi of a source level,
+          // walking both grids from the top at once. Interface positions are
+          // accumulated with compensated sums, and target thicknesses are
+          // scaled to the source column's total, so a round-off difference
+          // between the totals is spread over the column.
+          Kokkos::single(Kokkos::PerTeam(team), [&]() {
+            const auto add = [](Real &sum, Real &err, const Real x) {
+              Real e;
+              two_sum(sum, x, sum, e);
+              err += e;
+            };
+            Real src_total = 0, src_total_err = 0;
+            Real tgt_total = 0, tgt_total_err = 0;
+            for (int j = 0; j < nlev; ++j) {
+              add(src_total, src_total_err, dp(j));
+              add(tgt_total, tgt_total_err, target_dp(col, j));
+            }
+            const Real scale =
+                (src_total + src_total_err) / (tgt_total + tgt_total_err);
+            Real z_src = 0, z_src_err = 0, z_tgt = 0, z_tgt_err = 0;
+            int j = 0;
+            index(col, 0) = 0;
+            xi(col, 0) = 0;
+            for (int i = 1; i < nlev; ++i) {
+              add(z_tgt, z_tgt_err, scale * target_dp(col, i - 1));
+              while (j < nlev - 1) {
+                Real z = z_src, z_err = z_src_err;
+                add(z, z_err, dp(j));
+                if ((z - z_tgt) + (z_err - z_tgt_err) > 0) {
+                  break;
+                }
+                z_src = z;
+                z_src_err = z_err;
+                ++j;
+              }
+              const Real x =
+                  ((z_tgt - z_src) + (z_tgt_err - z_src_err)) / dp(j);
+              index(col, i) = j;
+              xi(col, i) = (x < 0) ? Real(0) : ((x < 1) ? x : Real(1));
+            }
+            index(col, nlev) = nlev - 1;
+            xi(col, nlev) = 1;
+          });
+        });
+  }
+
+  // On host: remaps the given tracers using the grid computed by
+  // compute_grid.
+  void remap_tracers(const TracersView &tracers,
+                     const DeviceType::view_2d<const Real> &source_dp,
+                     const DeviceType::view_2d<const Real> &target_dp) const {
+    constexpr int N = HAERO_PACK_SIZE;
+    const int ncols = num_columns(), nlev = num_levels();
+    const int ntracers = num_tracers_;
+    const int npacks = PackInfo::num_packs(ntracers);
+    const auto slope_coeffs = slope_coeffs_;
+    const auto edge_coeffs = edge_coeffs_;
+    const auto index = index_;
+    const auto xi = xi_;
+    const auto means = means_;
+    const auto left = left_;
+    const auto right = right_;
+    const auto edges = edges_;
+    Kokkos::parallel_for(
+        "haero::VerticalRemap::remap",
+        ThreadTeamPolicy(ncols, Kokkos::AUTO),
+        KOKKOS_LAMBDA(const ThreadTeam &team) {
+          const int col = team.league_rank();
+          // gather the tracers into Packs
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team, npacks * nlev), [&](const int n) {
+                const int p = n / nlev, j = n % nlev;
+                PackType a;
+                for (int s = 0; s < N; ++s) {
+                  const int q = p * N + s;
+                  a[s] = (q < ntracers) ? tracers(q, col, j) : Real(0);
+                }
+                means(col, p, j) = a;
+              });
+          team.team_barrier();
+
+          // compute monotone slopes (CW84 eq. 1.8), stored temporarily in
+          // the right edge values
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team, npacks * nlev), [&](const int n) {
+                const int p = n / nlev, j = n % nlev;
+                PackType slope(0);
+                if ((j > 0) && (j < nlev - 1)) {
+                  const PackType dr = means(col, p, j + 1) - means(col, p, j);
+                  const PackType dl = means(col, p, j) - means(col, p, j - 1);
+                  const PackType d = slope_coeffs(col, j, 0) * dr +
+                                     slope_coeffs(col, j, 1) * dl;
+                  slope = ekat::min(
+                      ekat::abs(d),
+                      Real(2) * ekat::min(ekat::abs(dl), ekat::abs(dr)));
+                  slope.set(d < Real(0), -slope);
+                  slope.set(dr * dl <= Real(0), PackType(0));
+                }
+                right(col, p, j) = slope;
+              });
+          team.team_barrier();
+
+          // compute interface values (CW84 eq. 1.6)
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team, npacks * (nlev - 1)),
+              [&](const int n) {
+                const int p = n / (nlev - 1), i = n % (nlev - 1) + 1;
+                const PackType &a0 = means(col, p, i - 1);
+                edges(col, p, i) =
+                    a0 + edge_coeffs(col, i, 0) * (means(col, p, i) - a0) -
+                    edge_coeffs(col, i, 1) * right(col, p, i) +
+                    edge_coeffs(col, i, 2) * right(col, p, i - 1);
+              });
+          team.team_barrier();
+
+          // limit each level's parabola to the range of its edge values and
+          // mean (CW84 eq. 1.10)
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team, npacks * nlev), [&](const int n) {
+                const int p = n / nlev, j = n % nlev;
+                const PackType a = means(col, p, j);
+                PackType a_l = a, a_r = a;
+                if ((j > 0) && (j < nlev - 1)) {
+                  a_l = edges(col, p, j);
+                  a_r = edges(col, p, j + 1);
+                  const PackType da = a_r - a_l;
+                  const PackType da_mid = da * (a - Real(0.5) * (a_l + a_r));
+                  const PackType da2 = da * da / Real(6);
+                  const PackType l = a_l, r = a_r;
+                  a_l.set(da_mid > da2, Real(3) * a - Real(2) * r);
+                  a_r.set(-da2 > da_mid, Real(3) * a - Real(2) * l);
+                  const auto extremum = ((r - a) * (a - l) <= Real(0));
+                  a_l.set(extremum, a);
+                  a_r.set(extremum, a);
+                }
+                left(col, p, j) = a_l;
+                right(col, p, j) = a_r;
+              });
+          team.team_barrier();
+
+          // integrate the parabolas over each target level
+          Kokkos::parallel_for(
+              Kokkos::TeamThreadRange(team, npacks * nlev), [&](const int n) {
+                const int p = n / nlev, k = n % nlev;
+                const int j_top = index(col, k), j_bot = index(col, k + 1);
+                PackType mass(0);
+                for (int j = j_top; j <= j_bot; ++j) {
+                  const Real x0 = (j == j_top) ? xi(col, k) : Real(0);
+                  const Real x1 = (j == j_bot) ? xi(col, k + 1) : Real(1);
+                  mass += source_dp(col, j) *
+                          (integral(means(col, p, j), left(col, p, j),
+                                    right(col, p, j), x1) -
+                           integral(means(col, p, j), left(col, p, j),
+                                    right(col, p, j), x0));
+                }
+                mass /= target_dp(col, k);
+                for (int s = 0; s < N; ++s) {
+                  const int q = p * N + s;
+                  if (q < ntracers) {
+                    tracers(q, col, k) = mass[s];
+                  }
+                }
+              });
+        });
+  }
+
+  // On device: returns the integral over [0, x] of the parabola with the
+  // given mean and edge values on [0, 1]. The integrals over [0, 0] and
+  // [0, 1] are exactly 0 and the mean, so the pieces of a level sum to its
+  // mass to round-off.
+  KOKKOS_INLINE_FUNCTION
+  static PackType integral(const PackType &a, const PackType &a_l,
+                           const PackType &a_r, const Real x) {
+    if (x <= 0) {
+      return PackType(0);
+    } else if (x >= 1) {
+      return a;
+    } else {
+      const PackType a6 = Real(6) * a - Real(3) * (a_l + a_r);
+      return x * (a_l + x * (Real(0.5) * (a_r - a_l) +
+                             a6 * (Real(0.5) - x / Real(3))));
+    }
+  }
+
+  int num_tracers_;
+  // reconstruction coefficients, indexed by column, level (or interface), and
+  // coefficient
+  DeviceType::view_3d<Real> slope_coeffs_, edge_coeffs_;
+  // the source level containing each target interface, and the interface's
+  // fractional position within it, indexed by column and interface
+  DeviceType::view_2d<int> index_;
+  DeviceType::view_2d<Real> xi_;
+  // Packs of tracer means and parabola edge values, indexed by column, Pack,
+  // and level, and interface values, indexed by column, Pack, and interface
+  DeviceType::view_3d<PackType> means_, left_, right_, edges_;
+  // registers the views above with Haero's memory registry
+  memory::ViewTracker tracker_;
+};
+
+} // namespace haero
+
+#endif